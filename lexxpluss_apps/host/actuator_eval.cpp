@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "actuator_plant.h"
+#include "config.hpp"
+#include "position_control.hpp"
+
+// Closes position_control over the actuator model of the simulated board
+// and reports how a set of standard moves settle, so a change of the gains
+// or of the controller can be judged by numbers rather than by watching
+// the robot.
+
+namespace lexxhard::config {
+
+int32_t values[KEY_NUM];
+uint32_t generation;
+
+}
+
+namespace {
+
+using namespace lexxhard;
+using namespace lexxhard::actuator_controller;
+
+// The arithmetic of counter in actuator_controller.cpp, over the encoder
+// of the model instead of a timer.
+class plant_counter {
+public:
+    explicit plant_counter(const actuator_plant &plant, const actuator_plant_params &params)
+        : plant(plant), params(params) {}
+    void poll(uint32_t dt_ms) {
+        int32_t pulses{actuator_plant_pulses(&plant, &params)};
+        int32_t pulse{pulses - pulse_value};
+        pulse_value = pulses;
+        int64_t den{static_cast<int64_t>(MM_PER_PULSE_DEN) * dt_ms};
+        velocity = (static_cast<int64_t>(pulse) * MM_PER_PULSE_NUM * 2000 + den) / (den * 2);
+    }
+    int32_t get_location() const {
+        return static_cast<int64_t>(pulse_value) * MM_PER_PULSE_NUM / MM_PER_PULSE_DEN;
+    }
+    int32_t get_velocity() const {return velocity;}
+private:
+    // Left and center actuators.
+    static constexpr int32_t MM_PER_PULSE_NUM{50}, MM_PER_PULSE_DEN{1054};
+    const actuator_plant &plant;
+    const actuator_plant_params &params;
+    int32_t velocity{0}, pulse_value{0};
+};
+
+struct move {
+    const char *name;
+    int32_t distance_mm, power;
+};
+
+constexpr move moves[]{
+    {"up_10",        10, 100},
+    {"down_10",     -10, 100},
+    {"up_100",      100, 100},
+    {"down_100",   -100, 100},
+    {"up_100_p50",  100,  50},
+    {"up_300",      300, 100},
+};
+
+struct result {
+    float settle_s, overshoot_mm, error_mm, energy_j, peak_a;
+    bool stopped;
+};
+
+struct options {
+    actuator_plant_params params{actuator_plant_default};
+    uint32_t period_ms{10};
+    float tolerance_mm{1.0f};
+    bool csv{false};
+};
+
+result run(const move &m, const options &opt)
+{
+    actuator_plant plant{};
+    plant_counter cnt{plant, opt.params};
+    position_control<plant_counter> posctl{cnt};
+    posctl.on(m.distance_mm, m.power);
+    // Long enough to crawl the whole way at the minimum velocity, then hold.
+    int32_t vel_min{std::max(10 * m.power / 100, 1)};
+    uint32_t duration_ms{static_cast<uint32_t>(std::abs(m.distance_mm) * 1500 / vel_min + 2000)};
+    float drive{0.0f}, sign{m.distance_mm < 0 ? -1.0f : 1.0f};
+    result r{-1.0f, 0.0f, 0.0f, 0.0f, 0.0f, false};
+    uint32_t outside_ms{0};
+    for (uint32_t t{0}; t < duration_ms; ++t) {
+        if (t % opt.period_ms == 0) {
+            // As actuator::poll does.
+            cnt.poll(opt.period_ms);
+            auto [activated, direction, control]{posctl.poll(opt.period_ms)};
+            if (activated) {
+                if (float control_abs{fabsf(control)}; control_abs < 0.1f || posctl.is_near()) {
+                    posctl.off();
+                    drive = 0.0f;
+                    r.stopped = true;
+                } else {
+                    uint8_t duty{static_cast<uint8_t>(control_abs * 100)};
+                    drive = (direction == msg_control::UP ? duty : -duty) / 100.0f;
+                }
+            }
+        }
+        actuator_plant_step(&plant, &opt.params, drive, 1e-3f);
+        float error{plant.position_mm - m.distance_mm};
+        if (fabsf(error) > opt.tolerance_mm)
+            outside_ms = t + 1;
+        r.overshoot_mm = std::max(r.overshoot_mm, error * sign);
+        r.peak_a = std::max(r.peak_a, fabsf(plant.current_a));
+    }
+    float error{plant.position_mm - m.distance_mm};
+    if (fabsf(error) <= opt.tolerance_mm)
+        r.settle_s = outside_ms * 1e-3f;
+    r.error_mm = error;
+    r.energy_j = plant.energy_j;
+    return r;
+}
+
+bool parse(int argc, char **argv, options &opt)
+{
+    auto set_float{[](config::key k, float value) {
+        memcpy(&config::values[k], &value, sizeof value);
+    }};
+    // Same defaults as config.cpp.
+    set_float(config::ACTUATOR_POS_P, 1.0f);
+    set_float(config::ACTUATOR_VEL_P, 0.0f);
+    set_float(config::ACTUATOR_VEL_I, 0.13f);
+    for (int i{1}; i < argc; ++i) {
+        bool has_value{i + 1 < argc};
+        if (strcmp(argv[i], "--csv") == 0) {
+            opt.csv = true;
+        } else if (strcmp(argv[i], "--pos-p") == 0 && has_value) {
+            set_float(config::ACTUATOR_POS_P, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--vel-p") == 0 && has_value) {
+            set_float(config::ACTUATOR_VEL_P, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--vel-i") == 0 && has_value) {
+            set_float(config::ACTUATOR_VEL_I, atof(argv[++i]));
+        } else if (strcmp(argv[i], "--period-ms") == 0 && has_value) {
+            opt.period_ms = std::max(atoi(argv[++i]), 1);
+        } else if (strcmp(argv[i], "--load-kg") == 0 && has_value) {
+            opt.params.load_kg = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--supply-v") == 0 && has_value) {
+            opt.params.supply_v = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--tolerance") == 0 && has_value) {
+            opt.tolerance_mm = atof(argv[++i]);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    options opt;
+    if (!parse(argc, argv, opt)) {
+        fprintf(stderr, "Usage: %s [--csv] [--pos-p <gain>] [--vel-p <gain>] [--vel-i <gain>] [--period-ms <ms>]\n"
+                        "       [--load-kg <kg>] [--supply-v <V>] [--tolerance <mm>]\n", argv[0]);
+        return 1;
+    }
+    if (opt.csv)
+        printf("move,settle_s,overshoot_mm,error_mm,energy_j,peak_a,stopped\n");
+    else
+        printf("%-12s %9s %13s %9s %9s %7s %8s\n", "move", "settle[s]", "overshoot[mm]", "error[mm]", "energy[J]", "peak[A]", "stopped");
+    int unsettled{0};
+    for (const auto &m : moves) {
+        auto r{run(m, opt)};
+        if (r.settle_s < 0.0f)
+            ++unsettled;
+        if (opt.csv)
+            printf("%s,%.3f,%.2f,%.2f,%.1f,%.2f,%d\n", m.name, r.settle_s, r.overshoot_mm, r.error_mm, r.energy_j, r.peak_a, r.stopped);
+        else if (r.settle_s < 0.0f)
+            printf("%-12s %9s %13.2f %9.2f %9.1f %7.2f %8s\n", m.name, "-", r.overshoot_mm, r.error_mm, r.energy_j, r.peak_a, r.stopped ? "yes" : "no");
+        else
+            printf("%-12s %9.3f %13.2f %9.2f %9.1f %7.2f %8s\n", m.name, r.settle_s, r.overshoot_mm, r.error_mm, r.energy_j, r.peak_a, r.stopped ? "yes" : "no");
+    }
+    return unsettled == 0 ? 0 : 1;
+}
+
+// vim: set expandtab shiftwidth=4:
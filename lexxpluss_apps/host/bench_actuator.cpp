@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+#include "position_control.hpp"
+
+namespace {
+
+using namespace lexxhard::actuator_controller;
+
+// Moves at whatever velocity the last control output implies.
+struct fake_counter {
+    int32_t get_location() const {return location;}
+    int32_t get_velocity() const {return velocity;}
+    int32_t location{0}, velocity{0};
+};
+
+}
+
+BENCH(actuator_position_control_poll)
+{
+    fake_counter cnt;
+    position_control<fake_counter> posctl{cnt};
+    posctl.on(100, 100);
+    for (uint64_t i{0}; i < iterations; ++i) {
+        auto [activated, direction, control]{posctl.poll(10)};
+        cnt.velocity = static_cast<int32_t>(control * 30);
+        cnt.location += cnt.velocity / 100;
+        if (posctl.is_near()) {
+            cnt.location = 0;
+            posctl.on(cnt.location + 100, 100);
+        }
+        lexxhard::bench::do_not_optimize(activated);
+        lexxhard::bench::do_not_optimize(direction);
+    }
+}
+
+// vim: set expandtab shiftwidth=4:
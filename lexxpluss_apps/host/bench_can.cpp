@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include "bench.hpp"
+#include "can_controller.hpp"
+
+namespace {
+
+using namespace lexxhard::can_controller;
+
+struct frame {
+    uint32_t id;
+    uint8_t data[8];
+};
+
+// One full BMU report cycle as sent by the battery every second.
+const frame bmu_cycle[]{
+    {0x100, {0x01, 0x02, 80, 78, 99, 0x00, 0xfa, 0x00}},
+    {0x101, {0xff, 0x38, 0x00, 0x00, 0x6d, 0x60, 0x03, 0x00}},
+    {0x103, {0x27, 0x10, 0x26, 0xac, 0x1e, 0x14, 0x00, 0x00}},
+    {0x110, {0x0d, 0x48, 0x03, 0x00, 0x0d, 0x2a, 0x0b, 0x00}},
+    {0x111, {0x01, 0x18, 0x02, 0x00, 0x00, 0xfa, 0x07, 0x00}},
+    {0x112, {0x00, 0x64, 0x01, 0x00, 0xff, 0x9c, 0x04, 0x00}},
+    {0x113, {0x12, 0x05, 0x0e, 0x01, 0x00, 0x00, 0x00, 0x00}},
+    {0x120, {0x0c, 0xf8, 0x09, 0x00, 0x0d, 0x05, 0x02, 0x00}},
+    {0x130, {0x07, 0xe8, 0x07, 0xe8, 0x12, 0x34, 0x00, 0x00}},
+};
+
+}
+
+BENCH(can_decode_bmu_cycle)
+{
+    msg_bmu bmu;
+    memset(&bmu, 0, sizeof bmu);
+    for (uint64_t i{0}; i < iterations; ++i) {
+        for (const auto &f : bmu_cycle) {
+            lexxhard::bench::do_not_optimize(f);
+            bool complete{decode_bmu(f.id, f.data, bmu)};
+            lexxhard::bench::do_not_optimize(complete);
+        }
+        lexxhard::bench::clobber_memory();
+    }
+    lexxhard::bench::do_not_optimize(bmu.serial);
+}
+
+BENCH(can_decode_board)
+{
+    uint8_t data[8]{0b00011010, 0b10000110, 0b01110011, 0b00011101, 60, 31, 32, 40};
+    msg_board board;
+    memset(&board, 0, sizeof board);
+    for (uint64_t i{0}; i < iterations; ++i) {
+        lexxhard::bench::do_not_optimize(data);
+        decode_board(0x200, data, board);
+        lexxhard::bench::clobber_memory();
+    }
+    lexxhard::bench::do_not_optimize(board.state);
+}
+
+// vim: set expandtab shiftwidth=4:
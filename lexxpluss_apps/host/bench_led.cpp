@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+#include "led_pattern.hpp"
+
+namespace {
+
+using namespace lexxhard::led_controller;
+
+// Pixels of a side strip.  The firmware takes the count from the board
+// devicetree, here it only sets the amount of work.
+constexpr uint32_t PIXELS{46};
+
+const char *const commands[]{
+    "emergency_stop", "amr_mode", "agv_mode", "mission_pause", "path_blocked",
+    "manual_drive", "charging", "waiting_for_job", "left_winker", "right_winker",
+    "both_winker", "move_actuator", "charge_level", "showtime", "lockdown",
+    "#ff8000", "#20a0ff breath 30", "#00ff00 blink 60", "unknown",
+};
+
+// Renders 1000 frames (25 s of animation) per iteration.
+void render(uint64_t iterations, const msg &message)
+{
+    static led_pattern<PIXELS> pattern;
+    for (uint64_t i{0}; i < iterations; ++i) {
+        pattern.restart();
+        for (uint32_t frame{0}; frame < 1000; ++frame) {
+            pattern.render(message, 42, 128);
+            lexxhard::bench::clobber_memory();
+        }
+    }
+    lexxhard::bench::do_not_optimize(pattern.pixeldata);
+}
+
+}
+
+BENCH(led_msg_parse)
+{
+    for (uint64_t i{0}; i < iterations; ++i) {
+        for (auto command : commands) {
+            lexxhard::bench::do_not_optimize(command);
+            msg message{command};
+            lexxhard::bench::do_not_optimize(message);
+        }
+    }
+}
+
+BENCH(led_clamp_rgb_frame)
+{
+    led_rgb frame[2][PIXELS];
+    for (uint32_t i{0}; i < PIXELS; ++i) {
+        frame[0][i] = led_rgb{.r{static_cast<uint8_t>(i * 5)}, .g{0xff}, .b{static_cast<uint8_t>(255 - i * 5)}};
+        frame[1][i] = frame[0][i];
+    }
+    for (uint64_t i{0}; i < iterations; ++i) {
+        lexxhard::bench::do_not_optimize(frame);
+        for (uint32_t j{0}; j < PIXELS; ++j) {
+            led_rgb left{led_pattern<PIXELS>::clamp_rgb(frame[0][j], 128)};
+            led_rgb right{led_pattern<PIXELS>::clamp_rgb(frame[1][j], 128)};
+            lexxhard::bench::do_not_optimize(left);
+            lexxhard::bench::do_not_optimize(right);
+        }
+    }
+}
+
+BENCH(led_render_rainbow_x1000)
+{
+    render(iterations, msg{msg::CHARGING, 0});
+}
+
+BENCH(led_render_showtime_x1000)
+{
+    render(iterations, msg{msg::SHOWTIME, 0});
+}
+
+BENCH(led_render_charge_level_x1000)
+{
+    render(iterations, msg{msg::CHARGE_LEVEL, 0});
+}
+
+BENCH(led_render_winker_x1000)
+{
+    render(iterations, msg{msg::BOTH_WINKER, 0});
+}
+
+BENCH(led_render_breath_x1000)
+{
+    render(iterations, msg{"#20a0ff breath 30"});
+}
+
+BENCH(led_render_strobe_x1000)
+{
+    render(iterations, msg{msg::EMERGENCY_STOP, 0});
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "bench.hpp"
+#include "config.hpp"
+
+namespace lexxhard::config {
+
+int32_t values[KEY_NUM];
+uint32_t generation;
+
+}
+
+namespace lexxhard::bench {
+
+namespace {
+
+struct entry {
+    const char *name;
+    function fn;
+};
+
+struct result {
+    uint64_t iterations;
+    double min_ns, median_ns, max_ns;
+};
+
+std::vector<entry> &registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+double run_once(function fn, uint64_t iterations)
+{
+    auto begin{std::chrono::steady_clock::now()};
+    fn(iterations);
+    auto end{std::chrono::steady_clock::now()};
+    return std::chrono::duration<double, std::nano>(end - begin).count();
+}
+
+result measure(function fn)
+{
+    static constexpr double MIN_RUN_NS{20e6};
+    static constexpr int REPETITIONS{5};
+    uint64_t iterations{1};
+    while (true) {
+        double ns{run_once(fn, iterations)};
+        if (ns >= MIN_RUN_NS || iterations >= (1ULL << 40))
+            break;
+        uint64_t next{ns > 0 ? static_cast<uint64_t>(iterations * MIN_RUN_NS * 1.2 / ns) : iterations * 100};
+        iterations = std::clamp(next, iterations * 2, iterations * 100);
+    }
+    double per_iter[REPETITIONS];
+    for (auto &i : per_iter)
+        i = run_once(fn, iterations) / iterations;
+    std::sort(per_iter, per_iter + REPETITIONS);
+    return {iterations, per_iter[0], per_iter[REPETITIONS / 2], per_iter[REPETITIONS - 1]};
+}
+
+std::map<std::string, double> load_baseline(const char *path)
+{
+    std::map<std::string, double> baseline;
+    if (FILE *fp{fopen(path, "r")}; fp != nullptr) {
+        char line[256];
+        while (fgets(line, sizeof line, fp) != nullptr) {
+            char name[128];
+            unsigned long long iterations;
+            double min_ns, median_ns;
+            if (sscanf(line, "%127[^,],%llu,%lf,%lf", name, &iterations, &min_ns, &median_ns) == 4)
+                baseline[name] = median_ns;
+        }
+        fclose(fp);
+    } else {
+        fprintf(stderr, "cannot open %s\n", path);
+    }
+    return baseline;
+}
+
+void set_float(config::key k, float value)
+{
+    memcpy(&config::values[k], &value, sizeof value);
+}
+
+}
+
+void add(const char *name, function fn)
+{
+    registry().push_back({name, fn});
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    using namespace lexxhard;
+    const char *filter{nullptr}, *baseline_path{nullptr};
+    bool csv{false};
+    double tolerance{20.0};
+    for (int i{1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--filter <substring>] [--csv] [--baseline <csv>] [--tolerance <percent>]\n", argv[0]);
+            return 1;
+        }
+    }
+    // Same defaults as config.cpp.
+    bench::set_float(config::ACTUATOR_POS_P, 1.0f);
+    bench::set_float(config::ACTUATOR_VEL_P, 0.0f);
+    bench::set_float(config::ACTUATOR_VEL_I, 0.13f);
+    config::values[config::LED_CLAMP_THRESHOLD] = 128;
+    bench::set_float(config::RUNAWAY_YAW_ACCEL_LIMIT, 1.5f * static_cast<float>(M_PI));
+
+    std::map<std::string, double> baseline;
+    if (baseline_path != nullptr)
+        baseline = bench::load_baseline(baseline_path);
+    auto entries{bench::registry()};
+    std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b){return strcmp(a.name, b.name) < 0;});
+    if (csv)
+        printf("name,iterations,min_ns,median_ns,max_ns\n");
+    else
+        printf("%-32s %12s %10s %10s %10s\n", "benchmark", "iterations", "min[ns]", "median[ns]", "max[ns]");
+    int regressions{0};
+    for (const auto &i : entries) {
+        if (filter != nullptr && strstr(i.name, filter) == nullptr)
+            continue;
+        auto r{bench::measure(i.fn)};
+        if (csv)
+            printf("%s,%llu,%.2f,%.2f,%.2f\n", i.name, static_cast<unsigned long long>(r.iterations), r.min_ns, r.median_ns, r.max_ns);
+        else
+            printf("%-32s %12llu %10.2f %10.2f %10.2f", i.name, static_cast<unsigned long long>(r.iterations), r.min_ns, r.median_ns, r.max_ns);
+        if (auto it{baseline.find(i.name)}; it != baseline.end() && r.median_ns > it->second * (1.0 + tolerance / 100.0)) {
+            ++regressions;
+            if (csv)
+                fprintf(stderr, "%s: %.2fns, baseline %.2fns\n", i.name, r.median_ns, it->second);
+            else
+                printf("  REGRESSION (baseline %.2f)", it->second);
+        }
+        if (!csv)
+            printf("\n");
+    }
+    return regressions == 0 ? 0 : 1;
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bench.hpp"
+#include "pgv_controller.hpp"
+
+namespace {
+
+using namespace lexxhard::pgv_controller;
+
+// 21 byte position responses with the XOR check byte appended.
+struct response {
+    response(uint8_t flags, uint8_t xp_high) {
+        for (uint32_t i{0}; i < 20; ++i)
+            buf[i] = (i * 37 + 11) & 0x7f;
+        buf[0] = 0x10;
+        buf[1] = flags;
+        buf[2] = xp_high;
+        uint8_t check{buf[0]};
+        for (uint32_t i{1}; i < 20; ++i)
+            check ^= buf[i];
+        buf[20] = check;
+    }
+    uint8_t buf[21];
+};
+
+const response lane{0x14, 0x03}, tag{0x40, 0x05};
+
+}
+
+BENCH(pgv_validate)
+{
+    for (uint64_t i{0}; i < iterations; ++i) {
+        lexxhard::bench::do_not_optimize(lane.buf);
+        bool ok{validate(lane.buf, sizeof lane.buf)};
+        lexxhard::bench::do_not_optimize(ok);
+    }
+}
+
+BENCH(pgv_decode_lane)
+{
+    msg data{};
+    for (uint64_t i{0}; i < iterations; ++i) {
+        lexxhard::bench::do_not_optimize(lane.buf);
+        decode(lane.buf, data);
+        lexxhard::bench::clobber_memory();
+    }
+    lexxhard::bench::do_not_optimize(data.xp);
+}
+
+BENCH(pgv_decode_tag)
+{
+    msg data{};
+    for (uint64_t i{0}; i < iterations; ++i) {
+        lexxhard::bench::do_not_optimize(tag.buf);
+        decode(tag.buf, data);
+        lexxhard::bench::clobber_memory();
+    }
+    lexxhard::bench::do_not_optimize(data.tag);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdio>
+#include "bench.hpp"
+#include "name_list.hpp"
+
+namespace {
+
+// 8.3 names as written by the log rotation, in directory order.
+struct log_names {
+    log_names() {
+        for (uint32_t i{0}; i < COUNT; ++i)
+            snprintf(names[i], sizeof names[i], "LG%04u.TXT", (i * 7919) % 10000);
+    }
+    static constexpr uint32_t COUNT{60};
+    char names[COUNT][13];
+} const logs;
+
+}
+
+BENCH(sdlog_name_list_push_60)
+{
+    using list = lexxhard::sdlog_controller::name_list<30, 13>;
+    list entries;
+    for (uint64_t i{0}; i < iterations; ++i) {
+        entries.reset();
+        for (const auto &name : logs.names)
+            entries.push(list::ORDER::DESCENT, name);
+        lexxhard::bench::do_not_optimize(entries[0]);
+    }
+}
+
+// vim: set expandtab shiftwidth=4:
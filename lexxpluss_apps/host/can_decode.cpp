@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "can_controller.hpp"
+#include "recording.h"
+
+// Decodes the BMU and power board frames of a log through the frame
+// layouts of can_controller, so the log reads as the firmware sees it.
+// The log is a recording of the "rec" command or candump output, either
+// "(time) can0 100#0102..." or "can0 100 [8] 01 02 ...".
+
+namespace {
+
+using namespace lexxhard::can_controller;
+
+struct decoder {
+    void frame(double t_s, uint32_t id, const uint8_t *data, uint8_t dlc) {
+        auto out{[t_s, width{0}](const char *line) mutable {
+            if (width == 0)
+                width = printf("%12.6f", t_s);
+            else
+                printf("%*s", width, "");
+            printf(" %s\n", line);
+        }};
+        uint8_t payload[8]{};
+        memcpy(payload, data, dlc);
+        if (bmu_layout.decode(id, payload, bmu)) {
+            bmu_layout.print_frame(id, bmu, out);
+        } else if (board_layout.decode(id, payload, board)) {
+            board_layout.print_frame(id, board, out);
+        } else if (all) {
+            char line[64];
+            int len{snprintf(line, sizeof line, "0x%03x", id)};
+            for (uint8_t i{0}; i < dlc; ++i)
+                len += snprintf(&line[len], sizeof line - len, " %02x", data[i]);
+            out(line);
+        }
+    }
+    msg_bmu bmu{};
+    msg_board board{};
+    bool all{false};
+};
+
+bool decode_recording(FILE *fp, decoder &dec)
+{
+    recording_file_header header;
+    if (fread(&header, sizeof header, 1, fp) != 1 ||
+        memcmp(header.magic, RECORDING_MAGIC, sizeof header.magic) != 0 ||
+        header.version != RECORDING_VERSION)
+        return false;
+    recording_record_header record;
+    uint8_t payload[UINT8_MAX];
+    uint64_t wraps{0};
+    uint32_t prev_stamp{0};
+    while (fread(&record, sizeof record, 1, fp) == 1 && fread(payload, 1, record.len, fp) == record.len) {
+        if (record.stamp_us < prev_stamp)
+            wraps += 1ULL << 32;
+        prev_stamp = record.stamp_us;
+        // Little endian id, dlc and data, as can_controller records them.
+        if (record.type == RECORDING_CAN && record.len >= 3 && payload[2] <= 8 && record.len == 3 + payload[2])
+            dec.frame((wraps + record.stamp_us) * 1e-6, payload[0] | (payload[1] << 8), &payload[3], payload[2]);
+    }
+    return true;
+}
+
+bool parse_candump(const char *line, double &t_s, uint32_t &id, uint8_t (&data)[8], uint8_t &dlc)
+{
+    t_s = 0.0;
+    if (*line == '(')
+        t_s = strtod(line + 1, nullptr);
+    char interface[32], rest[96];
+    const char *p{*line == '(' ? strchr(line, ')') : line};
+    if (p == nullptr || sscanf(*p == ')' ? p + 1 : p, "%31s %95[^\n]", interface, rest) != 2)
+        return false;
+    char *end;
+    dlc = 0;
+    if (char *hash{strchr(rest, '#')}; hash != nullptr) {
+        // The compact form of candump -L, id#data.
+        id = strtoul(rest, &end, 16);
+        if (end != hash)
+            return false;
+        for (const char *q{hash + 1}; dlc < 8 && isxdigit(q[0]) && isxdigit(q[1]); q += 2) {
+            char hex[3]{q[0], q[1], '\0'};
+            data[dlc++] = strtoul(hex, nullptr, 16);
+        }
+        return true;
+    }
+    id = strtoul(rest, &end, 16);
+    unsigned int n;
+    if (end == rest || sscanf(end, " [%u]", &n) != 1 || n > 8)
+        return false;
+    const char *q{strchr(end, ']') + 1};
+    for (; dlc < n; ++dlc) {
+        unsigned int byte;
+        int used;
+        if (sscanf(q, " %2x%n", &byte, &used) != 1)
+            return false;
+        data[dlc] = byte;
+        q += used;
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    decoder dec;
+    const char *path{nullptr};
+    bool usage{false};
+    for (int i{1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--all") == 0)
+            dec.all = true;
+        else if (path == nullptr)
+            path = argv[i];
+        else
+            usage = true;
+    }
+    if (path == nullptr || usage) {
+        fprintf(stderr, "Usage: %s [--all] <recording|candump log|->\n", argv[0]);
+        return 1;
+    }
+    FILE *fp{strcmp(path, "-") == 0 ? stdin : fopen(path, "rb")};
+    if (fp == nullptr) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    if (fp == stdin || !decode_recording(fp, dec)) {
+        if (fp != stdin)
+            rewind(fp);
+        char line[256];
+        while (fgets(line, sizeof line, fp) != nullptr) {
+            double t_s;
+            uint32_t id;
+            uint8_t data[8], dlc;
+            if (parse_candump(line + strspn(line, " \t"), t_s, id, data, dlc))
+                dec.frame(t_s, id, data, dlc);
+        }
+    }
+    if (fp != stdin)
+        fclose(fp);
+    return 0;
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+// The handful of kernel definitions the pure logic headers need, so they
+// compile unchanged on Linux.
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#define __aligned(x) __attribute__((aligned(x)))
+#define __ASSERT_NO_MSG(test) assert(test)
+
+// Cycle counter of the STM32F7 on the main board.
+#define HOST_CYCLES_PER_SEC 216000000U
+
+struct k_thread;
+struct k_msgq;
+
+inline uint32_t k_cyc_to_ms_near32(uint32_t t)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(t) * 1000 + HOST_CYCLES_PER_SEC / 2) / HOST_CYCLES_PER_SEC);
+}
+
+inline uint32_t k_ms_to_cyc_near32(uint32_t t)
+{
+    return static_cast<uint32_t>(static_cast<uint64_t>(t) * HOST_CYCLES_PER_SEC / 1000);
+}
+
+// vim: set expandtab shiftwidth=4:
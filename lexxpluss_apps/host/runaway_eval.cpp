@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "recording.h"
+#include "yaw_checker.hpp"
+
+// Feeds gyro traces through yaw_checker and reports how often it fires on
+// normal driving, how late it fires on a runaway and what a sample costs,
+// for the firmware windows and for windows sized for faster IMU rates.
+// The traces are synthetic, or recorded by the "rec" command of the
+// firmware, or a CSV of time [s] and yaw rate [rad/s].
+
+namespace {
+
+using namespace lexxhard::runaway_detector;
+
+struct sample {
+    double t_s;
+    float gz;
+};
+
+struct trace {
+    std::string name;
+    std::vector<sample> samples;
+    // When the runaway starts, negative for normal driving.
+    double onset_s;
+};
+
+struct outcome {
+    uint32_t detections;
+    // From the onset to the first detection after it, negative if missed.
+    double latency_s;
+    double ns_per_sample;
+};
+
+constexpr double BOOT_S{1.0};
+
+template <typename CHECKER>
+outcome evaluate(const trace &tr, float accel_limit, float theta_limit)
+{
+    static CHECKER yaw;
+    yaw = CHECKER{};
+    outcome o{0, -1.0, 0.0};
+    bool last_detected{false};
+    auto begin{std::chrono::steady_clock::now()};
+    for (const auto &s : tr.samples) {
+        // The cycle counter is well past zero when the first sample arrives,
+        // yaw_checker divides by the distance to its zero filled window.
+        auto cycle{static_cast<uint32_t>(static_cast<uint64_t>((s.t_s + BOOT_S) * HOST_CYCLES_PER_SEC))};
+        bool detected{yaw.detect(s.gz, cycle, accel_limit, theta_limit)};
+        // Counted on the rising edge, as runaway_detector raises the emergency.
+        if (detected && !last_detected) {
+            if (tr.onset_s >= 0.0 && s.t_s >= tr.onset_s) {
+                if (o.latency_s < 0.0)
+                    o.latency_s = s.t_s - tr.onset_s;
+            } else {
+                ++o.detections;
+            }
+        }
+        last_detected = detected;
+    }
+    auto end{std::chrono::steady_clock::now()};
+    if (!tr.samples.empty())
+        o.ns_per_sample = std::chrono::duration<double, std::nano>(end - begin).count() / tr.samples.size();
+    return o;
+}
+
+struct windows {
+    const char *name;
+    outcome (*run)(const trace &tr, float accel_limit, float theta_limit);
+};
+
+// The firmware windows, then the same durations at 200Hz and 1kHz.
+const windows window_sets[]{
+    {"firmware", evaluate<yaw_checker>},
+    {"200hz",    evaluate<basic_yaw_checker<40, 200, 200, 500>>},
+    {"1khz",     evaluate<basic_yaw_checker<200, 1000, 1000, 2500>>},
+};
+
+constexpr double GYRO_NOISE{0.005}, BUMPS_PER_S{0.05}, BUMP_S{0.01};
+constexpr double RUNAWAY_ONSET_S{5.0}, RUNAWAY_RATE{3.0}, RUNAWAY_END_S{10.0};
+
+// Straight runs of 2 to 20s and 45 to 180 degree turns at 0.2 to 1rad/s,
+// with gyro noise and the odd bump from a floor joint.
+trace driving(double hours, double rate_hz, uint32_t seed)
+{
+    std::mt19937 rng{seed};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+    std::normal_distribution<double> noise{0.0, GYRO_NOISE}, bump_size{0.0, 0.3};
+    trace tr{"driving", {}, -1.0};
+    const double dt{1.0 / rate_hz}, duration{hours * 3600.0};
+    tr.samples.reserve(static_cast<size_t>(duration * rate_hz) + 1);
+    double gz{0.0}, target{0.0}, accel{1.0}, segment_end{0.0}, bump{0.0}, bump_end{0.0};
+    bool turning{true};
+    for (uint64_t i{0}; i * dt < duration; ++i) {
+        double t{i * dt};
+        if (t >= segment_end) {
+            turning = !turning;
+            if (turning) {
+                double rate{0.2 + 0.8 * uniform(rng)}, angle{M_PI / 4 * (1 + static_cast<int>(uniform(rng) * 4))};
+                target = uniform(rng) < 0.5 ? -rate : rate;
+                accel = 0.5 + 1.5 * uniform(rng);
+                segment_end = t + angle / rate;
+            } else {
+                target = 0.0;
+                segment_end = t + 2.0 + 18.0 * uniform(rng);
+            }
+        }
+        gz += std::clamp(target - gz, -accel * dt, accel * dt);
+        if (t >= bump_end) {
+            bump = 0.0;
+            if (uniform(rng) < BUMPS_PER_S * dt) {
+                bump = bump_size(rng);
+                bump_end = t + BUMP_S;
+            }
+        }
+        tr.samples.push_back({t, static_cast<float>(gz + bump + noise(rng))});
+    }
+    return tr;
+}
+
+// Drives straight, then spins up at accel until RUNAWAY_RATE.
+trace runaway(double accel, double rate_hz, uint32_t seed)
+{
+    std::mt19937 rng{seed};
+    std::normal_distribution<double> noise{0.0, GYRO_NOISE};
+    char name[32];
+    snprintf(name, sizeof name, "spin_%g", accel);
+    trace tr{name, {}, RUNAWAY_ONSET_S};
+    const double dt{1.0 / rate_hz};
+    for (uint64_t i{0}; i * dt < RUNAWAY_END_S; ++i) {
+        double t{i * dt};
+        double gz{t < RUNAWAY_ONSET_S ? 0.0 : std::min((t - RUNAWAY_ONSET_S) * accel, RUNAWAY_RATE)};
+        tr.samples.push_back({t, static_cast<float>(gz + noise(rng))});
+    }
+    return tr;
+}
+
+bool load_recording(FILE *fp, trace &tr)
+{
+    recording_file_header header;
+    if (fread(&header, sizeof header, 1, fp) != 1 ||
+        memcmp(header.magic, RECORDING_MAGIC, sizeof header.magic) != 0 ||
+        header.version != RECORDING_VERSION)
+        return false;
+    recording_record_header record;
+    uint8_t payload[UINT8_MAX];
+    uint64_t wraps{0};
+    uint32_t prev_stamp{0};
+    while (fread(&record, sizeof record, 1, fp) == 1 && fread(payload, 1, record.len, fp) == record.len) {
+        if (record.stamp_us < prev_stamp)
+            wraps += 1ULL << 32;
+        prev_stamp = record.stamp_us;
+        if (record.type == RECORDING_IMU && record.len == sizeof (recording_imu)) {
+            recording_imu imu;
+            memcpy(&imu, payload, sizeof imu);
+            tr.samples.push_back({(wraps + record.stamp_us) * 1e-6, imu.value[5]});
+        }
+    }
+    return true;
+}
+
+bool load_trace(const char *path, double onset_s, trace &tr)
+{
+    FILE *fp{fopen(path, "rb")};
+    if (fp == nullptr)
+        return false;
+    tr = {path, {}, onset_s};
+    if (!load_recording(fp, tr)) {
+        rewind(fp);
+        char line[128];
+        while (fgets(line, sizeof line, fp) != nullptr) {
+            if (double t, gz; sscanf(line, "%lf,%lf", &t, &gz) == 2)
+                tr.samples.push_back({t, static_cast<float>(gz)});
+        }
+    }
+    fclose(fp);
+    return !tr.samples.empty();
+}
+
+double hours_of(const trace &tr)
+{
+    return tr.samples.empty() ? 0.0 : (tr.samples.back().t_s - tr.samples.front().t_s) / 3600.0;
+}
+
+std::vector<float> parse_list(const char *arg)
+{
+    std::vector<float> values;
+    for (const char *p{arg}; *p != '\0';) {
+        char *end;
+        values.push_back(strtof(p, &end));
+        if (end == p)
+            break;
+        p = *end == ',' ? end + 1 : end;
+    }
+    return values;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    double hours{1.0}, rate_hz{1000.0}, onset_s{-1.0};
+    uint32_t seed{1};
+    const char *trace_path{nullptr}, *window_name{"firmware"};
+    std::vector<float> accel_limits{1.5f * static_cast<float>(M_PI)};
+    std::vector<float> theta_limits{yaw_checker::YAW_DELTA_THETA_LIMIT};
+    bool csv{false}, sweep{false};
+    for (int i{1}; i < argc; ++i) {
+        bool has_value{i + 1 < argc};
+        if (strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            sweep = true;
+        } else if (strcmp(argv[i], "--hours") == 0 && has_value) {
+            hours = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--rate-hz") == 0 && has_value) {
+            rate_hz = std::max(atof(argv[++i]), 1.0);
+        } else if (strcmp(argv[i], "--seed") == 0 && has_value) {
+            seed = strtoul(argv[++i], nullptr, 0);
+        } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+            trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--onset") == 0 && has_value) {
+            onset_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--windows") == 0 && has_value) {
+            window_name = argv[++i];
+        } else if (strcmp(argv[i], "--accel-limit") == 0 && has_value) {
+            accel_limits = parse_list(argv[++i]);
+        } else if (strcmp(argv[i], "--theta-limit") == 0 && has_value) {
+            theta_limits = parse_list(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--hours <h>] [--rate-hz <hz>] [--seed <n>] [--trace <file> [--onset <s>]]\n"
+                            "       [--windows firmware|200hz|1khz] [--accel-limit <a,...>] [--theta-limit <rad,...>]\n"
+                            "       [--sweep] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    std::vector<trace> traces;
+    if (trace_path != nullptr) {
+        traces.emplace_back();
+        if (!load_trace(trace_path, onset_s, traces.back())) {
+            fprintf(stderr, "no yaw rate samples in %s\n", trace_path);
+            return 1;
+        }
+    } else {
+        traces.push_back(driving(hours, rate_hz, seed));
+        for (double accel : {2.0, 5.0, 10.0, 20.0})
+            traces.push_back(runaway(accel, rate_hz, seed));
+    }
+    if (sweep && accel_limits.size() == 1 && theta_limits.size() == 1) {
+        accel_limits = {static_cast<float>(M_PI), 1.5f * static_cast<float>(M_PI), 2.0f * static_cast<float>(M_PI), 3.0f * static_cast<float>(M_PI)};
+        theta_limits = {static_cast<float>(M_PI), 2.5f * static_cast<float>(M_PI)};
+    }
+    std::vector<const windows*> selected;
+    for (const auto &w : window_sets) {
+        if (sweep || strcmp(w.name, window_name) == 0)
+            selected.push_back(&w);
+    }
+    if (selected.empty()) {
+        fprintf(stderr, "unknown windows %s\n", window_name);
+        return 1;
+    }
+
+    // One row per parameter set: false positives per hour of the normal
+    // traces, then the latency of each runaway trace.
+    printf(csv ? "windows,accel_limit,theta_limit,fp_per_hour" : "%-9s %11s %11s %8s", "windows", "accel_limit", "theta_limit", "fp/h");
+    for (const auto &tr : traces) {
+        if (tr.onset_s >= 0.0)
+            printf(csv ? ",%s_latency_ms" : " %10s", (tr.name + (csv ? "" : "[ms]")).c_str());
+    }
+    printf(csv ? ",ns_per_sample\n" : " %9s\n", "ns/sample");
+    for (const auto *w : selected) {
+        for (float accel_limit : accel_limits) {
+            for (float theta_limit : theta_limits) {
+                uint32_t false_positives{0};
+                double normal_hours{0.0}, ns{0.0};
+                size_t samples{0};
+                std::vector<double> latencies;
+                for (const auto &tr : traces) {
+                    auto o{w->run(tr, accel_limit, theta_limit)};
+                    false_positives += o.detections;
+                    if (tr.onset_s < 0.0)
+                        normal_hours += hours_of(tr);
+                    else
+                        latencies.push_back(o.latency_s);
+                    ns += o.ns_per_sample * tr.samples.size();
+                    samples += tr.samples.size();
+                }
+                double fp_per_hour{normal_hours > 0.0 ? false_positives / normal_hours : 0.0};
+                printf(csv ? "%s,%.3f,%.3f,%.2f" : "%-9s %11.3f %11.3f %8.2f", w->name, accel_limit, theta_limit, fp_per_hour);
+                for (double latency : latencies) {
+                    if (latency < 0.0)
+                        printf(csv ? ",miss" : " %10s", "miss");
+                    else
+                        printf(csv ? ",%.0f" : " %10.0f", latency * 1e3);
+                }
+                printf(csv ? ",%.1f\n" : " %9.1f\n", samples > 0 ? ns / samples : 0.0);
+            }
+        }
+    }
+    return 0;
+}
+
+// vim: set expandtab shiftwidth=4:
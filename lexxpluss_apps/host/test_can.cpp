@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include "can_controller.hpp"
+#include "test.hpp"
+
+using namespace lexxhard::can_controller;
+
+TEST(can_decode_bmu_status)
+{
+    static constexpr uint8_t data[8]{0x01, 0x02, 0x03, 0x04, 0x05, 0xff, 0x38, 0x00};
+    msg_bmu bmu{};
+    CHECK(!decode_bmu(0x100, data, bmu));
+    CHECK(bmu.mod_status1 == 0x01);
+    CHECK(bmu.bmu_status == 0x02);
+    CHECK(bmu.asoc == 3);
+    CHECK(bmu.rsoc == 4);
+    CHECK(bmu.soh == 5);
+    CHECK(bmu.fet_temp == -200);
+}
+
+TEST(can_decode_bmu_pack)
+{
+    static constexpr uint8_t data[8]{0x80, 0x00, 0x12, 0x34, 0x0b, 0xb8, 0x5a, 0x00};
+    msg_bmu bmu{};
+    CHECK(!decode_bmu(0x101, data, bmu));
+    CHECK(bmu.pack_current == -32768);
+    CHECK(bmu.charging_current == 0x1234);
+    CHECK(bmu.pack_voltage == 3000);
+    CHECK(bmu.mod_status2 == 0x5a);
+}
+
+TEST(can_decode_bmu_voltage_range)
+{
+    static constexpr uint8_t data[8]{0x0f, 0xa0, 0x07, 0x00, 0x0e, 0x10, 0x03, 0x00};
+    msg_bmu bmu{};
+    CHECK(!decode_bmu(0x110, data, bmu));
+    CHECK(bmu.max_voltage.value == 4000);
+    CHECK(bmu.max_voltage.id == 7);
+    CHECK(bmu.min_voltage.value == 3600);
+    CHECK(bmu.min_voltage.id == 3);
+}
+
+TEST(can_decode_bmu_closes_cycle_on_0x130)
+{
+    static constexpr uint8_t data[8]{0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0x00, 0x00};
+    msg_bmu bmu{};
+    CHECK(decode_bmu(0x130, data, bmu));
+    CHECK(bmu.manufacturing == 0x1234);
+    CHECK(bmu.inspection == 0x5678);
+    CHECK(bmu.serial == 0x9abc);
+}
+
+TEST(can_decode_bmu_ignores_frames_without_fields)
+{
+    static constexpr uint8_t data[8]{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    msg_bmu bmu{}, untouched{};
+    CHECK(!decode_bmu(0x102, data, bmu));
+    CHECK(!decode_bmu(0x0ff, data, bmu));
+    CHECK(!decode_bmu(0x140, data, bmu));
+    CHECK(memcmp(&bmu, &untouched, sizeof bmu) == 0);
+}
+
+TEST(can_decode_board_status)
+{
+    static constexpr uint8_t data[8]{0x0d, 0xda, 0x51, 0xb6, 0x64, 0x19, 0xc8, 0x2a};
+    msg_board board{};
+    CHECK(decode_board(0x200, data, board));
+    CHECK(board.power_switch);
+    CHECK(!board.emergency_switch[0]);
+    CHECK(board.emergency_switch[1]);
+    CHECK(board.bumper_switch[0]);
+    CHECK(!board.bumper_switch[1]);
+    CHECK(!board.manual_charging);
+    CHECK(board.auto_charging);
+    CHECK(board.shutdown_reason == 22);
+    CHECK(board.wait_shutdown);
+    CHECK(board.v5_fail);
+    CHECK(!board.v16_fail);
+    CHECK(board.c_fet);
+    CHECK(!board.d_fet);
+    CHECK(board.p_dsg);
+    CHECK(!board.wheel_disable[0]);
+    CHECK(board.wheel_disable[1]);
+    CHECK(board.state == 45);
+    CHECK(board.fan_duty == 100);
+    CHECK(board.charge_connector_temp[0] == 25);
+    CHECK(board.charge_connector_temp[1] == 200);
+    CHECK(board.power_board_temp == 42);
+}
+
+TEST(can_decode_board_charge)
+{
+    static constexpr uint8_t data[8]{0x30, 0x75, 0x03, 0x07, 0x02, 0x00, 0x00, 0x00};
+    msg_board board{};
+    CHECK(decode_board(0x204, data, board));
+    CHECK(fabsf(board.charge_connector_voltage - 30.0f) < 1e-4f);
+    CHECK(board.charge_check_count == 3);
+    CHECK(board.charge_heartbeat_delay == 7);
+    CHECK(board.charge_temperature_error);
+}
+
+TEST(can_decode_board_ignores_frames_without_fields)
+{
+    static constexpr uint8_t data[8]{0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+    msg_board board{}, untouched{};
+    CHECK(!decode_board(0x202, data, board));
+    CHECK(!decode_board(0x203, data, board));
+    CHECK(!decode_board(0x208, data, board));
+    CHECK(memcmp(&board, &untouched, sizeof board) == 0);
+}
+
+// vim: set expandtab shiftwidth=4:
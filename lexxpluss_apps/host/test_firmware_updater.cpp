@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "firmware_updater.hpp"
+#include "test.hpp"
+
+using lexxhard::firmware_updater::checksum_ok;
+using lexxhard::firmware_updater::packet_array;
+
+TEST(firmware_updater_checksum_wraps)
+{
+    packet_array packet{};
+    for (uint32_t i{3}; i < 259; ++i)
+        packet.data[i] = 0x01;
+    packet.data[259] = 0x00;
+    CHECK(checksum_ok(packet.data));
+    packet.data[259] = 0x01;
+    CHECK(!checksum_ok(packet.data));
+}
+
+TEST(firmware_updater_checksum_covers_payload_only)
+{
+    packet_array packet{};
+    for (uint32_t i{3}; i < 259; ++i)
+        packet.data[i] = i - 3;
+    packet.data[259] = 0x80;
+    CHECK(checksum_ok(packet.data));
+    packet.data[0] = packet.data[1] = packet.data[2] = 0xff;
+    CHECK(checksum_ok(packet.data));
+    packet.data[258] ^= 0x01;
+    CHECK(!checksum_ok(packet.data));
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "led_controller.hpp"
+#include "test.hpp"
+
+using lexxhard::led_controller::msg;
+
+TEST(led_msg_parse_patterns)
+{
+    static constexpr struct {
+        const char *str;
+        uint32_t pattern;
+    } patterns[]{
+        {"emergency_stop",  msg::EMERGENCY_STOP},
+        {"amr_mode",        msg::AMR_MODE},
+        {"agv_mode",        msg::AGV_MODE},
+        {"mission_pause",   msg::MISSION_PAUSE},
+        {"path_blocked",    msg::PATH_BLOCKED},
+        {"manual_drive",    msg::MANUAL_DRIVE},
+        {"charging",        msg::CHARGING},
+        {"waiting_for_job", msg::WAITING_FOR_JOB},
+        {"left_winker",     msg::LEFT_WINKER},
+        {"right_winker",    msg::RIGHT_WINKER},
+        {"both_winker",     msg::BOTH_WINKER},
+        {"move_actuator",   msg::MOVE_ACTUATOR},
+        {"charge_level",    msg::CHARGE_LEVEL},
+        {"showtime",        msg::SHOWTIME},
+        {"lockdown",        msg::LOCKDOWN},
+        {"unknown",         msg::NONE},
+        {"",                msg::NONE},
+        {"Charging",        msg::NONE},
+    };
+    for (const auto &i : patterns) {
+        msg message{i.str};
+        CHECK(message.pattern == i.pattern);
+        CHECK(message.interrupt_ms == 0);
+    }
+}
+
+TEST(led_msg_parse_rgb)
+{
+    msg breath{"#20a0ff breath 30"};
+    CHECK(breath.pattern == msg::RGB_BREATH);
+    CHECK(breath.rgb[0] == 0x20 && breath.rgb[1] == 0xa0 && breath.rgb[2] == 0xff);
+    CHECK(breath.cpm == 30);
+    msg blink{"#00FF0a blink 60"};
+    CHECK(blink.pattern == msg::RGB_BLINK);
+    CHECK(blink.rgb[0] == 0x00 && blink.rgb[1] == 0xff && blink.rgb[2] == 0x0a);
+    CHECK(blink.cpm == 60);
+    msg steady{"#102030 breath 0"};
+    CHECK(steady.pattern == msg::RGB);
+    CHECK(steady.rgb[0] == 0x10 && steady.rgb[1] == 0x20 && steady.rgb[2] == 0x30);
+}
+
+TEST(led_msg_parse_rgb_rejects)
+{
+    // A color needs a mode, "breath 0" is the steady one.
+    CHECK(msg{"#ff8000"}.pattern == msg::NONE);
+    CHECK(msg{"#10zz30 breath 5"}.pattern == msg::NONE);
+    CHECK(msg{"#102030 flash 5"}.pattern == msg::NONE);
+    CHECK(msg{"#102030 breath5"}.pattern == msg::NONE);
+    CHECK(msg{"#102030_blink 5"}.pattern == msg::NONE);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "test.hpp"
+
+namespace lexxhard::test {
+
+namespace {
+
+struct entry {
+    const char *name;
+    function fn;
+};
+
+std::vector<entry> &registry()
+{
+    static std::vector<entry> entries;
+    return entries;
+}
+
+uint32_t failures;
+
+}
+
+void add(const char *name, function fn)
+{
+    registry().push_back({name, fn});
+}
+
+void fail(const char *file, int line, const char *expression)
+{
+    printf("  %s:%d: %s\n", file, line, expression);
+    ++failures;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    using namespace lexxhard::test;
+    const char *filter{nullptr};
+    for (int i{1}; i < argc; ++i) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--filter <substring>]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint32_t run{0}, failed{0};
+    for (const auto &i : registry()) {
+        if (filter != nullptr && strstr(i.name, filter) == nullptr)
+            continue;
+        uint32_t before{failures};
+        i.fn();
+        printf("%s %s\n", failures == before ? "ok  " : "FAIL", i.name);
+        ++run;
+        if (failures != before)
+            ++failed;
+    }
+    printf("%u tests, %u failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
+
+// vim: set expandtab shiftwidth=4:
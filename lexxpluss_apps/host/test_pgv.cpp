@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <initializer_list>
+#include <utility>
+#include "pgv_controller.hpp"
+#include "test.hpp"
+
+namespace {
+
+using namespace lexxhard::pgv_controller;
+
+// A 21 byte position response, the XOR check byte filled in.
+struct response {
+    response(std::initializer_list<std::pair<uint32_t, uint8_t>> bytes) {
+        for (auto [index, value] : bytes)
+            buf[index] = value;
+        uint8_t check{buf[0]};
+        for (uint32_t i{1}; i < 20; ++i)
+            check ^= buf[i];
+        buf[20] = check;
+    }
+    uint8_t buf[21]{};
+};
+
+}
+
+TEST(pgv_validate)
+{
+    response r{{0, 0x10}, {1, 0x14}, {5, 0x7f}, {19, 0x01}};
+    CHECK(validate(r.buf, sizeof r.buf));
+    r.buf[5] ^= 0x02;
+    CHECK(!validate(r.buf, sizeof r.buf));
+    r.buf[5] ^= 0x02;
+    r.buf[20] ^= 0x80;
+    CHECK(!validate(r.buf, sizeof r.buf));
+}
+
+TEST(pgv_decode_lane)
+{
+    const response r{
+        {0, 0x10}, {1, 0x14},
+        {2, 0x01}, {3, 0x02}, {4, 0x03}, {5, 0x04},
+        {6, 0x7f}, {7, 0x7e},
+        {10, 0x02}, {11, 0x58},
+        {14, 0x2b}, {15, 0x10}, {16, 0x45}, {17, 0x01},
+        {19, 0x01},
+    };
+    msg data{};
+    decode(r.buf, data);
+    CHECK(data.addr == 1);
+    CHECK(!data.f.cc2 && !data.f.cc1 && !data.f.wrn && !data.f.np && !data.f.err);
+    CHECK(!data.f.tag);
+    CHECK(data.lane == 1);
+    CHECK(data.f.nl);
+    CHECK(!data.f.rp && !data.f.ll && !data.f.rl);
+    CHECK(data.xp == (1 << 21 | 2 << 14 | 3 << 7 | 4));
+    CHECK(data.yps == -2);
+    CHECK(data.ang == 344);
+    CHECK(data.wrn == 1);
+    CHECK(data.o1 == 1);
+    CHECK(data.s1 == 1);
+    CHECK(data.cc1 == 400);
+    CHECK(data.o2 == 2);
+    CHECK(data.s2 == 0);
+    CHECK(data.cc2 == 641);
+    CHECK(data.xps == 0);
+    CHECK(data.tag == 0);
+}
+
+TEST(pgv_decode_tag)
+{
+    const response r{
+        {0, 0x00}, {1, 0x40},
+        {2, 0x07}, {3, 0x7f}, {4, 0x7f}, {5, 0x7e},
+        {6, 0x00}, {7, 0x05},
+        {14, 0x00}, {15, 0x00}, {16, 0x01}, {17, 0x02},
+    };
+    msg data{};
+    data.xp = data.cc1 = data.cc2 = 1;
+    decode(r.buf, data);
+    CHECK(data.f.tag);
+    CHECK(data.xps == -2);
+    CHECK(data.yps == 5);
+    CHECK(data.tag == 130);
+    CHECK(data.xp == 0);
+    CHECK(data.cc1 == 0);
+    CHECK(data.cc2 == 0);
+}
+
+TEST(pgv_decode_tag_positive_position)
+{
+    const response r{{1, 0x40}, {2, 0x03}, {3, 0x00}, {4, 0x01}, {5, 0x00}};
+    msg data{};
+    decode(r.buf, data);
+    CHECK(data.xps == (3 << 21 | 1 << 7));
+}
+
+// vim: set expandtab shiftwidth=4:
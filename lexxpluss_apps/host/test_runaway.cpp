@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include "test.hpp"
+#include "yaw_checker.hpp"
+
+namespace {
+
+using lexxhard::runaway_detector::yaw_checker;
+
+// 50 Hz gyro samples, starting 1 s after boot as on the robot, where the
+// first sample is never at cycle 0.
+struct feeder {
+    bool next(float vz, float accel_limit, float delta_theta_limit = yaw_checker::YAW_DELTA_THETA_LIMIT) {
+        uint32_t cycle{k_ms_to_cyc_near32(1000 + 20 * count++)};
+        return yaw.detect(vz, cycle, accel_limit, delta_theta_limit);
+    }
+    yaw_checker yaw;
+    uint32_t count{0};
+};
+
+constexpr float NO_LIMIT{1e6f};
+
+}
+
+TEST(runaway_yaw_checker_still)
+{
+    feeder f;
+    bool detected{false};
+    for (uint32_t i{0}; i < 500; ++i)
+        detected |= f.next(0.0f, 5.0f);
+    CHECK(!detected);
+    CHECK(f.yaw.get_avg_yaw_accel() == 0.0f);
+    CHECK(f.yaw.get_avg_yaw_velocity() == 0.0f);
+    CHECK(f.yaw.get_sum_yaw_delta_theta() == 0.0f);
+}
+
+TEST(runaway_yaw_checker_delta_theta)
+{
+    // 4 rad/s turns 0.08 rad per sample, the 2.5 pi limit is crossed by
+    // the 99th sample.
+    feeder f;
+    CHECK(!f.next(0.0f, NO_LIMIT));
+    for (uint32_t i{1}; i < 99; ++i)
+        CHECK(!f.next(4.0f, NO_LIMIT));
+    CHECK(f.next(4.0f, NO_LIMIT));
+    CHECK(fabsf(f.yaw.get_sum_yaw_delta_theta() - 99 * 0.08f) < 1e-3f);
+}
+
+TEST(runaway_yaw_checker_speeding_up)
+{
+    // 25 rad/s^2 over the limit of 5, once the windows have filled.
+    feeder f;
+    bool detected{false};
+    for (uint32_t i{0}; i < 100; ++i)
+        detected = f.next(0.5f * i, 5.0f, NO_LIMIT);
+    CHECK(detected);
+    CHECK(fabsf(f.yaw.get_avg_yaw_accel() - 25.0f) < 0.01f);
+    CHECK(fabsf(f.yaw.get_avg_yaw_velocity() - 0.5f * 74.5f) < 0.01f);
+}
+
+TEST(runaway_yaw_checker_below_accel_limit)
+{
+    feeder f;
+    bool detected{false};
+    for (uint32_t i{0}; i < 100; ++i)
+        detected |= f.next(0.04f * i, 5.0f, NO_LIMIT);
+    CHECK(!detected);
+    CHECK(fabsf(f.yaw.get_avg_yaw_accel() - 2.0f) < 0.01f);
+}
+
+TEST(runaway_yaw_checker_slowing_down)
+{
+    // Braking a 10 rad/s spin at 25 rad/s^2 is not a runaway.
+    feeder f;
+    bool detected{false};
+    for (uint32_t i{0}; i < 60; ++i)
+        detected |= f.next(10.0f, 5.0f, NO_LIMIT);
+    for (uint32_t i{0}; i <= 20; ++i)
+        detected |= f.next(10.0f - 0.5f * i, 5.0f, NO_LIMIT);
+    CHECK(!detected);
+    CHECK(f.yaw.get_avg_yaw_accel() < -5.0f);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+// Truncating the names is what the last test checks.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+#include "name_list.hpp"
+#pragma GCC diagnostic pop
+#include "test.hpp"
+
+namespace {
+
+using lexxhard::sdlog_controller::name_list;
+
+const char *const names[]{"LG0002.TXT", "LG0010.TXT", "LG0001.TXT", "LG0005.TXT", "LG0003.TXT"};
+
+template <typename LIST>
+void push_all(LIST &list, typename LIST::ORDER order)
+{
+    for (auto name : names)
+        list.push(order, name);
+}
+
+}
+
+TEST(sdlog_name_list_descent_keeps_newest)
+{
+    name_list<4, 13> list;
+    push_all(list, decltype(list)::ORDER::DESCENT);
+    CHECK(strcmp(list[0], "LG0010.TXT") == 0);
+    CHECK(strcmp(list[1], "LG0005.TXT") == 0);
+    CHECK(strcmp(list[2], "LG0003.TXT") == 0);
+    CHECK(strcmp(list[3], "LG0002.TXT") == 0);
+}
+
+TEST(sdlog_name_list_ascent_keeps_oldest)
+{
+    name_list<4, 13> list;
+    push_all(list, decltype(list)::ORDER::ASCENT);
+    CHECK(strcmp(list[0], "LG0001.TXT") == 0);
+    CHECK(strcmp(list[1], "LG0002.TXT") == 0);
+    CHECK(strcmp(list[2], "LG0003.TXT") == 0);
+    CHECK(strcmp(list[3], "LG0005.TXT") == 0);
+}
+
+TEST(sdlog_name_list_partly_filled)
+{
+    name_list<30, 13> list;
+    push_all(list, decltype(list)::ORDER::DESCENT);
+    CHECK(strcmp(list[4], "LG0001.TXT") == 0);
+    CHECK(list[5][0] == '\0');
+    list.reset();
+    CHECK(list[0][0] == '\0');
+}
+
+TEST(sdlog_name_list_truncates)
+{
+    name_list<2, 5> list;
+    list.push(decltype(list)::ORDER::ASCENT, "AAAAAAA");
+    list.push(decltype(list)::ORDER::ASCENT, "AB");
+    CHECK(strcmp(list[0], "AAAA") == 0);
+    CHECK(strcmp(list[1], "AB") == 0);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024, LexxPluss Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Decode a black box snapshot into CSV.
+
+A snapshot is a sequence of 32 byte blackbox::entry slots, oldest first.  Get
+one from the SD card with "blackbox save /SD:/blackbox.bin" on the shell, or
+over rosserial from a machine running the ROS master:
+
+    scripts/blackbox_decode.py --capture blackbox.bin
+
+which requests /lexxhard/blackbox_dump and writes the streamed entries.  Then:
+
+    scripts/blackbox_decode.py blackbox.bin -o blackbox.csv
+
+The firmware keeps the snapshot until /lexxhard/blackbox_rearm or
+"blackbox rearm".
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+ENTRY = struct.Struct('<IBB26s')
+
+EMERGENCY_SOURCES = ['can_emergency_switch', 'can_bumper', 'ros', 'interlock', 'runaway', 'cliff']
+REASONS = {0x80: 'actuator_fail', 0x81: 'manual'}
+
+
+def decode_imu(data):
+    values = struct.unpack_from('<6h', data)
+    return [v / 100.0 for v in values[:3]] + [v / 10.0 for v in values[3:]]
+
+
+def decode_actuator(data):
+    fields = []
+    for i in range(3):
+        fields += struct.unpack_from('<ihbB', data, i * 8)
+    return fields
+
+
+def decode_can(data):
+    can_id, dlc = struct.unpack_from('<HB', data)
+    return ['0x%03x' % can_id, dlc, data[3:3 + dlc].hex()]
+
+
+def decode_uss(data):
+    return list(struct.unpack_from('<BHH', data))
+
+
+def decode_tof(data):
+    left, right, stale = struct.unpack_from('<hhB', data)
+    return [left, right, stale & 1, stale >> 1 & 1]
+
+
+def decode_pgv(data):
+    return list(struct.unpack_from('<IIihHHBB', data))
+
+
+def decode_trigger(data):
+    reason = data[0]
+    if reason < len(EMERGENCY_SOURCES):
+        return [EMERGENCY_SOURCES[reason]]
+    return [REASONS.get(reason, '0x%02x' % reason)]
+
+
+TYPES = {
+    1: ('imu', decode_imu, 'ax,ay,az,gx,gy,gz'),
+    2: ('actuator', decode_actuator, 'pulse0,current0,dir0,duty0,pulse1,current1,dir1,duty1,pulse2,current2,dir2,duty2'),
+    3: ('can_board', decode_can, 'id,dlc,data'),
+    4: ('can_bmu', decode_can, 'id,dlc,data'),
+    5: ('uss', decode_uss, 'index,distance0_mm,distance1_mm'),
+    6: ('tof', decode_tof, 'left_mv,right_mv,left_stale,right_stale'),
+    7: ('pgv', decode_pgv, 'xp,tag,xps,yps,ang,wrn,lane,flags'),
+    8: ('trigger', decode_trigger, 'reason'),
+}
+
+
+def decode(data, writer):
+    for stamp_ms, kind, length, payload in ENTRY.iter_unpack(data[:len(data) // ENTRY.size * ENTRY.size]):
+        name, decoder, _ = TYPES.get(kind, ('0x%02x' % kind, lambda d: [d.hex()], ''))
+        writer.writerow([stamp_ms, name] + decoder(payload[:length]))
+
+
+def capture(path, timeout):
+    import rospy
+    from std_msgs.msg import Empty, UInt8MultiArray
+    chunks = []
+    done = []
+
+    def callback(msg):
+        if len(msg.data) == 0:
+            done.append(True)
+        else:
+            chunks.append(bytes(bytearray(msg.data)))
+
+    rospy.init_node('blackbox_capture', anonymous=True)
+    rospy.Subscriber('/lexxhard/blackbox', UInt8MultiArray, callback)
+    pub = rospy.Publisher('/lexxhard/blackbox_dump', Empty, queue_size=1, latch=True)
+    rospy.sleep(1.0)
+    pub.publish(Empty())
+    deadline = rospy.Time.now() + rospy.Duration(timeout)
+    while not done and not rospy.is_shutdown() and rospy.Time.now() < deadline:
+        rospy.sleep(0.1)
+    with open(path, 'wb') as f:
+        f.write(b''.join(chunks))
+    print('%d entries written to %s' % (sum(len(c) for c in chunks) // ENTRY.size, path))
+    if not done:
+        sys.exit('timed out before the end of the snapshot')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('snapshot', help='raw snapshot file, the output with --capture')
+    parser.add_argument('-o', '--output', help='CSV output, stdout by default')
+    parser.add_argument('--capture', action='store_true', help='fetch the snapshot over ROS first')
+    parser.add_argument('--timeout', type=float, default=60.0, help='capture timeout [s]')
+    parser.add_argument('--legend', action='store_true', help='print the columns of each type')
+    args = parser.parse_args()
+
+    if args.legend:
+        for name, _, columns in TYPES.values():
+            print('%s: stamp_ms,type,%s' % (name, columns))
+        return
+    if args.capture:
+        capture(args.snapshot, args.timeout)
+        if not args.output:
+            return
+    with open(args.snapshot, 'rb') as f:
+        data = f.read()
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+    decode(data, csv.writer(out))
+    if args.output:
+        out.close()
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4:
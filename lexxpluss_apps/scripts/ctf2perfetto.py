@@ -0,0 +1,271 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024, LexxPluss Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Convert a CTF capture of the tracing firmware into a Chrome/Perfetto trace.
+
+Build and flash "make firmware_tracing", let the robot run, then dump the RAM
+trace buffer with the debugger:
+
+    (gdb) dump binary memory trace.bin ram_tracing ram_tracing+sizeof(ram_tracing)
+
+and convert it:
+
+    scripts/ctf2perfetto.py trace.bin -o trace.json
+
+Open trace.json in https://ui.perfetto.dev or chrome://tracing.  Passing
+--metadata with Zephyr's subsys/tracing/ctf/tsdl/metadata and --ctf-dir also
+writes a CTF directory, with the marker events appended to the metadata, that
+Trace Compass and babeltrace can open directly.
+"""
+
+import argparse
+import json
+import os
+import re
+import shutil
+import struct
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_MARKERS = os.path.join(HERE, '..', 'src', 'trace.hpp')
+
+EVENT_THREAD_SWITCHED_OUT = 0x10
+EVENT_THREAD_SWITCHED_IN = 0x11
+EVENT_THREAD_READY = 0x17
+EVENT_THREAD_INFO = 0x19
+EVENT_ISR_ENTER = 0x20
+EVENT_ISR_EXIT = 0x21
+EVENT_ISR_EXIT_TO_SCHEDULER = 0x22
+EVENT_MARKER_BEGIN = 0xe0
+EVENT_MARKER_END = 0xe1
+
+NAME_LEN = 20
+NO_INDEX = 0xff
+
+# Payload size of every event the tracing build emits, after the
+# 4 byte timestamp and 1 byte ID header.
+PAYLOAD = {
+    0x10: 4 + NAME_LEN, 0x11: 4 + NAME_LEN, 0x12: 4 + NAME_LEN,
+    0x13: 4 + NAME_LEN, 0x14: 4 + NAME_LEN, 0x15: 4 + NAME_LEN,
+    0x16: 4 + NAME_LEN, 0x17: 4 + NAME_LEN, 0x18: 4 + NAME_LEN,
+    0x19: 4 + NAME_LEN + 8, 0x1a: 4 + NAME_LEN,
+    0x20: 0, 0x21: 0, 0x22: 0,
+    0x30: 0,
+    0x41: 4, 0x42: 4,
+    EVENT_MARKER_BEGIN: 2, EVENT_MARKER_END: 2,
+}
+
+MARKER_METADATA = '''
+event {
+	name = lexxhard_marker_begin;
+	id = 0xE0;
+	fields := struct {
+		uint8_t marker;
+		uint8_t index;
+	};
+};
+
+event {
+	name = lexxhard_marker_end;
+	id = 0xE1;
+	fields := struct {
+		uint8_t marker;
+		uint8_t index;
+	};
+};
+'''
+
+ISR_TID = 0
+MARKER_TID_OFFSET = 1000
+
+
+def load_marker_names(path):
+    """Read the marker enum of trace.hpp, in declaration order."""
+    with open(path) as f:
+        text = f.read()
+    body = re.search(r'enum\s*{(.*?)MARKER_NUM', text, re.S).group(1)
+    return [name.split('=')[0].strip().lower()
+            for name in body.split(',') if name.strip()]
+
+
+def parse_events(data, payload):
+    """Yield (timestamp, id, payload bytes) until the end of valid data."""
+    pos = 0
+    while pos + 5 <= len(data):
+        stamp, event = struct.unpack_from('<IB', data, pos)
+        size = payload.get(event)
+        if size is None or pos + 5 + size > len(data):
+            if any(data[pos:]):
+                print(f'stopped at offset {pos}: unknown event 0x{event:02x}', file=sys.stderr)
+            return
+        yield stamp, event, data[pos + 5:pos + 5 + size]
+        pos += 5 + size
+
+
+def unwrap(events):
+    """Extend the 32bit timestamps across wrap-arounds."""
+    base, prev = 0, None
+    for stamp, event, body in events:
+        if prev is not None and stamp < prev:
+            base += 1 << 32
+        prev = stamp
+        yield base + stamp, event, body
+
+
+def thread_name(body):
+    return body[4:4 + NAME_LEN].split(b'\0', 1)[0].decode(errors='replace')
+
+
+class Converter:
+    def __init__(self, markers, clock_hz):
+        self.markers = markers
+        self.scale = 1e6 / clock_hz
+        self.trace = []
+        self.tids = {}
+        self.names = {ISR_TID: 'ISR'}
+        self.running = {}
+        self.open_markers = {}
+        self.current = None
+        self.isr_depth = 0
+        self.isr_start = []
+        self.stats = {}
+
+    def tid(self, thread_id, name):
+        if thread_id not in self.tids:
+            self.tids[thread_id] = len(self.tids) + 1
+        tid = self.tids[thread_id]
+        if name and name != 'unknown':
+            self.names[tid] = name
+        return tid
+
+    def slice(self, tid, name, begin, end, cat):
+        self.trace.append({'name': name, 'cat': cat, 'ph': 'X', 'pid': 1, 'tid': tid,
+                           'ts': begin * self.scale, 'dur': (end - begin) * self.scale})
+
+    def marker_name(self, marker, index):
+        name = self.markers[marker] if marker < len(self.markers) else f'marker{marker}'
+        return name if index == NO_INDEX else f'{name}[{index}]'
+
+    def event(self, ts, event, body):
+        if event == EVENT_THREAD_SWITCHED_IN:
+            thread_id, = struct.unpack_from('<I', body)
+            self.current = self.tid(thread_id, thread_name(body))
+            self.running[self.current] = ts
+        elif event == EVENT_THREAD_SWITCHED_OUT:
+            thread_id, = struct.unpack_from('<I', body)
+            tid = self.tid(thread_id, thread_name(body))
+            if tid in self.running:
+                self.slice(tid, 'running', self.running.pop(tid), ts, 'sched')
+            self.current = None
+        elif event in (EVENT_THREAD_READY, EVENT_THREAD_INFO):
+            thread_id, = struct.unpack_from('<I', body)
+            tid = self.tid(thread_id, thread_name(body))
+            if event == EVENT_THREAD_READY:
+                self.trace.append({'name': 'ready', 'cat': 'sched', 'ph': 'i', 's': 't',
+                                   'pid': 1, 'tid': tid, 'ts': ts * self.scale})
+        elif event == EVENT_ISR_ENTER:
+            self.isr_depth += 1
+            self.isr_start.append(ts)
+        elif event in (EVENT_ISR_EXIT, EVENT_ISR_EXIT_TO_SCHEDULER):
+            if self.isr_start:
+                self.slice(ISR_TID, 'isr', self.isr_start.pop(), ts, 'isr')
+            self.isr_depth = max(self.isr_depth - 1, 0)
+        elif event in (EVENT_MARKER_BEGIN, EVENT_MARKER_END):
+            marker, index = struct.unpack_from('<BB', body)
+            owner = ISR_TID if self.isr_depth > 0 or self.current is None else self.current
+            key = (owner, marker, index)
+            if event == EVENT_MARKER_BEGIN:
+                self.open_markers[key] = ts
+            elif key in self.open_markers:
+                begin = self.open_markers.pop(key)
+                name = self.marker_name(marker, index)
+                self.slice(owner + MARKER_TID_OFFSET, name, begin, ts, 'marker')
+                count, total, peak = self.stats.get(name, (0, 0, 0))
+                self.stats[name] = (count + 1, total + ts - begin, max(peak, ts - begin))
+
+    def result(self):
+        for tid, name in self.names.items():
+            self.trace.append({'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': tid,
+                               'args': {'name': name}})
+            self.trace.append({'name': 'thread_name', 'ph': 'M', 'pid': 1,
+                               'tid': tid + MARKER_TID_OFFSET,
+                               'args': {'name': f'{name} markers'}})
+        self.trace.append({'name': 'process_name', 'ph': 'M', 'pid': 1,
+                           'args': {'name': 'mainboard'}})
+        return {'traceEvents': self.trace, 'displayTimeUnit': 'ms'}
+
+    def print_stats(self):
+        print(f'{"marker":<28} {"count":>8} {"mean[us]":>10} {"max[us]":>10}')
+        for name, (count, total, peak) in sorted(self.stats.items()):
+            print(f'{name:<28} {count:>8} {total / count * self.scale:>10.1f} '
+                  f'{peak * self.scale:>10.1f}')
+
+
+def write_ctf_dir(path, metadata, stream):
+    os.makedirs(path, exist_ok=True)
+    with open(metadata) as f:
+        text = f.read()
+    with open(os.path.join(path, 'metadata'), 'w') as f:
+        f.write(text + MARKER_METADATA)
+    shutil.copyfile(stream, os.path.join(path, 'channel0_0'))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('stream', help='raw CTF stream dumped from the target')
+    parser.add_argument('-o', '--output', default='trace.json', help='Chrome trace JSON output')
+    parser.add_argument('--markers', default=DEFAULT_MARKERS, help='trace.hpp with the marker enum')
+    parser.add_argument('--clock-hz', type=float, default=1e9,
+                        help='timestamp rate, 1e9 when the kernel stamps in ns')
+    parser.add_argument('--payload', action='append', default=[], metavar='ID=SIZE',
+                        help='override the payload size of an event ID')
+    parser.add_argument('--metadata', help="Zephyr's CTF metadata file")
+    parser.add_argument('--ctf-dir', help='also write a CTF directory for Trace Compass')
+    parser.add_argument('--stats', action='store_true', help='print marker duration summary')
+    args = parser.parse_args()
+
+    payload = dict(PAYLOAD)
+    for item in args.payload:
+        event, size = item.split('=')
+        payload[int(event, 0)] = int(size, 0)
+
+    with open(args.stream, 'rb') as f:
+        data = f.read()
+    converter = Converter(load_marker_names(args.markers), args.clock_hz)
+    for ts, event, body in unwrap(parse_events(data, payload)):
+        converter.event(ts, event, body)
+    with open(args.output, 'w') as f:
+        json.dump(converter.result(), f)
+    if args.stats:
+        converter.print_stats()
+    if args.ctf_dir:
+        if not args.metadata:
+            parser.error('--ctf-dir needs --metadata')
+        write_ctf_dir(args.ctf_dir, args.metadata, args.stream)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4:
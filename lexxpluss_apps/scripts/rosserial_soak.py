@@ -0,0 +1,426 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024, LexxPluss Inc.
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice,
+#    this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+#    this list of conditions and the following disclaimer in the documentation
+#    and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+# ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+# DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+# ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+# (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+# LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+# SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Soak and load test of the rosserial link on UART_6.
+
+Speaks the rosserial protocol directly, without a ROS master, to the pseudo
+terminal of the simulated board (make firmware_native, the path is printed
+at boot) or to a real board over USB-serial:
+
+    scripts/rosserial_soak.py /dev/pts/5 --duration 3600 --csv soak.csv
+    scripts/rosserial_soak.py /dev/ttyUSB0 --load /body_control/led=200 \\
+        --load /lexxhard/mainboard_messenger_heartbeat=500
+
+Each --load floods one subscriber of the firmware at the given rate with a
+harmless default payload, or with the serialised message given in hex after
+a colon.  Topics that move hardware or start an update (the actuators, DFU)
+have no default payload.  A probe on /lexxhard/config_get with an unknown
+name is answered on /lexxhard/config and gives the command-to-effect round
+trip.  Every interval prints the publish rate of each firmware topic
+against the rate measured during the warm-up without load, the RX bytes the
+firmware dropped or received with UART errors (/lexxhard/rosserial_link)
+and the probe latency.
+"""
+
+import argparse
+import collections
+import csv
+import os
+import select
+import struct
+import sys
+import termios
+import time
+
+SYNC = b'\xff\xfe'
+ID_PUBLISHER = 0
+ID_SUBSCRIBER = 1
+ID_LOG = 7
+ID_TIME = 10
+ID_TX_STOP = 11
+
+PROBE_TOPIC = '/lexxhard/config_get'
+PROBE_REPLY = '/lexxhard/config'
+LINK_TOPIC = '/lexxhard/rosserial_link'
+LINK_FIELDS = ['rx_bytes', 'rx_dropped', 'rx_errors', 'tx_bytes']
+
+
+def pack_string(value):
+    data = value.encode()
+    return struct.pack('<I', len(data)) + data
+
+
+def unpack_string(data, offset):
+    length, = struct.unpack_from('<I', data, offset)
+    offset += 4
+    return data[offset:offset + length].decode(errors='replace'), offset + length
+
+
+def unpack_uint32_array(data):
+    # std_msgs/UInt32MultiArray: layout.dim[], layout.data_offset, data[]
+    dims, = struct.unpack_from('<I', data, 0)
+    offset = 4
+    for _ in range(dims):
+        _, offset = unpack_string(data, offset)
+        offset += 8
+    offset += 4
+    length, = struct.unpack_from('<I', data, offset)
+    return list(struct.unpack_from('<%dI' % length, data, offset + 4))
+
+
+SERIALIZERS = {
+    'std_msgs/Bool': lambda v: struct.pack('<B', int(v)),
+    'std_msgs/UInt8': lambda v: struct.pack('<B', int(v)),
+    'std_msgs/Empty': lambda v: b'',
+    'std_msgs/String': pack_string,
+}
+
+# Default payloads of --load, chosen to leave the robot as it is.
+DEFAULT_VALUES = {
+    '/body_control/led': 'showtime',
+    '/control/request_emergency_stop': False,
+    '/control/emergency_stop_at_amr': False,
+    '/lexxhard/mainboard_messenger_heartbeat': True,
+    '/lexxhard/setup': 'soak',
+    '/lexxhard/config_get': 'soak',
+    '/lexxhard/blackbox_rearm': None,
+}
+
+
+def frame(topic_id, payload):
+    length = struct.pack('<H', len(payload))
+    body = struct.pack('<H', topic_id) + payload
+    return (SYNC + length + bytes([255 - sum(length) % 256]) +
+            body + bytes([255 - sum(body) % 256]))
+
+
+class FrameReader:
+    """Splits the byte stream into (topic_id, payload), counting bad frames."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.errors = 0
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:max(len(self.buffer) - 1, 0)]
+                return frames
+            del self.buffer[:start]
+            if len(self.buffer) < 7:
+                return frames
+            length = self.buffer[2] | self.buffer[3] << 8
+            if (self.buffer[2] + self.buffer[3] + self.buffer[4]) % 256 != 255:
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            if len(self.buffer) < 8 + length:
+                return frames
+            body = bytes(self.buffer[5:7 + length])
+            if (sum(body) + self.buffer[7 + length]) % 256 != 255:
+                self.errors += 1
+                del self.buffer[:1]
+                continue
+            del self.buffer[:8 + length]
+            frames.append((body[0] | body[1] << 8, body[2:]))
+
+
+class Link:
+    def __init__(self, path, baudrate, rtscts):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY | os.O_NONBLOCK)
+        attr = termios.tcgetattr(self.fd)
+        attr[0] = 0
+        attr[1] = 0
+        attr[2] = termios.CS8 | termios.CREAD | termios.CLOCAL | (termios.CRTSCTS if rtscts else 0)
+        attr[3] = 0
+        speed = getattr(termios, 'B%d' % baudrate)
+        attr[4] = attr[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attr)
+        termios.tcflush(self.fd, termios.TCIOFLUSH)
+        self.out = bytearray()
+        self.reader = FrameReader()
+        self.sent_bytes = 0
+        self.stalls = 0
+
+    def send(self, topic_id, payload):
+        self.out += frame(topic_id, payload)
+
+    def poll(self, timeout):
+        wlist = [self.fd] if self.out else []
+        readable, writable, _ = select.select([self.fd], wlist, [], timeout)
+        frames = []
+        if readable:
+            try:
+                frames = self.reader.feed(os.read(self.fd, 4096))
+            except (BlockingIOError, OSError):
+                pass
+        if writable:
+            try:
+                n = os.write(self.fd, self.out)
+                self.sent_bytes += n
+                del self.out[:n]
+            except BlockingIOError:
+                self.stalls += 1
+        return frames
+
+
+class Latency:
+    def __init__(self):
+        self.samples = []
+
+    def add(self, value):
+        self.samples.append(value)
+
+    def summary(self):
+        if not self.samples:
+            return [0, 0, 0, 0]
+        s = sorted(self.samples)
+        pick = lambda q: s[min(int(q * len(s)), len(s) - 1)]
+        return [round(s[0] * 1e3, 2), round(pick(0.5) * 1e3, 2), round(pick(0.99) * 1e3, 2), round(s[-1] * 1e3, 2)]
+
+
+class Soak:
+    def __init__(self, link, args):
+        self.link = link
+        self.args = args
+        self.publishers = {}
+        self.subscribers = {}
+        self.counts = collections.Counter()
+        self.baseline = {}
+        self.link_stats = None
+        self.link_prev = None
+        self.probes = {}
+        self.probe_seq = 0
+        self.probe_lost = 0
+        self.latency = Latency()
+        self.resyncs = 0
+        self.last_rx = time.monotonic()
+        self.loads = []
+
+    def negotiate(self, timeout=5.0):
+        deadline = time.monotonic() + timeout
+        next_request = 0
+        while time.monotonic() < deadline:
+            if time.monotonic() >= next_request:
+                self.link.send(0, b'')
+                next_request = time.monotonic() + 1.0
+            self.handle(self.link.poll(0.05))
+            if self.subscriber_id(PROBE_TOPIC)[0] is not None:
+                # Give the rest of the topic list time to arrive.
+                end = time.monotonic() + 0.5
+                while time.monotonic() < end:
+                    self.handle(self.link.poll(0.05))
+                return True
+        return False
+
+    def handle(self, frames):
+        now = time.monotonic()
+        if frames:
+            self.last_rx = now
+        for topic_id, payload in frames:
+            if topic_id == ID_PUBLISHER or topic_id == ID_SUBSCRIBER:
+                tid, = struct.unpack_from('<H', payload)
+                name, offset = unpack_string(payload, 2)
+                msg_type, offset = unpack_string(payload, offset)
+                if topic_id == ID_PUBLISHER:
+                    self.publishers[tid] = name
+                else:
+                    self.subscribers[tid] = (name, msg_type)
+            elif topic_id == ID_TIME:
+                t = time.time()
+                self.link.send(ID_TIME, struct.pack('<II', int(t), int(t % 1 * 1e9)))
+            elif topic_id == ID_LOG:
+                if self.args.verbose:
+                    level = payload[0]
+                    text, _ = unpack_string(payload, 1)
+                    print('log %u: %s' % (level, text), file=sys.stderr)
+            elif topic_id in self.publishers:
+                name = self.publishers[topic_id]
+                self.counts[name] += 1
+                if name == LINK_TOPIC:
+                    self.link_stats = unpack_uint32_array(payload)
+                elif name == PROBE_REPLY:
+                    text, _ = unpack_string(payload, 0)
+                    seq = text.rsplit(',', 1)[-1]
+                    if seq in self.probes:
+                        self.latency.add(now - self.probes.pop(seq))
+
+    def subscriber_id(self, name):
+        for tid, (topic, msg_type) in self.subscribers.items():
+            if topic == name:
+                return tid, msg_type
+        return None, None
+
+    def setup_loads(self):
+        for spec in self.args.load:
+            topic, _, rest = spec.partition('=')
+            rate, _, raw = rest.partition(':')
+            tid, msg_type = self.subscriber_id(topic)
+            if tid is None:
+                sys.exit('%s is not a subscriber of the firmware' % topic)
+            if raw:
+                payload = bytes.fromhex(raw)
+            elif topic in DEFAULT_VALUES and msg_type in SERIALIZERS:
+                payload = SERIALIZERS[msg_type](DEFAULT_VALUES[topic])
+            else:
+                sys.exit('%s (%s) has no default payload, give one in hex' % (topic, msg_type))
+            self.loads.append([tid, payload, 1.0 / float(rate), 0.0])
+
+    def send_probe(self):
+        tid, _ = self.subscriber_id(PROBE_TOPIC)
+        self.probe_seq += 1
+        key = 'soak%u' % self.probe_seq
+        self.probes[key] = time.monotonic()
+        self.link.send(tid, pack_string(key))
+
+    def run_phase(self, seconds, loaded):
+        end = time.monotonic() + seconds
+        next_probe = time.monotonic()
+        for load in self.loads:
+            load[3] = time.monotonic()
+        while time.monotonic() < end:
+            now = time.monotonic()
+            if loaded:
+                for load in self.loads:
+                    # Catch up at most one second, a stalled link is not a burst.
+                    load[3] = max(load[3], now - 1.0)
+                    while load[3] <= now:
+                        self.link.send(load[0], load[1])
+                        load[3] += load[2]
+            if self.args.probe_hz > 0 and now >= next_probe:
+                self.send_probe()
+                next_probe = now + 1.0 / self.args.probe_hz
+            self.handle(self.link.poll(0.001))
+            if now - self.last_rx > self.args.resync_timeout:
+                # The firmware publishes nothing until it is configured again.
+                self.resyncs += 1
+                self.last_rx = now
+                self.link.send(0, b'')
+
+    def expire_probes(self):
+        limit = time.monotonic() - self.args.probe_timeout
+        for key, sent in list(self.probes.items()):
+            if sent < limit:
+                del self.probes[key]
+                self.probe_lost += 1
+
+    def interval_report(self, elapsed, seconds, writer):
+        rates = {name: count / seconds for name, count in self.counts.items()}
+        link = dict(zip(LINK_FIELDS, self.link_stats or [0] * 4))
+        prev = dict(zip(LINK_FIELDS, self.link_prev or self.link_stats or [0] * 4))
+        delta = {k: link[k] - prev[k] for k in LINK_FIELDS}
+        self.link_prev = self.link_stats
+        lat = self.latency.summary()
+        slowest = sorted(((rates.get(n, 0.0) / r, n) for n, r in self.baseline.items() if r > 0))[:3]
+        print('%7.0fs sent %6.0f B/s dropped %u errors %u probe p50 %.2fms p99 %.2fms max %.2fms lost %u bad frames %u' %
+              (elapsed, self.link.sent_bytes / seconds, delta['rx_dropped'], delta['rx_errors'],
+               lat[1], lat[2], lat[3], self.probe_lost, self.link.reader.errors))
+        for ratio, name in slowest:
+            print('          %-44s %7.1f Hz (%3.0f%% of idle)' % (name, rates.get(name, 0.0), ratio * 100))
+        if writer:
+            writer.writerow([round(elapsed), round(self.link.sent_bytes / seconds), delta['rx_bytes'], delta['rx_dropped'],
+                             delta['rx_errors'], delta['tx_bytes']] + lat +
+                            [self.probe_lost, self.link.reader.errors, self.link.stalls, self.resyncs] +
+                            [round(rates.get(n, 0.0), 1) for n in sorted(self.baseline)])
+        self.counts.clear()
+        self.latency = Latency()
+        self.link.sent_bytes = 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('device', help='pseudo terminal of the simulated board or the USB-serial device')
+    parser.add_argument('--baudrate', type=int, default=921600, help='ignored on a pseudo terminal')
+    parser.add_argument('--no-rtscts', action='store_true', help='disable hardware flow control')
+    parser.add_argument('--load', action='append', default=[], metavar='TOPIC=HZ[:HEX]',
+                        help='subscriber to flood, repeatable')
+    parser.add_argument('--warmup', type=float, default=10.0, help='seconds without load for the idle rates')
+    parser.add_argument('--duration', type=float, default=60.0, help='seconds under load, 0 runs until Ctrl-C')
+    parser.add_argument('--interval', type=float, default=10.0, help='seconds per report line')
+    parser.add_argument('--probe-hz', type=float, default=10.0, help='config_get round trips per second')
+    parser.add_argument('--probe-timeout', type=float, default=2.0, help='seconds before a probe counts as lost')
+    parser.add_argument('--resync-timeout', type=float, default=2.0,
+                        help='seconds of silence before the topics are requested again')
+    parser.add_argument('--csv', help='append one row per interval')
+    parser.add_argument('--topics', action='store_true', help='list the firmware topics and exit')
+    parser.add_argument('-v', '--verbose', action='store_true', help='print the firmware log messages')
+    args = parser.parse_args()
+
+    link = Link(args.device, args.baudrate, not args.no_rtscts)
+    soak = Soak(link, args)
+    if not soak.negotiate():
+        sys.exit('no rosserial topic negotiation on %s' % args.device)
+    if args.topics:
+        for name in sorted(soak.publishers.values()):
+            print('pub %s' % name)
+        for name, msg_type in sorted(soak.subscribers.values()):
+            print('sub %s %s%s' % (name, msg_type, ' (default load)' if name in DEFAULT_VALUES else ''))
+        return
+    soak.setup_loads()
+
+    soak.counts.clear()
+    soak.run_phase(args.warmup, False)
+    soak.baseline = {name: count / args.warmup for name, count in soak.counts.items()}
+    soak.counts.clear()
+    soak.latency = Latency()
+    soak.link_prev = soak.link_stats
+    link.sent_bytes = 0
+    print('idle: %d topics, %.0f messages/s, load of %d subscribers' %
+          (len(soak.baseline), sum(soak.baseline.values()), len(soak.loads)))
+
+    out = None
+    writer = None
+    if args.csv:
+        new = not os.path.exists(args.csv)
+        out = open(args.csv, 'a', newline='')
+        writer = csv.writer(out)
+        if new:
+            writer.writerow(['elapsed_s', 'host_tx_bps', 'rx_bytes', 'rx_dropped', 'rx_errors', 'tx_bytes',
+                             'probe_min_ms', 'probe_p50_ms', 'probe_p99_ms', 'probe_max_ms',
+                             'probe_lost', 'bad_frames', 'host_stalls', 'resyncs'] + sorted(soak.baseline))
+    begin = time.monotonic()
+    try:
+        while args.duration <= 0 or time.monotonic() - begin < args.duration:
+            seconds = args.interval if args.duration <= 0 else min(args.interval, args.duration - (time.monotonic() - begin))
+            start = time.monotonic()
+            soak.run_phase(seconds, True)
+            soak.expire_probes()
+            soak.interval_report(time.monotonic() - begin, time.monotonic() - start, writer)
+            if out:
+                out.flush()
+    except KeyboardInterrupt:
+        pass
+    if out:
+        out.close()
+    if soak.resyncs > 0:
+        print('the link went silent and was resynchronised %d times' % soak.resyncs)
+
+
+if __name__ == '__main__':
+    main()
+
+# vim: set expandtab shiftwidth=4:
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stdint.h>
+
+/*
+ * Linear actuator: a brushed DC motor driven from the PWM average voltage,
+ * a gearbox and a lead screw moving a load against gravity and friction,
+ * with a quadrature encoder on the screw and the current shunt amplifier
+ * the actuator controller reads.  Plain C in a header so the emulator of
+ * the simulated board and the host tools step the same model.
+ */
+
+#define ACTUATOR_PLANT_SUBSTEP_S 100e-6f
+
+struct actuator_plant_params {
+    float supply_v;
+    float resistance_ohm, inductance_h;
+    /* Back EMF [V s/rad], equal to the torque constant [N m/A]. */
+    float ke;
+    float rotor_inertia_kgm2;
+    float gear_ratio;
+    float lead_mm;
+    float efficiency;
+    float load_kg;
+    /* Coulomb friction at the nut, above the weight so the screw holds. */
+    float friction_n;
+    float viscous_ns_per_m;
+    float pulses_per_mm;
+    /* Shunt, amplifier and divider in front of the ADC. */
+    float shunt_ohm, amp_gain, divider;
+};
+
+/* 24V motor with a 20:1 gearbox on a 4mm lead screw, about 20mm/s loaded. */
+static const struct actuator_plant_params actuator_plant_default = {
+    .supply_v = 24.0f,
+    .resistance_ohm = 2.0f,
+    .inductance_h = 1e-3f,
+    .ke = 0.03f,
+    .rotor_inertia_kgm2 = 5e-6f,
+    .gear_ratio = 20.0f,
+    .lead_mm = 4.0f,
+    .efficiency = 0.4f,
+    .load_kg = 50.0f,
+    .friction_n = 600.0f,
+    .viscous_ns_per_m = 500.0f,
+    .pulses_per_mm = 1054.0f / 50.0f,
+    .shunt_ohm = 0.1f,
+    .amp_gain = 20.0f,
+    .divider = 3.0f,
+};
+
+struct actuator_plant {
+    float current_a;
+    /* Motor shaft. */
+    float speed_rad_s;
+    float position_mm;
+    /* Taken from the supply, regeneration not counted. */
+    float energy_j;
+};
+
+/* Screw force [N] to motor torque [N m]. */
+static inline float actuator_plant_reflect(const struct actuator_plant_params *p)
+{
+    return p->lead_mm * 1e-3f / (2.0f * (float)M_PI * p->gear_ratio * p->efficiency);
+}
+
+/* drive is the duty from -1 (down) to 1 (up); both pins idle short the motor. */
+static inline void actuator_plant_step(struct actuator_plant *s, const struct actuator_plant_params *p,
+                                       float drive, float dt_s)
+{
+    const float k = actuator_plant_reflect(p);
+    const float mm_per_rad = p->lead_mm / (2.0f * (float)M_PI * p->gear_ratio);
+    const float m_per_rad = mm_per_rad * 1e-3f;
+    const float inertia = p->rotor_inertia_kgm2 + p->load_kg * m_per_rad * m_per_rad;
+    const float voltage = drive * p->supply_v;
+    /* Explicit Euler, stable with substeps well below L/R. */
+    const int n = (int)ceilf(dt_s / ACTUATOR_PLANT_SUBSTEP_S);
+    const float dt = dt_s / n;
+    for (int i = 0; i < n; ++i) {
+        s->current_a += (voltage - p->resistance_ohm * s->current_a - p->ke * s->speed_rad_s) /
+                        p->inductance_h * dt;
+        float speed_m_s = s->speed_rad_s * m_per_rad;
+        float torque = p->ke * s->current_a -
+                       (p->load_kg * 9.81f + p->viscous_ns_per_m * speed_m_s) * k;
+        float friction = p->friction_n * k;
+        if (s->speed_rad_s == 0.0f && fabsf(torque) <= friction) {
+            /* Held by static friction. */
+        } else {
+            float sign = s->speed_rad_s != 0.0f ? copysignf(1.0f, s->speed_rad_s) : copysignf(1.0f, torque);
+            float speed = s->speed_rad_s + (torque - sign * friction) / inertia * dt;
+            /* Friction stops the screw, it does not reverse it. */
+            s->speed_rad_s = speed * s->speed_rad_s < 0.0f ? 0.0f : speed;
+        }
+        s->position_mm += s->speed_rad_s * mm_per_rad * dt;
+        if (voltage * s->current_a > 0.0f)
+            s->energy_j += voltage * s->current_a * dt;
+    }
+}
+
+static inline int32_t actuator_plant_pulses(const struct actuator_plant *s, const struct actuator_plant_params *p)
+{
+    return (int32_t)floorf(s->position_mm * p->pulses_per_mm);
+}
+
+static inline float actuator_plant_speed_mm_s(const struct actuator_plant *s, const struct actuator_plant_params *p)
+{
+    return s->speed_rad_s * p->lead_mm / (2.0f * (float)M_PI * p->gear_ratio);
+}
+
+/* Voltage at the ADC pin, the inverse of calc_current() of the controller. */
+static inline int32_t actuator_plant_shunt_mv(const struct actuator_plant *s, const struct actuator_plant_params *p)
+{
+    return (int32_t)(fabsf(s->current_a) * p->shunt_ohm * p->amp_gain / p->divider * 1e3f);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+/*
+ * Emulated peripherals of the native_posix build.  Each emulator registers
+ * a device under the label the controllers already look up, and exposes
+ * its state here for the "sim" shell command and for host tools.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    SIM_IMU_ACCEL_X = 0,
+    SIM_IMU_ACCEL_Y,
+    SIM_IMU_ACCEL_Z,
+    SIM_IMU_GYRO_X,
+    SIM_IMU_GYRO_Y,
+    SIM_IMU_GYRO_Z,
+    SIM_IMU_TEMP,
+    SIM_IMU_NUM
+};
+
+#define SIM_USS_NUM 5
+#define SIM_TEMPERATURE_NUM 4
+#define SIM_ACTUATOR_NUM 3
+#define SIM_LED_STRIP_NUM 4
+
+/* ADIS16470, SI units (m/s^2, rad/s, degC). */
+void sim_imu_set(int axis, float value);
+float sim_imu_get(int axis);
+
+/* MB1604_0 .. MB1604_4, millimeters. */
+void sim_uss_set(int index, uint32_t mm);
+uint32_t sim_uss_get(int index);
+
+/* ADT7410 compatible sensors on I2C_4, 1/128 degC. */
+void sim_temperature_set(int index, int16_t value);
+int16_t sim_temperature_get(int index);
+
+/* Actuator PWM outputs, the encoder counts and motor current they drive. */
+int sim_actuator_get_drive(int index);
+int32_t sim_actuator_get_position(int index);
+int32_t sim_actuator_get_current_ma(int index);
+
+/* Power board on CAN_2. */
+void sim_power_board_set_switches(uint8_t emergency, uint8_t bumper);
+void sim_power_board_set_enabled(bool enabled);
+
+/*
+ * UART_2, UART_4 and UART_6.  Injected bytes replace the host side of the
+ * port from then on; returns the number of bytes taken.  The hook sees
+ * every byte the firmware transmits, from the UART interrupt.
+ */
+typedef void (*sim_uart_tx_hook_t)(const uint8_t *buf, size_t len);
+size_t sim_uart_inject(const char *name, const uint8_t *buf, size_t len);
+int sim_uart_set_tx_hook(const char *name, sim_uart_tx_hook_t hook);
+
+/* WS2812_0 .. WS2812_3 framebuffers, written as a PPM image. */
+int sim_led_strip_dump(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+// vim: set expandtab shiftwidth=4:
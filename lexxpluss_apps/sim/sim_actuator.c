@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/adc/adc_emul.h>
+#include <drivers/pwm.h>
+#include "actuator_plant.h"
+#include "sim.h"
+#include "sim_hal.h"
+
+/*
+ * PWM_8, PWM_5 and PWM_2 drive the left, center and right actuators, each
+ * with an active low pin per direction.  A 1kHz timer steps the actuator
+ * model of actuator_plant.h with the resulting drive, turns its motion into
+ * encoder pulses on TIM3, TIM4 and TIM1 and its motor current into the
+ * shunt voltage on ADC_1 channels 11 to 13, so the position control loop
+ * closes without hardware.
+ */
+
+#define PWM_CHANNELS 5
+#define TICK_S 1e-3f
+
+static TIM_TypeDef tim[SIM_ACTUATOR_NUM];
+TIM_TypeDef *const TIM3 = &tim[0];
+TIM_TypeDef *const TIM4 = &tim[1];
+TIM_TypeDef *const TIM1 = &tim[2];
+
+struct sim_pwm_config {
+    int actuator;
+    uint32_t pin_down, pin_up;
+};
+
+struct sim_pwm_data {
+    uint32_t period[PWM_CHANNELS], pulse[PWM_CHANNELS];
+};
+
+static struct {
+    const struct device *pwm;
+    struct actuator_plant plant;
+    int32_t position;
+    int32_t shunt_mv;
+} actuator[SIM_ACTUATOR_NUM];
+
+static const uint8_t shunt_channel[SIM_ACTUATOR_NUM] = {11, 12, 13};
+
+static struct k_timer timer;
+
+static int duty_percent(const struct sim_pwm_data *data, uint32_t pin)
+{
+    if (data->period[pin] == 0)
+        return 0;
+    return 100 - data->pulse[pin] * 100 / data->period[pin];
+}
+
+int sim_actuator_get_drive(int index)
+{
+    if (index < 0 || index >= SIM_ACTUATOR_NUM || actuator[index].pwm == NULL)
+        return 0;
+    const struct sim_pwm_config *config = actuator[index].pwm->config;
+    const struct sim_pwm_data *data = actuator[index].pwm->data;
+    return duty_percent(data, config->pin_up) - duty_percent(data, config->pin_down);
+}
+
+int32_t sim_actuator_get_position(int index)
+{
+    return index >= 0 && index < SIM_ACTUATOR_NUM ? actuator[index].position : 0;
+}
+
+int32_t sim_actuator_get_current_ma(int index)
+{
+    return index >= 0 && index < SIM_ACTUATOR_NUM ? actuator[index].plant.current_a * 1000.0f : 0;
+}
+
+static void sim_actuator_tick(struct k_timer *timer)
+{
+    const struct device *adc = device_get_binding("ADC_1");
+    for (int i = 0; i < SIM_ACTUATOR_NUM; ++i) {
+        actuator_plant_step(&actuator[i].plant, &actuator_plant_default, sim_actuator_get_drive(i) / 100.0f, TICK_S);
+        int32_t position = actuator_plant_pulses(&actuator[i].plant, &actuator_plant_default);
+        /* The encoder driver negates the count. */
+        tim[i].CNT -= position - actuator[i].position;
+        actuator[i].position = position;
+        /* Only on change, so the sim shell and a replay can set it at rest. */
+        int32_t shunt_mv = actuator_plant_shunt_mv(&actuator[i].plant, &actuator_plant_default);
+        if (adc != NULL && shunt_mv != actuator[i].shunt_mv) {
+            adc_emul_const_value_set(adc, shunt_channel[i], shunt_mv);
+            actuator[i].shunt_mv = shunt_mv;
+        }
+    }
+}
+
+static int sim_pwm_pin_set(const struct device *dev, uint32_t pwm, uint32_t period_cycles,
+                           uint32_t pulse_cycles, pwm_flags_t flags)
+{
+    struct sim_pwm_data *data = dev->data;
+    if (pwm >= PWM_CHANNELS)
+        return -EINVAL;
+    data->period[pwm] = period_cycles;
+    data->pulse[pwm] = pulse_cycles;
+    return 0;
+}
+
+static int sim_pwm_get_cycles_per_sec(const struct device *dev, uint32_t pwm, uint64_t *cycles)
+{
+    *cycles = 1000000000ULL;
+    return 0;
+}
+
+static const struct pwm_driver_api sim_pwm_api = {
+    .pin_set = sim_pwm_pin_set,
+    .get_cycles_per_sec = sim_pwm_get_cycles_per_sec,
+};
+
+static int sim_pwm_init(const struct device *dev)
+{
+    const struct sim_pwm_config *config = dev->config;
+    actuator[config->actuator].pwm = dev;
+    if (config->actuator == 0) {
+        k_timer_init(&timer, sim_actuator_tick, NULL);
+        k_timer_start(&timer, K_MSEC(1), K_MSEC(1));
+    }
+    return 0;
+}
+
+#define SIM_PWM_DEFINE(n, index, down, up) \
+    static const struct sim_pwm_config sim_pwm_config_##n = {index, down, up}; \
+    static struct sim_pwm_data sim_pwm_data_##n; \
+    DEVICE_DEFINE(sim_pwm_##n, "PWM_" #n, sim_pwm_init, NULL, &sim_pwm_data_##n, &sim_pwm_config_##n, \
+                  POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_pwm_api)
+
+SIM_PWM_DEFINE(8, 0, 1, 2);
+SIM_PWM_DEFINE(5, 1, 1, 2);
+SIM_PWM_DEFINE(2, 2, 3, 4);
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *config)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *config)
+{
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t channel)
+{
+    htim->Instance->CNT = 0;
+    return HAL_OK;
+}
+
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init)
+{
+}
+
+// vim: set expandtab shiftwidth=4:
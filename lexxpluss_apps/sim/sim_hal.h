@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * The subset of the STM32 HAL timer API used by the actuator encoders.  On
+ * native_posix the timers are plain counters advanced by the actuator
+ * emulator in sim_actuator.c.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CNT;
+} TIM_TypeDef;
+
+extern TIM_TypeDef *const TIM1, *const TIM3, *const TIM4;
+
+typedef struct {
+    uint32_t Prescaler, CounterMode, Period, ClockDivision, RepetitionCounter, AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+typedef struct {
+    uint32_t EncoderMode;
+    uint32_t IC1Polarity, IC1Selection, IC1Prescaler, IC1Filter;
+    uint32_t IC2Polarity, IC2Selection, IC2Prescaler, IC2Filter;
+} TIM_Encoder_InitTypeDef;
+
+typedef struct {
+    uint32_t MasterOutputTrigger, MasterOutputTrigger2, MasterSlaveMode;
+} TIM_MasterConfigTypeDef;
+
+typedef struct {
+    uint32_t Pin, Mode, Pull, Speed, Alternate;
+} GPIO_InitTypeDef;
+
+typedef enum {
+    HAL_OK = 0,
+    HAL_ERROR
+} HAL_StatusTypeDef;
+
+enum {
+    TIM_COUNTERMODE_UP, TIM_CLOCKDIVISION_DIV1, TIM_AUTORELOAD_PRELOAD_DISABLE,
+    TIM_ENCODERMODE_TI12, TIM_ICPOLARITY_RISING, TIM_ICSELECTION_DIRECTTI, TIM_ICPSC_DIV1,
+    TIM_TRGO_RESET, TIM_TRGO2_RESET, TIM_MASTERSLAVEMODE_DISABLE, TIM_CHANNEL_ALL,
+    GPIO_MODE_AF_OD, GPIO_PULLUP, GPIO_SPEED_FREQ_LOW,
+    GPIO_AF1_TIM1, GPIO_AF2_TIM3, GPIO_AF2_TIM4
+};
+
+#define GPIO_PIN_6 (1U << 6)
+#define GPIO_PIN_7 (1U << 7)
+#define GPIO_PIN_9 (1U << 9)
+#define GPIO_PIN_11 (1U << 11)
+#define GPIO_PIN_12 (1U << 12)
+#define GPIO_PIN_13 (1U << 13)
+
+#define GPIOC ((void *)0)
+#define GPIOD ((void *)0)
+#define GPIOE ((void *)0)
+
+#define __HAL_RCC_TIM1_CLK_ENABLE()
+#define __HAL_RCC_TIM3_CLK_ENABLE()
+#define __HAL_RCC_TIM4_CLK_ENABLE()
+#define __HAL_RCC_GPIOC_CLK_ENABLE()
+#define __HAL_RCC_GPIOD_CLK_ENABLE()
+#define __HAL_RCC_GPIOE_CLK_ENABLE()
+
+HAL_StatusTypeDef HAL_TIM_Encoder_Init(TIM_HandleTypeDef *htim, TIM_Encoder_InitTypeDef *config);
+HAL_StatusTypeDef HAL_TIMEx_MasterConfigSynchronization(TIM_HandleTypeDef *htim, TIM_MasterConfigTypeDef *config);
+HAL_StatusTypeDef HAL_TIM_Encoder_Start(TIM_HandleTypeDef *htim, uint32_t channel);
+void HAL_GPIO_Init(void *port, GPIO_InitTypeDef *init);
+
+#ifdef __cplusplus
+}
+#endif
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/i2c.h>
+#include "sim.h"
+
+/*
+ * I2C_4 with the four ADT7410 compatible temperature sensors of the main
+ * and actuator boards at 0x48 .. 0x4b.  Only the registers the misc
+ * controller touches are modelled: temperature (0x00), config (0x03) and
+ * ID (0x0b).
+ */
+
+#define ADDR 0x48
+#define REG_TEMPERATURE 0x00
+#define REG_CONFIG 0x03
+#define REG_ID 0x0b
+#define ID_VALUE 0xcb
+
+static struct {
+    int16_t temperature;
+    uint8_t config;
+    uint8_t pointer;
+} sensor[SIM_TEMPERATURE_NUM] = {
+    {25 * 128}, {25 * 128}, {25 * 128}, {25 * 128}
+};
+
+void sim_temperature_set(int index, int16_t value)
+{
+    if (index >= 0 && index < SIM_TEMPERATURE_NUM)
+        sensor[index].temperature = value;
+}
+
+int16_t sim_temperature_get(int index)
+{
+    return index >= 0 && index < SIM_TEMPERATURE_NUM ? sensor[index].temperature : 0;
+}
+
+static uint8_t read_register(int index, uint8_t reg)
+{
+    switch (reg) {
+    case REG_TEMPERATURE:
+        return sensor[index].temperature >> 8;
+    case REG_TEMPERATURE + 1:
+        return sensor[index].temperature & 0xff;
+    case REG_CONFIG:
+        return sensor[index].config;
+    case REG_ID:
+        return ID_VALUE;
+    default:
+        return 0;
+    }
+}
+
+static int sim_i2c_configure(const struct device *dev, uint32_t dev_config)
+{
+    return 0;
+}
+
+static int sim_i2c_transfer(const struct device *dev, struct i2c_msg *msgs, uint8_t num_msgs, uint16_t addr)
+{
+    int index = addr - ADDR;
+    if (index < 0 || index >= SIM_TEMPERATURE_NUM)
+        return -EIO;
+    for (uint8_t i = 0; i < num_msgs; ++i) {
+        struct i2c_msg *msg = &msgs[i];
+        if ((msg->flags & I2C_MSG_RW_MASK) == I2C_MSG_WRITE) {
+            if (msg->len > 0)
+                sensor[index].pointer = msg->buf[0];
+            if (msg->len > 1 && sensor[index].pointer == REG_CONFIG)
+                sensor[index].config = msg->buf[1];
+        } else {
+            for (uint32_t j = 0; j < msg->len; ++j)
+                msg->buf[j] = read_register(index, sensor[index].pointer + j);
+        }
+    }
+    return 0;
+}
+
+static const struct i2c_driver_api sim_i2c_api = {
+    .configure = sim_i2c_configure,
+    .transfer = sim_i2c_transfer,
+};
+
+static int sim_i2c_init(const struct device *dev)
+{
+    return 0;
+}
+
+DEVICE_DEFINE(sim_i2c_4, "I2C_4", sim_i2c_init, NULL, NULL, NULL,
+              POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_i2c_api);
+
+// vim: set expandtab shiftwidth=4:
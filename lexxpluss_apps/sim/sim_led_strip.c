@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define DT_DRV_COMPAT lexxpluss_sim_led_strip
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/led_strip.h>
+#include <errno.h>
+#include <stdio.h>
+#include "sim.h"
+
+/*
+ * WS2812 strips as framebuffers.  Every update replaces the stored pixels,
+ * and "sim leds <path>" writes all strips into one PPM image, one row per
+ * strip in devicetree instance order.
+ */
+
+#define SIM_LED_STRIP_PIXELS(n) uint8_t strip##n[DT_INST_PROP(n, chain_length)];
+#define MAX_PIXELS sizeof (union {DT_INST_FOREACH_STATUS_OKAY(SIM_LED_STRIP_PIXELS)})
+
+struct sim_led_strip_data {
+    struct led_rgb pixels[MAX_PIXELS];
+    size_t num_pixels;
+};
+
+struct sim_led_strip_config {
+    size_t chain_length;
+};
+
+static int sim_led_strip_update_rgb(const struct device *dev, struct led_rgb *pixels, size_t num_pixels)
+{
+    struct sim_led_strip_data *data = dev->data;
+    const struct sim_led_strip_config *config = dev->config;
+    num_pixels = MIN(num_pixels, config->chain_length);
+    unsigned int key = irq_lock();
+    memcpy(data->pixels, pixels, num_pixels * sizeof pixels[0]);
+    data->num_pixels = num_pixels;
+    irq_unlock(key);
+    return 0;
+}
+
+static int sim_led_strip_update_channels(const struct device *dev, uint8_t *channels, size_t num_channels)
+{
+    return -ENOTSUP;
+}
+
+static const struct led_strip_driver_api sim_led_strip_api = {
+    .update_rgb = sim_led_strip_update_rgb,
+    .update_channels = sim_led_strip_update_channels,
+};
+
+static int sim_led_strip_init(const struct device *dev)
+{
+    return 0;
+}
+
+#define SIM_LED_STRIP_DEFINE(n) \
+    static const struct sim_led_strip_config sim_led_strip_config_##n = {DT_INST_PROP(n, chain_length)}; \
+    static struct sim_led_strip_data sim_led_strip_data_##n; \
+    DEVICE_DT_INST_DEFINE(n, sim_led_strip_init, NULL, &sim_led_strip_data_##n, &sim_led_strip_config_##n, \
+                          POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_led_strip_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SIM_LED_STRIP_DEFINE)
+
+#define SIM_LED_STRIP_GET(n) DEVICE_DT_INST_GET(n),
+
+static const struct device *const strips[] = {
+    DT_INST_FOREACH_STATUS_OKAY(SIM_LED_STRIP_GET)
+};
+
+int sim_led_strip_dump(const char *path)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+        return -errno;
+    fprintf(fp, "P6\n%d %d\n255\n", (int)MAX_PIXELS, (int)ARRAY_SIZE(strips));
+    for (size_t i = 0; i < ARRAY_SIZE(strips); ++i) {
+        struct sim_led_strip_data data;
+        unsigned int key = irq_lock();
+        data = *(struct sim_led_strip_data *)strips[i]->data;
+        irq_unlock(key);
+        for (size_t j = 0; j < MAX_PIXELS; ++j) {
+            uint8_t rgb[3] = {0, 0, 0};
+            if (j < data.num_pixels) {
+                rgb[0] = data.pixels[j].r;
+                rgb[1] = data.pixels[j].g;
+                rgb[2] = data.pixels[j].b;
+            }
+            fwrite(rgb, sizeof rgb, 1, fp);
+        }
+    }
+    fclose(fp);
+    return 0;
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/can.h>
+#include "sim.h"
+
+/*
+ * Power board on CAN_2.  The bus itself is the Zephyr CAN loopback driver
+ * registered as CAN_2, so frames sent here reach the filters of the CAN
+ * controller exactly like frames from the real board.  Sends the 0x200
+ * status frame every 100ms and the version string (0.0.0) once.
+ */
+
+#define PERIOD_MS 100
+#define STATE_NORMAL 2
+
+static struct {
+    uint8_t emergency, bumper;
+    bool enabled;
+} board = {
+    .enabled = true,
+};
+
+void sim_power_board_set_switches(uint8_t emergency, uint8_t bumper)
+{
+    board.emergency = emergency;
+    board.bumper = bumper;
+}
+
+void sim_power_board_set_enabled(bool enabled)
+{
+    board.enabled = enabled;
+}
+
+static void send_status(const struct device *dev)
+{
+    struct zcan_frame frame = {
+        .id_type = CAN_STANDARD_IDENTIFIER,
+        .rtr = CAN_DATAFRAME,
+        .id = 0x200,
+        .dlc = 8,
+    };
+    frame.data[0] = 0b00000001 |
+                    (board.emergency & 0b11) << 1 |
+                    (board.bumper & 0b11) << 3;
+    frame.data[3] = STATE_NORMAL << 2;
+    frame.data[7] = 30;
+    can_send(dev, &frame, K_MSEC(PERIOD_MS), NULL, NULL);
+}
+
+static void send_version(const struct device *dev)
+{
+    static const char version[] = "000";
+    struct zcan_frame frame = {
+        .id_type = CAN_STANDARD_IDENTIFIER,
+        .rtr = CAN_DATAFRAME,
+        .id = 0x203,
+        .dlc = sizeof version,
+    };
+    memcpy(frame.data, version, sizeof version);
+    can_send(dev, &frame, K_MSEC(PERIOD_MS), NULL, NULL);
+}
+
+static void sim_power_board_run(void *p1, void *p2, void *p3)
+{
+    const struct device *dev = device_get_binding("CAN_2");
+    if (!device_is_ready(dev))
+        return;
+    bool version_sent = false;
+    while (true) {
+        k_msleep(PERIOD_MS);
+        if (!board.enabled)
+            continue;
+        send_status(dev);
+        if (!version_sent) {
+            send_version(dev);
+            version_sent = true;
+        }
+    }
+}
+
+K_THREAD_DEFINE(sim_power_board, 1024, sim_power_board_run, NULL, NULL, NULL,
+                K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/adc.h>
+#include <drivers/adc/adc_emul.h>
+#include <drivers/can.h>
+#include <stdio.h>
+#include <string.h>
+#include "cmdline.h"
+#include "posix_board_if.h"
+#include "soc.h"
+#include "recording.h"
+#include "sim.h"
+
+/*
+ * Replays a recording of the firmware, see recording.h, into the emulated
+ * peripherals:
+ *
+ *   zephyr.exe -replay=rec.bin [-replay_out=out.bin]
+ *
+ * Each record is applied at its recorded time, counted from when the
+ * replay thread starts.  Simulated time does not depend on the host, so
+ * two runs of the same build over the same recording are identical, and
+ * the outputs written to -replay_out can be compared with cmp.
+ *
+ * CAN frames are sent on the CAN_2 loopback bus in place of the power
+ * board emulator, the IMU, ADC and ultrasonic values are set on their
+ * emulators and the rosserial bytes are injected into UART_6 and UART_2.
+ * PGV answers are not timed but given when the firmware sends the request
+ * they answer, as the PGV controller drops anything received before.
+ */
+
+#define DRAIN_MS 1000
+#define PGV_ANSWERS 8
+
+static struct {
+    char *path, *out_path;
+    FILE *out;
+    uint64_t start_us;
+    uint32_t records, outputs, lost;
+} replay;
+
+static struct {
+    struct {
+        uint8_t request, len;
+        uint8_t data[64];
+    } answer[PGV_ANSWERS];
+    uint32_t count;
+    uint8_t tx_prev;
+    bool tx_prev_valid, pending_valid;
+    uint8_t pending;
+} pgv;
+
+static uint64_t now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void write_output(uint8_t type, const uint8_t *buf, size_t len)
+{
+    if (replay.out == NULL)
+        return;
+    unsigned int key = irq_lock();
+    while (len > 0) {
+        struct recording_record_header header = {
+            .stamp_us = (uint32_t)(now_us() - replay.start_us),
+            .type = type,
+            .len = MIN(len, UINT8_MAX),
+        };
+        fwrite(&header, sizeof header, 1, replay.out);
+        fwrite(buf, 1, header.len, replay.out);
+        buf += header.len;
+        len -= header.len;
+        ++replay.outputs;
+    }
+    irq_unlock(key);
+}
+
+static void rosserial_tx(const uint8_t *buf, size_t len)
+{
+    write_output(RECORDING_OUT_ROSSERIAL_TX, buf, len);
+}
+
+static void can_tx(struct zcan_frame *frame, void *arg)
+{
+    uint8_t payload[3 + sizeof frame->data] = {frame->id, frame->id >> 8, frame->dlc};
+    memcpy(&payload[3], frame->data, frame->dlc);
+    write_output(RECORDING_OUT_CAN_TX, payload, 3 + frame->dlc);
+}
+
+static void inject_uart(const char *name, const uint8_t *buf, size_t len)
+{
+    replay.lost += len - sim_uart_inject(name, buf, len);
+}
+
+/* Gives the newest answer to request and drops the ones before it. */
+static bool pgv_answer(uint8_t request)
+{
+    for (uint32_t i = pgv.count; i > 0; --i) {
+        if (pgv.answer[i - 1].request == request) {
+            inject_uart("UART_4", pgv.answer[i - 1].data, pgv.answer[i - 1].len);
+            memmove(&pgv.answer[0], &pgv.answer[i], (pgv.count - i) * sizeof pgv.answer[0]);
+            pgv.count -= i;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Requests are a command byte followed by its complement. */
+static void pgv_tx(const uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len; ++i) {
+        if (pgv.tx_prev_valid && buf[i] == (uint8_t)~pgv.tx_prev) {
+            pgv.tx_prev_valid = false;
+            pgv.pending_valid = !pgv_answer(pgv.tx_prev);
+            pgv.pending = pgv.tx_prev;
+        } else {
+            pgv.tx_prev = buf[i];
+            pgv.tx_prev_valid = true;
+        }
+    }
+}
+
+static void pgv_queue(const uint8_t *payload, uint8_t len)
+{
+    if (len < 1)
+        return;
+    unsigned int key = irq_lock();
+    if (pgv.count == PGV_ANSWERS) {
+        memmove(&pgv.answer[0], &pgv.answer[1], (PGV_ANSWERS - 1) * sizeof pgv.answer[0]);
+        --pgv.count;
+    }
+    pgv.answer[pgv.count].request = payload[0];
+    pgv.answer[pgv.count].len = MIN(len - 1, sizeof pgv.answer[0].data);
+    memcpy(pgv.answer[pgv.count].data, &payload[1], pgv.answer[pgv.count].len);
+    ++pgv.count;
+    if (pgv.pending_valid && pgv.pending == payload[0])
+        pgv.pending_valid = !pgv_answer(pgv.pending);
+    irq_unlock(key);
+}
+
+static void inject_can(const struct device *dev, const uint8_t *payload, uint8_t len)
+{
+    if (len < 3 || payload[2] > 8 || len < 3 + payload[2])
+        return;
+    struct zcan_frame frame = {
+        .id_type = CAN_STANDARD_IDENTIFIER,
+        .rtr = CAN_DATAFRAME,
+        .id = payload[0] | payload[1] << 8,
+        .dlc = payload[2],
+    };
+    memcpy(frame.data, &payload[3], frame.dlc);
+    can_send(dev, &frame, K_MSEC(100), NULL, NULL);
+}
+
+static void inject_adc(const uint8_t *payload, uint8_t len)
+{
+    static const uint8_t channel[] = {8, 9, 10, 11, 12, 13};
+    const struct device *dev = device_get_binding("ADC_1");
+    if (len != sizeof channel * sizeof(uint16_t) || dev == NULL)
+        return;
+    uint32_t ref = adc_ref_internal(dev);
+    for (uint32_t i = 0; i < ARRAY_SIZE(channel); ++i) {
+        uint32_t raw = payload[i * 2] | payload[i * 2 + 1] << 8;
+        /* Rounded up, so the emulator converts it back to raw or one above. */
+        adc_emul_const_value_set(dev, channel[i], (raw * ref + 4095) >> 12);
+    }
+}
+
+static void inject(const struct device *can, const struct recording_record_header *header,
+                   const uint8_t *payload)
+{
+    switch (header->type) {
+    case RECORDING_CAN:
+        inject_can(can, payload, header->len);
+        break;
+    case RECORDING_IMU:
+        if (header->len == sizeof(struct recording_imu)) {
+            struct recording_imu imu;
+            memcpy(&imu, payload, sizeof imu);
+            for (int i = 0; i < SIM_IMU_NUM; ++i)
+                sim_imu_set(i, imu.value[i]);
+        }
+        break;
+    case RECORDING_ADC:
+        inject_adc(payload, header->len);
+        break;
+    case RECORDING_USS:
+        if (header->len == sizeof(struct recording_uss)) {
+            struct recording_uss uss;
+            memcpy(&uss, payload, sizeof uss);
+            if (uss.channel < SIM_USS_NUM)
+                sim_uss_set(uss.channel, MAX(uss.distance_mm, 0));
+        }
+        break;
+    case RECORDING_PGV:
+        pgv_queue(payload, header->len);
+        break;
+    case RECORDING_ROSSERIAL_RX:
+        inject_uart("UART_6", payload, header->len);
+        break;
+    case RECORDING_ROSSERIAL_SERVICE_RX:
+        inject_uart("UART_2", payload, header->len);
+        break;
+    default:
+        return;
+    }
+    ++replay.records;
+}
+
+static bool open_files(FILE **in)
+{
+    *in = fopen(replay.path, "rb");
+    struct recording_file_header header;
+    if (*in == NULL || fread(&header, sizeof header, 1, *in) != 1 ||
+        memcmp(header.magic, RECORDING_MAGIC, sizeof header.magic) != 0 ||
+        header.version != RECORDING_VERSION) {
+        printk("replay: %s is not a version %d recording\n", replay.path, RECORDING_VERSION);
+        return false;
+    }
+    if (replay.out_path != NULL) {
+        replay.out = fopen(replay.out_path, "wb");
+        if (replay.out == NULL) {
+            printk("replay: unable to create %s\n", replay.out_path);
+            return false;
+        }
+        fwrite(&header, sizeof header, 1, replay.out);
+    }
+    return true;
+}
+
+static void sim_replay_run(void *p1, void *p2, void *p3)
+{
+    if (replay.path == NULL)
+        return;
+    FILE *in;
+    const struct device *can = device_get_binding("CAN_2");
+    if (!device_is_ready(can) || !open_files(&in))
+        posix_exit(1);
+    sim_power_board_set_enabled(false);
+    sim_uart_set_tx_hook("UART_4", pgv_tx);
+    sim_uart_set_tx_hook("UART_6", rosserial_tx);
+    static const struct zcan_filter filter_board = {
+        .id_type = CAN_STANDARD_IDENTIFIER,
+        .rtr = CAN_DATAFRAME,
+        .id = 0x201,
+        .rtr_mask = 1,
+        .id_mask = CAN_STD_ID_MASK,
+    };
+    can_attach_isr(can, can_tx, NULL, &filter_board);
+    replay.start_us = now_us();
+    uint64_t wraps = 0;
+    uint32_t prev_stamp = 0;
+    struct recording_record_header header;
+    uint8_t payload[UINT8_MAX];
+    while (fread(&header, sizeof header, 1, in) == 1 &&
+           fread(payload, 1, header.len, in) == header.len) {
+        if (header.stamp_us < prev_stamp)
+            wraps += 1ULL << 32;
+        prev_stamp = header.stamp_us;
+        int64_t wait_us = (int64_t)(replay.start_us + wraps + header.stamp_us - now_us());
+        if (wait_us > 0)
+            k_usleep(wait_us);
+        inject(can, &header, payload);
+    }
+    fclose(in);
+    k_msleep(DRAIN_MS);
+    printk("replay: %u records in %u ms, %u outputs, %u bytes lost\n",
+           replay.records, (uint32_t)((now_us() - replay.start_us) / 1000),
+           replay.outputs, replay.lost);
+    if (replay.out != NULL)
+        fclose(replay.out);
+    posix_exit(0);
+}
+
+K_THREAD_DEFINE(sim_replay, 2048, sim_replay_run, NULL, NULL, NULL, 0, 0, 0);
+
+static void sim_replay_options(void)
+{
+    static struct args_struct_t options[] = {
+        {false, false, false, "replay", "file", 's', (void *)&replay.path, NULL,
+         "Replay the controller inputs recorded in file"},
+        {false, false, false, "replay_out", "file", 's', (void *)&replay.out_path, NULL,
+         "Write the rosserial and CAN outputs of the replay to file"},
+        ARG_TABLE_ENDMARKER
+    };
+    native_add_command_line_opts(options);
+}
+
+NATIVE_TASK(sim_replay_options, PRE_BOOT_1, 20);
+
+// vim: set expandtab shiftwidth=4:
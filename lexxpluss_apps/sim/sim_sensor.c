@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/sensor.h>
+#include "sim.h"
+
+/*
+ * ADIS16470 and MB1604 emulators.  Samples are taken from the values set by
+ * the "sim" shell command; the IMU also integrates its delta angle and
+ * delta velocity channels like the real part does between two fetches.
+ */
+
+#define IMU_PERIOD_S 0.0025f
+
+static struct {
+    float value[SIM_IMU_NUM];
+    float delta[6];
+} imu = {
+    .value = {[SIM_IMU_ACCEL_Z] = 9.80665f, [SIM_IMU_TEMP] = 25.0f},
+};
+
+static uint32_t uss_mm[SIM_USS_NUM] = {3000, 3000, 3000, 3000, 3000};
+
+void sim_imu_set(int axis, float value)
+{
+    if (axis >= 0 && axis < SIM_IMU_NUM)
+        imu.value[axis] = value;
+}
+
+float sim_imu_get(int axis)
+{
+    return axis >= 0 && axis < SIM_IMU_NUM ? imu.value[axis] : 0.0f;
+}
+
+void sim_uss_set(int index, uint32_t mm)
+{
+    if (index >= 0 && index < SIM_USS_NUM)
+        uss_mm[index] = mm;
+}
+
+uint32_t sim_uss_get(int index)
+{
+    return index >= 0 && index < SIM_USS_NUM ? uss_mm[index] : 0;
+}
+
+static int imu_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+    for (int i = 0; i < 3; ++i) {
+        imu.delta[i] = imu.value[SIM_IMU_GYRO_X + i] * IMU_PERIOD_S;
+        imu.delta[3 + i] = imu.value[SIM_IMU_ACCEL_X + i] * IMU_PERIOD_S;
+    }
+    return 0;
+}
+
+static int imu_channel_get(const struct device *dev, enum sensor_channel chan, struct sensor_value *val)
+{
+    switch (chan) {
+    case SENSOR_CHAN_ACCEL_X:
+    case SENSOR_CHAN_ACCEL_Y:
+    case SENSOR_CHAN_ACCEL_Z:
+        sensor_value_from_double(val, imu.value[SIM_IMU_ACCEL_X + chan - SENSOR_CHAN_ACCEL_X]);
+        return 0;
+    case SENSOR_CHAN_GYRO_X:
+    case SENSOR_CHAN_GYRO_Y:
+    case SENSOR_CHAN_GYRO_Z:
+        sensor_value_from_double(val, imu.value[SIM_IMU_GYRO_X + chan - SENSOR_CHAN_GYRO_X]);
+        return 0;
+    case SENSOR_CHAN_DIE_TEMP:
+        sensor_value_from_double(val, imu.value[SIM_IMU_TEMP]);
+        return 0;
+    default:
+        if (chan >= SENSOR_CHAN_PRIV_START && chan < SENSOR_CHAN_PRIV_START + 6) {
+            sensor_value_from_double(val, imu.delta[chan - SENSOR_CHAN_PRIV_START]);
+            return 0;
+        }
+        return -ENOTSUP;
+    }
+}
+
+static const struct sensor_driver_api imu_api = {
+    .sample_fetch = imu_sample_fetch,
+    .channel_get = imu_channel_get,
+};
+
+static int uss_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+    return 0;
+}
+
+static int uss_channel_get(const struct device *dev, enum sensor_channel chan, struct sensor_value *val)
+{
+    if (chan != SENSOR_CHAN_DISTANCE)
+        return -ENOTSUP;
+    uint32_t mm = uss_mm[(uintptr_t)dev->config];
+    val->val1 = mm / 1000;
+    val->val2 = (mm % 1000) * 1000;
+    return 0;
+}
+
+static const struct sensor_driver_api uss_api = {
+    .sample_fetch = uss_sample_fetch,
+    .channel_get = uss_channel_get,
+};
+
+static int sim_sensor_init(const struct device *dev)
+{
+    return 0;
+}
+
+DEVICE_DEFINE(sim_adis16470, "ADIS16470", sim_sensor_init, NULL, NULL, NULL,
+              POST_KERNEL, CONFIG_SENSOR_INIT_PRIORITY, &imu_api);
+
+/* The channel index rides in the config pointer. */
+#define SIM_USS_DEFINE(n) \
+    DEVICE_DEFINE(sim_mb1604_##n, "MB1604_" #n, sim_sensor_init, NULL, NULL, (const void *)n, \
+                  POST_KERNEL, CONFIG_SENSOR_INIT_PRIORITY, &uss_api)
+
+SIM_USS_DEFINE(0);
+SIM_USS_DEFINE(1);
+SIM_USS_DEFINE(2);
+SIM_USS_DEFINE(3);
+SIM_USS_DEFINE(4);
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/adc/adc_emul.h>
+#include <drivers/gpio/gpio_emul.h>
+#include <shell/shell.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+static const char *const imu_axis[SIM_IMU_NUM] = {
+    "ax", "ay", "az", "gx", "gy", "gz", "temp"
+};
+
+static int cmd_info(const struct shell *shell, size_t argc, char **argv)
+{
+    for (int i = 0; i < SIM_IMU_NUM; ++i)
+        shell_print(shell, "imu %-4s %f", imu_axis[i], sim_imu_get(i));
+    for (int i = 0; i < SIM_USS_NUM; ++i)
+        shell_print(shell, "uss %d %umm", i, sim_uss_get(i));
+    for (int i = 0; i < SIM_TEMPERATURE_NUM; ++i)
+        shell_print(shell, "temperature %d %fdeg", i, sim_temperature_get(i) / 128.0f);
+    for (int i = 0; i < SIM_ACTUATOR_NUM; ++i)
+        shell_print(shell, "actuator %d drive:%d%% position:%d current:%dmA", i, sim_actuator_get_drive(i),
+                    sim_actuator_get_position(i), sim_actuator_get_current_ma(i));
+    return 0;
+}
+
+static int cmd_imu(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc == 3) {
+        for (int i = 0; i < SIM_IMU_NUM; ++i) {
+            if (strcmp(argv[1], imu_axis[i]) == 0) {
+                sim_imu_set(i, strtof(argv[2], NULL));
+                return 0;
+            }
+        }
+    }
+    shell_error(shell, "Usage: %s %s <ax|ay|az|gx|gy|gz|temp> <value>\n", argv[-1], argv[0]);
+    return 1;
+}
+
+static int cmd_uss(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc != 3) {
+        shell_error(shell, "Usage: %s %s <index> <mm>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    sim_uss_set(atoi(argv[1]), atoi(argv[2]));
+    return 0;
+}
+
+static int cmd_temp(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc != 3) {
+        shell_error(shell, "Usage: %s %s <index> <deg>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    sim_temperature_set(atoi(argv[1]), (int16_t)(strtof(argv[2], NULL) * 128.0f));
+    return 0;
+}
+
+static int cmd_adc(const struct shell *shell, size_t argc, char **argv)
+{
+    const struct device *dev = device_get_binding("ADC_1");
+    if (argc != 3 || !device_is_ready(dev)) {
+        shell_error(shell, "Usage: %s %s <channel> <mv>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    return adc_emul_const_value_set(dev, atoi(argv[1]), atoi(argv[2]));
+}
+
+static int cmd_gpio(const struct shell *shell, size_t argc, char **argv)
+{
+    char label[] = "GPIOx";
+    if (argc != 4 || strlen(argv[1]) != 1) {
+        shell_error(shell, "Usage: %s %s <A-J> <pin> <0|1>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    label[4] = argv[1][0];
+    const struct device *dev = device_get_binding(label);
+    if (!device_is_ready(dev)) {
+        shell_error(shell, "%s not found", label);
+        return 1;
+    }
+    return gpio_emul_input_set(dev, atoi(argv[2]), atoi(argv[3]));
+}
+
+static int cmd_board(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)) {
+        sim_power_board_set_enabled(strcmp(argv[1], "on") == 0);
+    } else if (argc == 3) {
+        sim_power_board_set_switches(atoi(argv[1]), atoi(argv[2]));
+    } else {
+        shell_error(shell, "Usage: %s %s <on|off> | <emergency bits> <bumper bits>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    return 0;
+}
+
+static int cmd_leds(const struct shell *shell, size_t argc, char **argv)
+{
+    if (argc != 2) {
+        shell_error(shell, "Usage: %s %s <path.ppm>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    int result = sim_led_strip_dump(argv[1]);
+    if (result != 0)
+        shell_error(shell, "unable to write %s (%d)", argv[1], result);
+    return result;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Emulator state", cmd_info),
+    SHELL_CMD(imu, NULL, "Set an ADIS16470 axis", cmd_imu),
+    SHELL_CMD(uss, NULL, "Set an MB1604 distance", cmd_uss),
+    SHELL_CMD(temp, NULL, "Set an I2C temperature sensor", cmd_temp),
+    SHELL_CMD(adc, NULL, "Set an ADC_1 channel", cmd_adc),
+    SHELL_CMD(gpio, NULL, "Drive a GPIO input", cmd_gpio),
+    SHELL_CMD(board, NULL, "Power board switches", cmd_board),
+    SHELL_CMD(leds, NULL, "Dump the LED strips as PPM", cmd_leds),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(sim, &sub, "Simulated board commands", NULL);
+
+// vim: set expandtab shiftwidth=4:
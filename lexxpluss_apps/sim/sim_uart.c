@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+// posix_openpt() and friends.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/uart.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include "sim.h"
+
+/*
+ * Interrupt driven UART backed by a host pseudo terminal.  The upstream
+ * native_posix UART only polls and has two ports, while rosserial, the
+ * rosserial service port and the PGV RS485 line all need the interrupt API.
+ * A 1ms timer stands in for the UART interrupt: it pulls whatever the host
+ * side wrote and lets the ISR move up to one millisecond worth of bytes at
+ * the configured baudrate.
+ *
+ * Once a replay injects bytes into a port, its input comes only from the
+ * replay and the host side is no longer read.
+ */
+
+#define INJECT_SIZE 1024
+
+struct sim_uart_data {
+    const struct device *dev;
+    struct k_timer timer;
+    uart_irq_callback_user_data_t callback;
+    void *user_data;
+    int fd;
+    uint32_t baudrate;
+    uint32_t tx_budget;
+    uint8_t rx_buf[64];
+    uint32_t rx_head, rx_tail;
+    bool rx_irq, tx_irq, tx_idle;
+    uint8_t inject[INJECT_SIZE];
+    uint32_t inject_head, inject_tail;
+    bool injected;
+    sim_uart_tx_hook_t tx_hook;
+};
+
+static void sim_uart_fill_injected(struct sim_uart_data *data)
+{
+    unsigned int key = irq_lock();
+    uint32_t n = MIN(data->inject_tail - data->inject_head, sizeof data->rx_buf);
+    for (uint32_t i = 0; i < n; ++i)
+        data->rx_buf[i] = data->inject[(data->inject_head + i) % INJECT_SIZE];
+    data->inject_head += n;
+    irq_unlock(key);
+    data->rx_head = 0;
+    data->rx_tail = n;
+}
+
+static void sim_uart_fill_rx(struct sim_uart_data *data)
+{
+    if (data->rx_head != data->rx_tail)
+        return;
+    if (data->injected) {
+        sim_uart_fill_injected(data);
+        return;
+    }
+    if (data->fd < 0)
+        return;
+    /* A closed slave side reads as EIO, treat it as an idle line. */
+    ssize_t n = read(data->fd, data->rx_buf, sizeof data->rx_buf);
+    data->rx_head = 0;
+    data->rx_tail = n > 0 ? n : 0;
+}
+
+static void sim_uart_tick(struct k_timer *timer)
+{
+    struct sim_uart_data *data = CONTAINER_OF(timer, struct sim_uart_data, timer);
+    data->tx_budget = MAX(data->baudrate / 10 / 1000, 1);
+    sim_uart_fill_rx(data);
+    if (data->callback != NULL && (data->rx_irq || data->tx_irq))
+        data->callback(data->dev, data->user_data);
+}
+
+static int sim_uart_poll_in(const struct device *dev, unsigned char *c)
+{
+    struct sim_uart_data *data = dev->data;
+    sim_uart_fill_rx(data);
+    if (data->rx_head == data->rx_tail)
+        return -1;
+    *c = data->rx_buf[data->rx_head++];
+    return 0;
+}
+
+static void sim_uart_poll_out(const struct device *dev, unsigned char c)
+{
+    struct sim_uart_data *data = dev->data;
+    if (data->fd >= 0)
+        (void)write(data->fd, &c, 1);
+}
+
+static int sim_uart_configure(const struct device *dev, const struct uart_config *cfg)
+{
+    struct sim_uart_data *data = dev->data;
+    data->baudrate = cfg->baudrate;
+    return 0;
+}
+
+static int sim_uart_fifo_fill(const struct device *dev, const uint8_t *tx_data, int size)
+{
+    struct sim_uart_data *data = dev->data;
+    size = MIN(size, (int)data->tx_budget);
+    if (data->tx_hook != NULL && size > 0)
+        data->tx_hook(tx_data, size);
+    /* Nobody listening on the host side behaves like an open line. */
+    if (data->fd >= 0 && size > 0)
+        (void)write(data->fd, tx_data, size);
+    data->tx_budget -= size;
+    data->tx_idle = false;
+    return size;
+}
+
+static int sim_uart_fifo_read(const struct device *dev, uint8_t *rx_data, const int size)
+{
+    struct sim_uart_data *data = dev->data;
+    int n = MIN(size, (int)(data->rx_tail - data->rx_head));
+    memcpy(rx_data, &data->rx_buf[data->rx_head], n);
+    data->rx_head += n;
+    return n;
+}
+
+static void sim_uart_irq_tx_enable(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    data->tx_irq = true;
+}
+
+static void sim_uart_irq_tx_disable(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    data->tx_irq = false;
+}
+
+static int sim_uart_irq_tx_ready(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    if (!data->tx_irq || data->tx_budget == 0)
+        return 0;
+    /* Completion is reported once the ISR had room and did not use it. */
+    data->tx_idle = true;
+    return 1;
+}
+
+static int sim_uart_irq_tx_complete(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    return data->tx_idle;
+}
+
+static void sim_uart_irq_rx_enable(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    data->rx_irq = true;
+}
+
+static void sim_uart_irq_rx_disable(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    data->rx_irq = false;
+}
+
+static int sim_uart_irq_rx_ready(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    return data->rx_irq && data->rx_head != data->rx_tail;
+}
+
+static int sim_uart_irq_is_pending(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    return sim_uart_irq_rx_ready(dev) || (data->tx_irq && data->tx_budget > 0);
+}
+
+static int sim_uart_irq_update(const struct device *dev)
+{
+    return 1;
+}
+
+static void sim_uart_irq_callback_set(const struct device *dev, uart_irq_callback_user_data_t cb, void *user_data)
+{
+    struct sim_uart_data *data = dev->data;
+    data->callback = cb;
+    data->user_data = user_data;
+}
+
+static const struct uart_driver_api sim_uart_api = {
+    .poll_in = sim_uart_poll_in,
+    .poll_out = sim_uart_poll_out,
+    .configure = sim_uart_configure,
+    .fifo_fill = sim_uart_fifo_fill,
+    .fifo_read = sim_uart_fifo_read,
+    .irq_tx_enable = sim_uart_irq_tx_enable,
+    .irq_tx_disable = sim_uart_irq_tx_disable,
+    .irq_tx_ready = sim_uart_irq_tx_ready,
+    .irq_tx_complete = sim_uart_irq_tx_complete,
+    .irq_rx_enable = sim_uart_irq_rx_enable,
+    .irq_rx_disable = sim_uart_irq_rx_disable,
+    .irq_rx_ready = sim_uart_irq_rx_ready,
+    .irq_is_pending = sim_uart_irq_is_pending,
+    .irq_update = sim_uart_irq_update,
+    .irq_callback_set = sim_uart_irq_callback_set,
+};
+
+static int sim_uart_open_pty(const char *name)
+{
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        printk("%s: unable to open a pseudo terminal\n", name);
+        return -1;
+    }
+    struct termios ter;
+    if (tcgetattr(fd, &ter) == 0) {
+        cfmakeraw(&ter);
+        tcsetattr(fd, TCSANOW, &ter);
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    printk("%s connected to %s\n", name, ptsname(fd));
+    return fd;
+}
+
+static int sim_uart_init(const struct device *dev)
+{
+    struct sim_uart_data *data = dev->data;
+    data->dev = dev;
+    data->baudrate = 115200;
+    data->fd = sim_uart_open_pty(dev->name);
+    k_timer_init(&data->timer, sim_uart_tick, NULL);
+    k_timer_start(&data->timer, K_MSEC(1), K_MSEC(1));
+    return 0;
+}
+
+#define SIM_UART_DEFINE(n) \
+    static struct sim_uart_data sim_uart_data_##n; \
+    DEVICE_DEFINE(sim_uart_##n, "UART_" #n, sim_uart_init, NULL, &sim_uart_data_##n, NULL, \
+                  POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &sim_uart_api)
+
+SIM_UART_DEFINE(2);
+SIM_UART_DEFINE(4);
+SIM_UART_DEFINE(6);
+
+static struct sim_uart_data *sim_uart_find(const char *name)
+{
+    const struct device *dev = device_get_binding(name);
+    return dev != NULL && dev->api == &sim_uart_api ? dev->data : NULL;
+}
+
+size_t sim_uart_inject(const char *name, const uint8_t *buf, size_t len)
+{
+    struct sim_uart_data *data = sim_uart_find(name);
+    if (data == NULL)
+        return 0;
+    unsigned int key = irq_lock();
+    data->injected = true;
+    len = MIN(len, INJECT_SIZE - (data->inject_tail - data->inject_head));
+    for (size_t i = 0; i < len; ++i)
+        data->inject[data->inject_tail++ % INJECT_SIZE] = buf[i];
+    irq_unlock(key);
+    return len;
+}
+
+int sim_uart_set_tx_hook(const char *name, sim_uart_tx_hook_t hook)
+{
+    struct sim_uart_data *data = sim_uart_find(name);
+    if (data == NULL)
+        return -ENODEV;
+    data->tx_hook = hook;
+    return 0;
+}
+
+// vim: set expandtab shiftwidth=4:
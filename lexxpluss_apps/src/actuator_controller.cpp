@@ -35,7 +35,20 @@
 #include <tuple>
 #include "actuator_controller.hpp"
 #include "adc_reader.hpp"
-#include "can_controller.hpp"
+#include "blackbox.hpp"
+#include "config.hpp"
+#include "diagnostics.hpp"
+#include "emergency.hpp"
+#include "microbench.hpp"
+#include "periodic.hpp"
+#include "position_control.hpp"
+#include "tcm.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
+
+#ifdef CONFIG_BOARD_NATIVE_POSIX
+#include "sim_hal.h"
+#endif
 
 extern "C" void HAL_TIM_Encoder_MspInit(TIM_HandleTypeDef *htim_encoder)
 {
@@ -130,6 +143,11 @@ public:
         tim->CNT = 0;
         return -count;
     }
+#ifdef CONFIG_LEXXHARD_BENCH
+    void attach(TIM_TypeDef *tim) {
+        this->tim = tim;
+    }
+#endif
 private:
     TIM_TypeDef *tim{nullptr};
     TIM_HandleTypeDef timh;
@@ -143,27 +161,35 @@ public:
         case POS::LEFT:
             result = enc.init(TIM3);
 #ifdef ENABLE_TUG
-            mm_per_pulse = 0.0033;
+            mm_per_pulse = {33, 10000};
 #else
-            mm_per_pulse = 50.0f / 1054.0f;
+            mm_per_pulse = {50, 1054};
 #endif  // ENABLE_TUG
             break;
         case POS::CENTER:
             result = enc.init(TIM4);
-            mm_per_pulse = 50.0f / 1054.0f;
+            mm_per_pulse = {50, 1054};
             break;
         case POS::RIGHT:
             result = enc.init(TIM1);
 #ifdef ENABLE_TUG
-            mm_per_pulse = 0.0033;
+            mm_per_pulse = {33, 10000};
 #else
-            mm_per_pulse = 50.0f / 1054.0f;
+            mm_per_pulse = {50, 1054};
 #endif  // ENABLE_TUG
             break;
         }
         reset_pulse();
         return result;
     }
+#ifdef CONFIG_LEXXHARD_BENCH
+    // Counts from a timer that is not configured by the HAL.
+    void attach(TIM_TypeDef *tim) {
+        enc.attach(tim);
+        mm_per_pulse = {50, 1054};
+        reset_pulse();
+    }
+#endif
     void reset() {
         reset_pulse();
         wait_stabilize();
@@ -171,10 +197,15 @@ public:
     }
     void poll(uint32_t dt_ms) {
         int16_t pulse{update_pulse()};
-        if (dt_ms != 0)
-            velocity = static_cast<float>(pulse) * mm_per_pulse * 1000.0f / static_cast<float>(dt_ms) + 0.5f;
+        if (dt_ms != 0) {
+            // mm/s rounded as the float version did: trunc(x + 0.5).
+            int64_t den{static_cast<int64_t>(mm_per_pulse.den) * dt_ms};
+            velocity = (static_cast<int64_t>(pulse) * mm_per_pulse.num * 2000 + den) / (den * 2);
+        }
+    }
+    int32_t get_location() const {
+        return static_cast<int64_t>(pulse_value) * mm_per_pulse.num / mm_per_pulse.den;
     }
-    int32_t get_location() const {return pulse_value * mm_per_pulse;}
     int32_t get_velocity() const {return velocity;}
     int32_t get_pulse() const {return pulse_value;}
     int32_t get_delta_pulse() {
@@ -200,7 +231,9 @@ private:
         return pulse;
     }
     encoder enc;
-    float mm_per_pulse{0.0f};
+    struct {
+        int32_t num, den;
+    } mm_per_pulse{0, 1};
     int32_t velocity{0}, pulse_value{0}, prev_pulse_value{0};
 };
 
@@ -229,20 +262,34 @@ public:
         }
         if (!device_is_ready(dev[0]) || !device_is_ready(dev[1]))
             return -1;
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        ready = true;
+        k_spin_unlock(&lock, key);
         set_duty(msg_control::STOP);
         return 0;
     }
     void set_duty(int8_t direction, uint8_t duty = 0) {
+        // The arbiter stops the outputs from its own thread, so the check and
+        // the write must not be split by it.
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        if (emergency::is_active())
+            direction = msg_control::STOP;
         uint32_t pulse_ns[2]{CONTROL_PERIOD_NS, CONTROL_PERIOD_NS};
         if (direction != msg_control::STOP && duty != 0) {
             uint32_t duty_rev{std::clamp(100U - duty, 0U, 100U)};
             uint32_t ns{duty_rev * CONTROL_PERIOD_NS / 100};
             pulse_ns[direction < msg_control::STOP ? 0 : 1] = ns;
         }
-        pwm_pin_set_nsec(dev[0], pin[0], CONTROL_PERIOD_NS, pulse_ns[0], PWM_POLARITY_NORMAL);
-        pwm_pin_set_nsec(dev[1], pin[1], CONTROL_PERIOD_NS, pulse_ns[1], PWM_POLARITY_NORMAL);
+        // The arbiter may stop the outputs before init() or after a failed
+        // binding.  The stop still holds: init() writes STOP, and no duty
+        // is written while the emergency is active.
+        if (ready) {
+            pwm_pin_set_nsec(dev[0], pin[0], CONTROL_PERIOD_NS, pulse_ns[0], PWM_POLARITY_NORMAL);
+            pwm_pin_set_nsec(dev[1], pin[1], CONTROL_PERIOD_NS, pulse_ns[1], PWM_POLARITY_NORMAL);
+        }
         this->direction = direction;
         this->duty = duty;
+        k_spin_unlock(&lock, key);
     }
     std::tuple<int8_t, uint8_t> get_duty() const {
         return {direction, duty};
@@ -252,69 +299,12 @@ private:
     int8_t direction{msg_control::STOP};
     uint8_t duty{0};
     const device *dev[2]{nullptr, nullptr};
+    bool ready{false};
+    static inline k_spinlock lock;
     static constexpr uint32_t CONTROL_HZ{10000};
     static constexpr uint32_t CONTROL_PERIOD_NS{1000000000ULL / CONTROL_HZ};
 };
 
-class position_control {
-public:
-    position_control(counter &cnt) : cnt(cnt) {}
-    std::tuple<bool, int8_t, float> poll(uint32_t dt_ms) {
-        if (!activated)
-            return {false, msg_control::STOP, 0.0f};
-        float control{0.0f};
-        int32_t diff_position{target_position - cnt.get_location()};
-        int8_t direction{diff_position < 0 ? msg_control::DOWN : msg_control::UP};
-        if (activated) {
-            float dt{dt_ms * 1e-3f};
-            int32_t target_velocity{static_cast<int32_t>(diff_position * POS_P)};
-            if (target_velocity < 0 && target_velocity > -vel_min)
-                target_velocity = -vel_min;
-            if (target_velocity > 0 && target_velocity < vel_min)
-                target_velocity = vel_min;
-            target_velocity = std::clamp(target_velocity, -vel_max, vel_max);
-            int32_t diff_velocity{target_velocity - cnt.get_velocity()};
-            float control_p{diff_velocity * VEL_P};
-            control_i += diff_velocity * dt * VEL_I;
-            control_p = std::clamp(control_p, -1.0f, 1.0f);
-            control_i = std::clamp(control_i, -1.0f, 1.0f);
-            control = control_p + control_i;
-            control = std::clamp(control, -1.0f, 1.0f);
-            control *= 0.3f;
-            control += direction == msg_control::UP ? 0.7f : -0.7f;
-        }
-        return {activated, direction, control};
-    }
-    void on(int32_t target_position, int32_t target_power) {
-        this->target_position = target_position;
-        this->vel_max = 20 * target_power / 100;
-        this->vel_min = 10 * target_power / 100;
-        activated = true;
-    }
-    void off() {
-        control_i = 0.0f;
-        target_position = 0;
-        vel_max = 20;
-        vel_min = 10;
-        activated = false;
-    }
-    bool is_near(int32_t thres_mm = 1) const {
-        int32_t diff_abs{abs(target_position - cnt.get_location())};
-        return diff_abs < thres_mm;
-    }
-    // void set_param(float pp, float vp, float vi) {
-    //     POS_P = pp;
-    //     VEL_P = vp;
-    //     VEL_I = vi;
-    // }
-private:
-    counter &cnt;
-    float control_i{0.0f};
-    int32_t target_position{0}, vel_max{20}, vel_min{10};
-    bool activated{false};
-    static constexpr float POS_P{1.0f}, VEL_P{0.0f}, VEL_I{0.13f};
-};
-
 class actuator {
 public:
     int init(POS pos) {
@@ -339,7 +329,7 @@ public:
             return -1;
         return 0;
     }
-    void poll() {
+    TCM_CODE void poll() {
         uint32_t now_cycle{k_cycle_get_32()}, dt_ms{0};
         if (prev_cycle != 0)
             dt_ms = k_cyc_to_ms_near32(now_cycle - prev_cycle);
@@ -365,6 +355,9 @@ public:
         posctl.off();
         pwm.set_duty(direction, duty);
     }
+    void stop_pwm() {
+        pwm.set_duty(msg_control::STOP);
+    }
     bool is_moving() {
         return cnt.get_delta_pulse() != 0;
     }
@@ -392,7 +385,7 @@ private:
     }
     counter cnt;
     pwm_driver pwm;
-    position_control posctl{cnt};
+    position_control<counter> posctl{cnt};
     uint32_t prev_cycle{0};
     int32_t current_adc{-1};
     class {
@@ -441,15 +434,20 @@ public:
                 static constexpr int fail_max{10};
                 if (fail_count < fail_max) {
                     LOG_WRN("fail of actuator detected, reset.");
+                    blackbox::trigger(blackbox::REASON_ACTUATOR_FAIL);
+                    diagnostics::report(diagnostics::ACTUATOR, diagnostics::WARN, diagnostics::CODE_FAULT);
                     reset_actuator();
                     ++fail_count;
                 } else if (fail_count == fail_max) {
                     LOG_WRN("continued fail of actuator detected.");
+                    diagnostics::report(diagnostics::ACTUATOR, diagnostics::ERROR, diagnostics::CODE_FAULT_PERSISTENT);
                     fail_count = fail_max + 1;
                 }
             } else {
-                if (fail_count > 0)
+                if (fail_count > 0) {
                     LOG_WRN("recovered from actuator fail.");
+                    diagnostics::report(diagnostics::ACTUATOR, diagnostics::OK, diagnostics::CODE_NONE);
+                }
                 fail_count = 0;
             }
         };
@@ -461,10 +459,14 @@ public:
         for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
             act[i].reset();
         uint32_t prev_cycle{k_cycle_get_32()};
+        watchdog_supervisor::declare(watchdog_supervisor::ACTUATOR_CONTROLLER, "actuator_controller", 200, true);
+        periodic::start(periodic::ACTUATOR_CONTROLLER);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::ACTUATOR_CONTROLLER);
+            TRACE_BEGIN(ACTUATOR_CONTROLLER);
             for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
                 act[i].poll();
-            bool is_emergency{can_controller::is_emergency()};
+            bool is_emergency{emergency::is_active()};
             msg_control ros2actuator;
             if (k_msgq_get(&msgq_control, &ros2actuator, K_NO_WAIT) == 0 && !is_emergency)
                 handle_control(ros2actuator);
@@ -478,6 +480,7 @@ public:
             if (dt_ms > 20) {
                 prev_cycle = now_cycle;
                 bool failed{false};
+                blackbox::actuator_sample sample;
                 for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
                     int8_t direction;
                     uint8_t duty;
@@ -488,7 +491,12 @@ public:
                              duty) = act[i].get_info();
                     if (actuator2ros.fail[i])
                         failed = true;
+                    sample.act[i].pulse = actuator2ros.encoder_count[i];
+                    sample.act[i].current_ma = actuator2ros.current[i];
+                    sample.act[i].direction = direction;
+                    sample.act[i].duty = duty;
                 }
+                blackbox::record(blackbox::ACTUATOR, &sample, sizeof sample);
                 fail_check(failed);
                 actuator2ros.connect = adc_reader::get(adc_reader::TROLLEY);
                 while (k_msgq_put(&msgq, &actuator2ros, K_NO_WAIT) != 0)
@@ -498,7 +506,8 @@ public:
                     heartbeat_led = !heartbeat_led;
                 }
             }
-            k_msleep(10);
+            TRACE_END(ACTUATOR_CONTROLLER);
+            periodic::wait(periodic::ACTUATOR_CONTROLLER);
         }
     }
     int init_location() {
@@ -507,7 +516,7 @@ public:
         pwm_trampoline_all(msg_control::DOWN, 100);
         bool stopped{wait_actuator_stop(30000, 100)};
         pwm_trampoline_all(msg_control::STOP);
-        if (!stopped || can_controller::is_emergency()) {
+        if (!stopped || emergency::is_active()) {
             LOG_WRN("can not initialize location.");
             return -1;
         }
@@ -528,7 +537,7 @@ public:
             act[i].to_location(location[i], power[i]);
         bool stopped{wait_actuator_stop(30000, 100)};
         pwm_trampoline_all(msg_control::STOP);
-        if (!stopped || can_controller::is_emergency()) {
+        if (!stopped || emergency::is_active()) {
             LOG_WRN("unable to move location.");
             return -1;
         }
@@ -536,6 +545,10 @@ public:
     }
     void set_current_monitor() const {
     }
+    void emergency_stop() {
+        for (uint32_t i{0}; i < ACTUATOR_NUM; ++i)
+            act[i].stop_pwm();
+    }
     void info(const shell *shell) const {
         for (uint32_t i{0}; i < ACTUATOR_NUM; ++i) {
             auto [pulse, current, fail, direction, duty]{act[i].get_info()};
@@ -601,6 +614,23 @@ private:
     bool location_initialized{false};
 } impl;
 
+#ifdef CONFIG_LEXXHARD_BENCH
+// counter::poll on a RAM stand-in for the timer, so the live encoders keep
+// their pulses.
+MICROBENCH(actuator_counter_poll)
+{
+    static TIM_TypeDef tim;
+    static counter cnt;
+    static bool attached{false};
+    if (!attached) {
+        cnt.attach(&tim);
+        attached = true;
+    }
+    tim.CNT = 37;
+    cnt.poll(10);
+}
+#endif
+
 int cmd_duty(const shell *shell, size_t argc, char **argv)
 {
     if (argc != 3 && argc != 5 && argc != 7) {
@@ -695,6 +725,11 @@ int to_location(const uint8_t (&location)[ACTUATOR_NUM], const uint8_t (&power)[
     return impl.to_location(location, power, detail);
 }
 
+void emergency_stop()
+{
+    impl.emergency_stop();
+}
+
 k_thread thread;
 k_msgq msgq, msgq_control;
 
@@ -48,6 +48,8 @@ void init();
 void run(void *p1, void *p2, void *p3);
 int init_location();
 int to_location(const uint8_t (&location)[3], const uint8_t (&power)[3], uint8_t (&detail)[3]);
+// Called by the emergency arbiter from its own thread.
+void emergency_stop();
 extern k_thread thread;
 extern k_msgq msgq, msgq_control;
 
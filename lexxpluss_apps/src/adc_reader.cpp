@@ -27,6 +27,12 @@
 #include <drivers/adc.h>
 #include <logging/log.h>
 #include "adc_reader.hpp"
+#include "diagnostics.hpp"
+#include "freshness.hpp"
+#include "periodic.hpp"
+#include "recorder.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::adc_reader {
 
@@ -39,11 +45,19 @@ public:
         return device_is_ready(dev) ? 0 : -1;
     }
     void run() {
-        if (!device_is_ready(dev))
+        if (!device_is_ready(dev)) {
+            diagnostics::report(diagnostics::ADC, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
+        watchdog_supervisor::declare(watchdog_supervisor::ADC_READER, "adc_reader", 200, false);
+        periodic::start(periodic::ADC_READER);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::ADC_READER);
+            TRACE_BEGIN(ADC_READER);
             read_all_channels();
-            k_msleep(20);
+            recorder::record(RECORDING_ADC, buffer, sizeof buffer);
+            TRACE_END(ADC_READER);
+            periodic::wait(periodic::ADC_READER);
         }
     }
     int32_t get(int index) const {
@@ -52,6 +66,12 @@ public:
             adc_raw_to_millivolts(ref, ADC_GAIN_1, 12, &value);
         return value;
     }
+    bool is_stale(int index) const {
+        return fresh.is_stale(index);
+    }
+    uint32_t get_stale_mask() const {
+        return fresh.stale_mask();
+    }
 private:
     void read_all_channels() {
         static constexpr uint8_t ch[NUM_CHANNELS]{8, 9, 10, 11, 12, 13};
@@ -74,11 +94,13 @@ private:
                 .oversampling{0},
                 .calibrate{0}
             };
-            adc_read(dev, &sequence);
+            if (adc_read(dev, &sequence) == 0)
+                fresh.update(i);
         }
     }
     const device *dev{nullptr};
     uint16_t buffer[NUM_CHANNELS];
+    freshness<NUM_CHANNELS> fresh{CONFIG_LEXXHARD_STALE_ADC_MS};
 } impl;
 
 void init()
@@ -96,6 +118,16 @@ int32_t get(int index)
     return impl.get(index);
 }
 
+bool is_stale(int index)
+{
+    return impl.is_stale(index);
+}
+
+uint32_t get_stale_mask()
+{
+    return impl.get_stale_mask();
+}
+
 k_thread thread;
 
 }
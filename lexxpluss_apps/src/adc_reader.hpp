@@ -32,6 +32,8 @@ namespace lexxhard::adc_reader {
 void init();
 void run(void *p1, void *p2, void *p3);
 int32_t get(int index);
+bool is_stale(int index);
+uint32_t get_stale_mask();
 extern k_thread thread;
 
 enum {
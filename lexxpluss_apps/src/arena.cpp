@@ -0,0 +1,291 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <sys/sys_heap.h>
+#include <algorithm>
+#include <new>
+#include "arena.hpp"
+
+namespace lexxhard::arena {
+
+LOG_MODULE_REGISTER(arena);
+
+// Backs every C++ operator new.  Allocations are expected during static
+// initialization and boot only; once sealed, any further one is reported.
+class arena_impl {
+public:
+    void *alloc(size_t size, size_t align, void *caller) {
+        align = std::max(align, sizeof (header));
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        if (!initialized) {
+            sys_heap_init(&heap, buffer, sizeof buffer);
+            initialized = true;
+        }
+        void *base{sys_heap_aligned_alloc(&heap, align, size + align)};
+        if (base == nullptr) {
+            ++failures;
+            k_spin_unlock(&lock, key);
+            LOG_ERR("out of arena, %u bytes from %p", size, caller);
+            return nullptr;
+        }
+        uint8_t *ptr{static_cast<uint8_t*>(base) + align};
+        header *h{reinterpret_cast<header*>(ptr) - 1};
+        h->size = size;
+        h->offset = align;
+        h->site = find_site(caller);
+        site &s{sites[h->site]};
+        ++s.count;
+        s.live += size;
+        s.peak = std::max(s.peak, s.live);
+        used += size;
+        peak = std::max(peak, used);
+        ++allocs;
+        bool late{sealed};
+        if (late)
+            ++after_seal;
+        k_spin_unlock(&lock, key);
+        if (late) {
+            LOG_ERR("allocation of %u bytes from %p after seal", size, caller);
+#ifdef CONFIG_LEXXHARD_ARENA_FAULT_AFTER_SEAL
+            k_panic();
+#endif
+        }
+        return ptr;
+    }
+    void free(void *ptr) {
+        if (ptr == nullptr)
+            return;
+        header *h{static_cast<header*>(ptr) - 1};
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        sites[h->site].live -= h->size;
+        used -= h->size;
+        ++frees;
+        sys_heap_free(&heap, static_cast<uint8_t*>(ptr) - h->offset);
+        k_spin_unlock(&lock, key);
+    }
+    void seal() {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        sealed = true;
+        k_spin_unlock(&lock, key);
+        LOG_INF("sealed, %u bytes in use, peak %u", used, peak);
+    }
+    bool is_sealed() const {
+        return sealed;
+    }
+    void get_stats(stats &s) {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        s.size = sizeof buffer;
+        s.used = used;
+        s.peak = peak;
+        s.allocs = allocs;
+        s.frees = frees;
+        s.failures = failures;
+        s.after_seal = after_seal;
+        k_spin_unlock(&lock, key);
+    }
+    void info(const shell *shell) {
+        stats s;
+        get_stats(s);
+        shell_print(shell, "size:%u used:%u peak:%u", s.size, s.used, s.peak);
+        shell_print(shell, "allocs:%u frees:%u failures:%u", s.allocs, s.frees, s.failures);
+        shell_print(shell, "sealed:%d after_seal:%u", sealed, s.after_seal);
+    }
+    void print_sites(const shell *shell) {
+        shell_print(shell, "%-10s %8s %8s %8s", "caller", "count", "live", "peak");
+        for (int i{0}; i < SITE_NUM + 1; ++i) {
+            k_spinlock_key_t key{k_spin_lock(&lock)};
+            site s{sites[i]};
+            k_spin_unlock(&lock, key);
+            if (s.count == 0)
+                continue;
+            if (i < SITE_NUM)
+                shell_print(shell, "%-10p %8u %8u %8u", s.caller, s.count, s.live, s.peak);
+            else
+                shell_print(shell, "%-10s %8u %8u %8u", "(other)", s.count, s.live, s.peak);
+        }
+    }
+private:
+    struct header {
+        uint32_t size;
+        uint16_t offset;
+        uint16_t site;
+    };
+    struct site {
+        void *caller;
+        uint32_t count;
+        size_t live, peak;
+    };
+    uint16_t find_site(void *caller) {
+        for (uint16_t i{0}; i < SITE_NUM; ++i) {
+            if (sites[i].caller == caller)
+                return i;
+            if (sites[i].caller == nullptr) {
+                sites[i].caller = caller;
+                return i;
+            }
+        }
+        return SITE_NUM;
+    }
+    static constexpr uint16_t SITE_NUM{16};
+    sys_heap heap{};
+    k_spinlock lock{};
+    site sites[SITE_NUM + 1]{};
+    size_t used{0}, peak{0};
+    uint32_t allocs{0}, frees{0}, failures{0}, after_seal{0};
+    bool initialized{false}, sealed{false};
+    uint8_t __aligned(8) buffer[CONFIG_LEXXHARD_ARENA_SIZE]{};
+};
+
+// Constant initialized, so it is usable before any static constructor runs.
+constinit arena_impl impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int sites(const shell *shell, size_t argc, char **argv)
+{
+    impl.print_sites(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "C++ arena usage", info),
+    SHELL_CMD(sites, NULL, "Allocations per caller", sites),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(arena, &sub, "C++ allocation arena commands", NULL);
+
+void *alloc(size_t size, size_t align, void *caller)
+{
+    return impl.alloc(size, align, caller);
+}
+
+void free(void *ptr)
+{
+    impl.free(ptr);
+}
+
+void seal()
+{
+    impl.seal();
+}
+
+bool is_sealed()
+{
+    return impl.is_sealed();
+}
+
+void get_stats(stats &s)
+{
+    impl.get_stats(s);
+}
+
+}
+
+// Without exceptions a failed allocation cannot be reported to the caller,
+// so the throwing forms stop here instead of returning a null pointer.
+#define ARENA_ALLOC(size, align) \
+    void *ptr{lexxhard::arena::alloc(size, align, __builtin_return_address(0))}; \
+    if (ptr == nullptr) \
+        k_oops(); \
+    return ptr;
+
+void *operator new(size_t size)
+{
+    ARENA_ALLOC(size, alignof (max_align_t));
+}
+
+void *operator new[](size_t size)
+{
+    ARENA_ALLOC(size, alignof (max_align_t));
+}
+
+void *operator new(size_t size, std::align_val_t align)
+{
+    ARENA_ALLOC(size, static_cast<size_t>(align));
+}
+
+void *operator new[](size_t size, std::align_val_t align)
+{
+    ARENA_ALLOC(size, static_cast<size_t>(align));
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return lexxhard::arena::alloc(size, alignof (max_align_t), __builtin_return_address(0));
+}
+
+void *operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return lexxhard::arena::alloc(size, alignof (max_align_t), __builtin_return_address(0));
+}
+
+void operator delete(void *ptr) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete[](void *ptr, std::align_val_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t) noexcept
+{
+    lexxhard::arena::free(ptr);
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <fs/fs.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <algorithm>
+#include <cstdio>
+#include "blackbox.hpp"
+
+namespace lexxhard::blackbox {
+
+LOG_MODULE_REGISTER(blackbox);
+
+class blackbox_impl {
+public:
+    void record(uint8_t type, const void *data, size_t len) {
+        uint32_t stamp_ms{k_uptime_get_32()};
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        if (!frozen) {
+            entry &e{ring[head]};
+            head = (head + 1) & MASK;
+            if (count < ENTRIES)
+                ++count;
+            e.stamp_ms = stamp_ms;
+            e.type = type;
+            e.len = std::min(len, sizeof e.data);
+            memcpy(e.data, data, e.len);
+            if (post_remaining > 0 && --post_remaining == 0)
+                frozen = true;
+        }
+        k_spin_unlock(&lock, key);
+    }
+    void trigger(uint8_t reason) {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        bool first{!frozen && post_remaining == 0};
+        if (first)
+            post_remaining = ENTRIES / 4;
+        k_spin_unlock(&lock, key);
+        if (first) {
+            record(TRIGGER, &reason, sizeof reason);
+            LOG_WRN("triggered by 0x%02x", reason);
+        }
+    }
+    void freeze() {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        frozen = true;
+        k_spin_unlock(&lock, key);
+    }
+    void rearm() {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        head = count = 0;
+        post_remaining = 0;
+        frozen = false;
+        k_spin_unlock(&lock, key);
+    }
+    bool is_frozen() const {
+        return frozen;
+    }
+    uint32_t get_count() const {
+        return count;
+    }
+    bool get_entry(uint32_t index, entry &e) const {
+        if (index >= count)
+            return false;
+        e = ring[(head - count + index) & MASK];
+        return true;
+    }
+    int save(const char *path) const {
+        fs_file_t file;
+        fs_file_t_init(&file);
+        fs_unlink(path);
+        if (int result{fs_open(&file, path, FS_O_WRITE | FS_O_CREATE)}; result != 0)
+            return result;
+        int result{0};
+        entry e;
+        for (uint32_t i{0}; get_entry(i, e); ++i) {
+            if (fs_write(&file, &e, sizeof e) != sizeof e) {
+                result = -EIO;
+                break;
+            }
+        }
+        fs_close(&file);
+        return result;
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "frozen:%d post:%u count:%u/%u",
+                    frozen, post_remaining, count, ENTRIES);
+    }
+private:
+    static constexpr uint32_t ENTRIES{CONFIG_LEXXHARD_BLACKBOX_ENTRIES}, MASK{ENTRIES - 1};
+    static_assert((ENTRIES & MASK) == 0, "entries must be a power of two");
+    entry ring[ENTRIES];
+    uint32_t head{0}, count{0}, post_remaining{0};
+    bool frozen{false};
+    mutable k_spinlock lock;
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int trigger(const shell *shell, size_t argc, char **argv)
+{
+    impl.trigger(REASON_MANUAL);
+    return 0;
+}
+
+int rearm(const shell *shell, size_t argc, char **argv)
+{
+    impl.rearm();
+    return 0;
+}
+
+int save(const shell *shell, size_t argc, char **argv)
+{
+    if (argc != 2) {
+        shell_error(shell, "Usage: %s %s <path>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    impl.freeze();
+    if (int result{impl.save(argv[1])}; result != 0) {
+        shell_error(shell, "failed to write %s (%d)", argv[1], result);
+        return 1;
+    }
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Recorder state", info),
+    SHELL_CMD(trigger, NULL, "Trigger a snapshot", trigger),
+    SHELL_CMD(rearm, NULL, "Discard the snapshot and record again", rearm),
+    SHELL_CMD(save, NULL, "Freeze and write the snapshot, e.g. /SD:/blackbox.bin", save),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(blackbox, &sub, "Black box recorder commands", NULL);
+
+void record(uint8_t type, const void *data, size_t len)
+{
+    impl.record(type, data, len);
+}
+
+void trigger(uint8_t reason)
+{
+    impl.trigger(reason);
+}
+
+void freeze()
+{
+    impl.freeze();
+}
+
+void rearm()
+{
+    impl.rearm();
+}
+
+bool is_frozen()
+{
+    return impl.is_frozen();
+}
+
+uint32_t get_count()
+{
+    return impl.get_count();
+}
+
+bool get_entry(uint32_t index, entry &e)
+{
+    return impl.get_entry(index, e);
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::blackbox {
+
+enum {
+    IMU = 1,
+    ACTUATOR,
+    CAN_BOARD,
+    CAN_BMU,
+    USS,
+    TOF,
+    PGV,
+    TRIGGER
+};
+
+// Trigger reasons below 0x80 are emergency::SOURCE values.
+enum {
+    REASON_ACTUATOR_FAIL = 0x80,
+    REASON_MANUAL
+};
+
+// Fixed size slot, little endian, dumped as is to ROS and SD.
+struct entry {
+    uint32_t stamp_ms;
+    uint8_t type, len;
+    uint8_t data[26];
+} __attribute__((packed));
+
+static_assert(sizeof (entry) == 32);
+
+struct imu_sample {
+    int16_t accel[3]; // 0.01 m/s^2
+    int16_t gyro[3];  // 0.1 deg/s
+} __attribute__((packed));
+
+struct actuator_sample {
+    struct {
+        int32_t pulse;
+        int16_t current_ma;
+        int8_t direction;
+        uint8_t duty;
+    } act[3];
+} __attribute__((packed));
+
+struct can_sample {
+    uint16_t id;
+    uint8_t dlc;
+    uint8_t data[8];
+} __attribute__((packed));
+
+struct uss_sample {
+    uint8_t index;
+    uint16_t distance_mm[2];
+} __attribute__((packed));
+
+struct tof_sample {
+    int16_t left_mv, right_mv;
+    uint8_t stale;
+} __attribute__((packed));
+
+struct pgv_sample {
+    uint32_t xp, tag;
+    int32_t xps;
+    int16_t yps;
+    uint16_t ang, wrn;
+    uint8_t lane, flags;
+} __attribute__((packed));
+
+// Cheap enough to call from every loop; does nothing once frozen.
+void record(uint8_t type, const void *data, size_t len);
+// Keeps recording for a quarter of the ring so the aftermath is kept, then freezes.
+void trigger(uint8_t reason);
+// Freezes at once, used before a dump of a ring that was not triggered.
+void freeze();
+void rearm();
+bool is_frozen();
+// Oldest first, only stable while frozen.
+uint32_t get_count();
+bool get_entry(uint32_t index, entry &e);
+
+}
+
+// vim: set expandtab shiftwidth=4:
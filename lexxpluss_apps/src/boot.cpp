@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include "boot.hpp"
+
+namespace lexxhard::boot {
+
+LOG_MODULE_REGISTER(boot);
+
+class boot_impl {
+public:
+    int init() {
+        k_mutex_init(&mutex);
+        k_condvar_init(&condvar);
+        main_ms = k_uptime_get_32();
+        return 0;
+    }
+    void run(const entry &e) {
+        stages[e.id].name = e.name;
+        e.init();
+        k_mutex_lock(&mutex, K_FOREVER);
+        stages[e.id].init_ms = k_uptime_get_32();
+        ready |= BIT(e.id);
+        k_condvar_broadcast(&condvar);
+        while ((ready & e.deps) != e.deps)
+            k_condvar_wait(&condvar, &mutex, K_FOREVER);
+        k_mutex_unlock(&mutex);
+        stages[e.id].loop_ms = k_uptime_get_32();
+        e.run(nullptr, nullptr, nullptr);
+    }
+    bool wait_ready(uint32_t mask, uint32_t timeout_ms) {
+        int64_t deadline{k_uptime_get() + timeout_ms};
+        k_mutex_lock(&mutex, K_FOREVER);
+        while ((ready & mask) != mask) {
+            int64_t remain{deadline - k_uptime_get()};
+            if (remain <= 0 || k_condvar_wait(&condvar, &mutex, K_MSEC(remain)) != 0)
+                break;
+        }
+        bool result{(ready & mask) == mask};
+        k_mutex_unlock(&mutex);
+        return result;
+    }
+    void mark_connected() {
+        if (connected_ms == 0) {
+            connected_ms = k_uptime_get_32();
+            LOG_INF("rosserial connected at %ums", connected_ms);
+        }
+    }
+    uint32_t get_connected_ms() const {
+        return connected_ms;
+    }
+    bool get_stage(int id, const char *&name, uint32_t &init_ms, uint32_t &loop_ms) const {
+        const stage &s{stages[id]};
+        if (s.name == nullptr)
+            return false;
+        name = s.name;
+        init_ms = s.init_ms;
+        loop_ms = s.loop_ms;
+        return true;
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "%-20s %8s %8s", "stage", "init", "loop");
+        shell_print(shell, "%-20s %8u %8s", "main", main_ms, "-");
+        for (const auto &s: stages) {
+            if (s.name != nullptr)
+                shell_print(shell, "%-20s %8u %8u", s.name, s.init_ms, s.loop_ms);
+        }
+        shell_print(shell, "%-20s %8s %8u", "rosserial connected", "-", connected_ms);
+    }
+private:
+    struct stage {
+        const char *name{nullptr};
+        uint32_t init_ms{0}, loop_ms{0};
+    } stages[STAGE_NUM];
+    k_mutex mutex;
+    k_condvar condvar;
+    uint32_t ready{0}, main_ms{0}, connected_ms{0};
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Boot timeline (ms since reset)", info),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(boot, &sub, "Boot commands", NULL);
+
+void init()
+{
+    impl.init();
+}
+
+void runner(void *p1, void *p2, void *p3)
+{
+    impl.run(*static_cast<const entry*>(p1));
+}
+
+bool wait_ready(uint32_t mask, uint32_t timeout_ms)
+{
+    return impl.wait_ready(mask, timeout_ms);
+}
+
+void mark_connected()
+{
+    impl.mark_connected();
+}
+
+uint32_t get_connected_ms()
+{
+    return impl.get_connected_ms();
+}
+
+bool get_stage(int id, const char *&name, uint32_t &init_ms, uint32_t &loop_ms)
+{
+    return impl.get_stage(id, name, init_ms, loop_ms);
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
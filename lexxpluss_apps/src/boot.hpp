@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::boot {
+
+enum {
+    ACTUATOR_CONTROLLER = 0,
+    ADC_READER,
+    CAN_CONTROLLER,
+    EMERGENCY,
+    EXECUTOR,
+    FIRMWARE_UPDATER,
+    IMU_CONTROLLER,
+    LED_CONTROLLER,
+    PGV_CONTROLLER,
+    ROSSERIAL,
+    ROSSERIAL_SERVICE,
+    RUNAWAY_DETECTOR,
+    SDLOG_CONTROLLER,
+    THREAD_MONITOR,
+    WATCHDOG_SUPERVISOR,
+    STAGE_NUM
+};
+
+struct entry {
+    int id;
+    const char *name;
+    void (*init)();
+    k_thread_entry_t run;
+    uint32_t deps;
+};
+
+void init();
+void runner(void *p1, void *p2, void *p3);
+bool wait_ready(uint32_t mask, uint32_t timeout_ms);
+void mark_connected();
+uint32_t get_connected_ms();
+bool get_stage(int id, const char *&name, uint32_t &init_ms, uint32_t &loop_ms);
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -29,10 +29,23 @@
 #include <drivers/gpio.h>
 #include <logging/log.h>
 #include <shell/shell.h>
+#include <sys/atomic.h>
 #include "interlock_controller.hpp"
 #include "led_controller.hpp"
 #include "misc_controller.hpp"
 #include "can_controller.hpp"
+#include "blackbox.hpp"
+#include "can_load.hpp"
+#include "config.hpp"
+#include "diagnostics.hpp"
+#include "emergency.hpp"
+#include "freshness.hpp"
+#include "isr_timing.hpp"
+#include "latency.hpp"
+#include "recorder.hpp"
+#include "tcm.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 
 #define QUOTE(name) #name
@@ -58,9 +71,20 @@ char __aligned(4) msgq_bmu_buffer[8 * sizeof (msg_bmu)];
 char __aligned(4) msgq_board_buffer[8 * sizeof (msg_board)];
 char __aligned(4) msgq_control_buffer[8 * sizeof (msg_control)];
 
-CAN_DEFINE_MSGQ(msgq_can_bmu, 16);
-CAN_DEFINE_MSGQ(msgq_can_board, 4);
-CAN_DEFINE_MSGQ(msgq_can_log, 8);
+struct stamped_frame {
+    zcan_frame frame;
+    uint32_t cycle;
+} __attribute__((aligned(4)));
+
+char __aligned(4) msgq_can_bmu_buffer[16 * sizeof (stamped_frame)];
+char __aligned(4) msgq_can_board_buffer[4 * sizeof (stamped_frame)];
+char __aligned(4) msgq_can_log_buffer[8 * sizeof (stamped_frame)];
+k_msgq msgq_can_bmu, msgq_can_board, msgq_can_log;
+
+struct rx_queue {
+    k_msgq *msgq;
+    uint32_t received, dropped, high_water;
+};
 
 class log_printer {
 public:
@@ -84,38 +108,63 @@ public:
         k_msgq_init(&msgq_bmu, msgq_bmu_buffer, sizeof (msg_bmu), 8);
         k_msgq_init(&msgq_board, msgq_board_buffer, sizeof (msg_board), 8);
         k_msgq_init(&msgq_control, msgq_control_buffer, sizeof (msg_control), 8);
+        k_msgq_init(&msgq_can_bmu, msgq_can_bmu_buffer, sizeof (stamped_frame), 16);
+        k_msgq_init(&msgq_can_board, msgq_can_board_buffer, sizeof (stamped_frame), 4);
+        k_msgq_init(&msgq_can_log, msgq_can_log_buffer, sizeof (stamped_frame), 8);
         dev = device_get_binding("CAN_2");
         if (!device_is_ready(dev))
             return -1;
+#ifdef CONFIG_CAN_LOOPBACK
+        // The simulated board has no bus, the power board emulator talks
+        // through the loopback driver.
+        can_configure(dev, CAN_LOOPBACK_MODE, 500000);
+#else
         can_configure(dev, CAN_NORMAL_MODE, 500000);
+#endif
+        atomic_set(&ready, 1);
         return 0;
     }
     void run() {
-        if (!device_is_ready(dev))
+        if (!device_is_ready(dev)) {
+            diagnostics::report(diagnostics::CAN, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
         const device *gpiog{device_get_binding("GPIOG")};
         if (device_is_ready(gpiog))
             gpio_pin_configure(gpiog, 6, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
         setup_can_filter();
         int heartbeat_led{1};
+        watchdog_supervisor::declare(watchdog_supervisor::CAN_CONTROLLER, "can_controller", 300, true);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::CAN_CONTROLLER);
+            TRACE_BEGIN(CAN_CONTROLLER);
             bool handled{false};
-            zcan_frame frame;
-            if (k_msgq_get(&msgq_can_bmu, &frame, K_NO_WAIT) == 0) {
-                if (handler_bmu(frame)) {
+            if (stamped_frame stamped; k_msgq_get(&msgq_can_bmu, &stamped, K_NO_WAIT) == 0) {
+                fresh_bmu.update(0);
+                record_blackbox(blackbox::CAN_BMU, stamped.frame);
+                if (handler_bmu(stamped.frame)) {
                     while (k_msgq_put(&msgq_bmu, &bmu2ros, K_NO_WAIT) != 0)
                         k_msgq_purge(&msgq_bmu);
                 }
+                can_load::handled(stamped.frame.id, stamped.cycle);
                 handled = true;
             }
-            if (k_msgq_get(&msgq_can_board, &frame, K_NO_WAIT) == 0) {
-                handler_board(frame);
+            if (stamped_frame stamped; k_msgq_get(&msgq_can_board, &stamped, K_NO_WAIT) == 0) {
+                latency::record(latency::PATH_BOARD, latency::HOP_RX_QUEUE, stamped.cycle);
+                record_blackbox(blackbox::CAN_BOARD, stamped.frame);
+                handler_board(stamped.frame);
+                board2ros.stamp_cycle = stamped.cycle;
+                latency::record(latency::PATH_BOARD, latency::HOP_HANDLER, stamped.cycle);
                 while (k_msgq_put(&msgq_board, &board2ros, K_NO_WAIT) != 0)
                     k_msgq_purge(&msgq_board);
+                latency::record(latency::PATH_BOARD, latency::HOP_QUEUE, stamped.cycle);
+                can_load::handled(stamped.frame.id, stamped.cycle);
                 handled = true;
             }
-            if (k_msgq_get(&msgq_can_log, &frame, K_NO_WAIT) == 0)
-                handler_log(frame);
+            if (stamped_frame stamped; k_msgq_get(&msgq_can_log, &stamped, K_NO_WAIT) == 0) {
+                handler_log(stamped.frame);
+                can_load::handled(stamped.frame.id, stamped.cycle);
+            }
             if (k_msgq_get(&msgq_control, &ros2board, K_NO_WAIT) == 0) {
                 prev_cycle_ros = k_cycle_get_32();
                 handled = true;
@@ -127,17 +176,24 @@ public:
             uint32_t now_cycle{k_cycle_get_32()};
             if (prev_cycle_ros != 0) {
                 uint32_t dt_ms{k_cyc_to_ms_near32(now_cycle - prev_cycle_ros)};
-                heartbeat_timeout = dt_ms > 3000;
+                bool timeout{dt_ms > static_cast<uint32_t>(config::get_int(config::CAN_HEARTBEAT_TIMEOUT_MS))};
+                if (heartbeat_timeout != timeout) {
+                    diagnostics::report(diagnostics::CAN,
+                                        timeout ? diagnostics::WARN : diagnostics::OK,
+                                        timeout ? diagnostics::CODE_HEARTBEAT_TIMEOUT : diagnostics::CODE_NONE);
+                    heartbeat_timeout = timeout;
+                }
             }
             uint32_t dt_ms{k_cyc_to_ms_near32(now_cycle - prev_cycle_send)};
             if (dt_ms > 100) {
                 prev_cycle_send = now_cycle;
-                send_message();
+                send_message(K_MSEC(100));
                 if (device_is_ready(gpiog)) {
                     gpio_pin_set(gpiog, 6, heartbeat_led);
                     heartbeat_led = !heartbeat_led;
                 }
             }
+            TRACE_END(CAN_CONTROLLER);
             if (!handled)
                 k_msleep(1);
         }
@@ -153,67 +209,50 @@ public:
 	return board2ros.bumper_switch[0] ||
 	       board2ros.bumper_switch[1];
     }
-    bool is_emergency() const {
-        return board2ros.emergency_switch[0] ||
-               board2ros.emergency_switch[1] ||
-               board2ros.bumper_switch[0] ||
-               board2ros.bumper_switch[1] ||
-               ros2board.emergency_stop;
+    uint32_t get_stale_mask() const {
+        return (fresh_board.stale_mask() << STALE_BOARD) |
+               (fresh_bmu.stale_mask() << STALE_BMU);
     }
     void bmu_info(const shell *shell) const {
-        shell_print(shell,
-                    "MOD:0x%02x/%02x BMU:0x%02x\n"
-                    "ASOC:%u RSOC:%u SOH:%u\n"
-                    "FET:%d Current:%d ChargeCurrent:%u\n"
-                    "Voltage:%u Capacity(design):%u Capacity(full):%u Capacity(remain):%u\n"
-                    "Max Voltage:%u/%u Min Voltage:%u/%u\n"
-                    "Max Temp:%d/%u Min Temp:%d/%u\n"
-                    "Max Current:%d/%u Min Current:%d/%u\n"
-                    "BMUFW:0x%02x MODFW:0x%02x SER:0x%02x PAR:0x%02x\n"
-                    "ALM1:0x%02x ALM2:0x%02x\n"
-                    "Max Cell Voltage:%u/%u Min Cell Voltage:%u/%u\n"
-                    "Manufacture:%u Inspection:%u Serial:%u\n",
-                    bmu2ros.mod_status1, bmu2ros.mod_status2, bmu2ros.bmu_status,
-                    bmu2ros.asoc, bmu2ros.rsoc, bmu2ros.soh,
-                    bmu2ros.fet_temp, bmu2ros.pack_current, bmu2ros.charging_current,
-                    bmu2ros.pack_voltage, bmu2ros.design_capacity, bmu2ros.full_charge_capacity, bmu2ros.remain_capacity,
-                    bmu2ros.max_voltage.value, bmu2ros.max_voltage.id, bmu2ros.min_voltage.value, bmu2ros.min_voltage.id,
-                    bmu2ros.max_temp.value, bmu2ros.max_temp.id, bmu2ros.min_temp.value, bmu2ros.min_temp.id,
-                    bmu2ros.max_current.value, bmu2ros.max_current.id, bmu2ros.min_current.value, bmu2ros.min_current.id,
-                    bmu2ros.bmu_fw_ver, bmu2ros.mod_fw_ver, bmu2ros.serial_config, bmu2ros.parallel_config,
-                    bmu2ros.bmu_alarm1, bmu2ros.bmu_alarm2,
-                    bmu2ros.max_cell_voltage.value, bmu2ros.max_cell_voltage.id, bmu2ros.min_cell_voltage.value, bmu2ros.min_cell_voltage.id,
-                    bmu2ros.manufacturing, bmu2ros.inspection, bmu2ros.serial);
+        bmu_layout.print(bmu2ros, [shell](const char *line) {shell_print(shell, "%s", line);});
+        shell_print(shell, "Age:%ums Stale:%d", fresh_bmu.age_ms(0), fresh_bmu.is_stale(0));
+    }
+    void send_emergency() const {
+        // The arbiter starts before init() and may call this before the
+        // device is bound, or after binding failed.  Never wait for a
+        // mailbox either, the periodic frame repeats the request anyway.
+        if (atomic_get(&ready))
+            send_message(K_NO_WAIT);
     }
     void brd_emgoff() {
         ros2board.emergency_stop = false;
+        emergency::set(emergency::ROS, false);
         heartbeat_timeout = false;
     }
     void brd_info(const shell *shell) const {
+        board_layout.print(board2ros, [shell](const char *line) {shell_print(shell, "%s", line);});
         shell_print(shell,
-                    "Bumper:%d/%d Emergency:%d/%d Power:%d\n"
-                    "Shutdown:%d Reason:%d AutoCharge:%d ManualCharge:%d\n"
-                    "CFET:%d DFET:%d PDSG:%d\n"
-                    "5VFAIL:%d 16VFAIL:%d\n"
-                    "STATE:%u WHEEL:%d/%d\n"
-                    "FAN:%u\n"
-                    "ConnTemp:%d/%d PBTemp:%d\n"
                     "MBTemp:%f ActTemp:%f/%f/%f\n"
-                    "Charge Connector Voltage:%f Count:%u Delay:%u TempError:%d\n"
-                    "Version:%s PowerBoard Version:%s\n",
-                    board2ros.bumper_switch[0], board2ros.bumper_switch[1], board2ros.emergency_switch[0], board2ros.emergency_switch[1], board2ros.power_switch,
-                    board2ros.wait_shutdown, board2ros.shutdown_reason, board2ros.auto_charging, board2ros.manual_charging,
-                    board2ros.c_fet, board2ros.d_fet, board2ros.p_dsg,
-                    board2ros.v5_fail, board2ros.v16_fail,
-                    board2ros.state, board2ros.wheel_disable[0], board2ros.wheel_disable[1],
-                    board2ros.fan_duty,
-                    board2ros.charge_connector_temp[0], board2ros.charge_connector_temp[1], board2ros.power_board_temp,
+                    "Version:%s PowerBoard Version:%s\n"
+                    "Age:%ums Stale:%d RxDrop:%u\n",
                     board2ros.main_board_temp, board2ros.actuator_board_temp[0], board2ros.actuator_board_temp[1], board2ros.actuator_board_temp[2],
-                    board2ros.charge_connector_voltage, board2ros.charge_check_count, board2ros.charge_heartbeat_delay, board2ros.charge_temperature_error,
-                    version, version_powerboard);
+                    version, version_powerboard,
+                    fresh_board.age_ms(0), fresh_board.is_stale(0), rxq[RX_BOARD].dropped);
+    }
+    void get_rx_stats(rx_stats (&stats)[RX_QUEUE_NUM]) const {
+        for (uint32_t i{0}; i < RX_QUEUE_NUM; ++i) {
+            stats[i].received = rxq[i].received;
+            stats[i].dropped = rxq[i].dropped;
+            stats[i].high_water = rxq[i].high_water;
+            stats[i].size = rxq[i].msgq->max_msgs;
+        }
+    }
+    void reset_rx_stats() {
+        for (auto &i: rxq)
+            i.received = i.dropped = i.high_water = 0;
     }
 private:
-    void setup_can_filter() const {
+    void setup_can_filter() {
         static const zcan_filter filter_bmu{
             .id{0x100},
             .rtr{CAN_DATAFRAME},
@@ -235,91 +274,66 @@ private:
             .id_mask{CAN_STD_ID_MASK},
             .rtr_mask{1}
         };
-        can_attach_msgq(dev, &msgq_can_bmu, &filter_bmu);
-        can_attach_msgq(dev, &msgq_can_board, &filter_board);
-        can_attach_msgq(dev, &msgq_can_log, &filter_log);
+        can_attach_isr(dev, rx_frame, &rxq[RX_BMU], &filter_bmu);
+        can_attach_isr(dev, rx_board, &rxq[RX_BOARD], &filter_board);
+        can_attach_isr(dev, rx_frame, &rxq[RX_LOG], &filter_log);
     }
-    bool handler_bmu(zcan_frame &frame) {
-        bool result{false};
-        if (frame.id == 0x100) {
-            bmu2ros.mod_status1 = frame.data[0];
-            bmu2ros.bmu_status = frame.data[1];
-            bmu2ros.asoc = frame.data[2];
-            bmu2ros.rsoc = frame.data[3];
-            bmu2ros.soh = frame.data[4];
-            bmu2ros.fet_temp = (frame.data[5] << 8) | frame.data[6];
-        } else if (frame.id == 0x101) {
-            bmu2ros.pack_current = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.charging_current = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.pack_voltage = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.mod_status2 = frame.data[6];
-        } else if (frame.id == 0x103) {
-            bmu2ros.design_capacity = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.full_charge_capacity = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.remain_capacity = (frame.data[4] << 8) | frame.data[5];
-        } else if (frame.id == 0x110) {
-            bmu2ros.max_voltage.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_voltage.id = frame.data[2];
-            bmu2ros.min_voltage.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_voltage.id = frame.data[6];
-        } else if (frame.id == 0x111) {
-            bmu2ros.max_temp.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_temp.id = frame.data[2];
-            bmu2ros.min_temp.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_temp.id = frame.data[6];
-        } else if (frame.id == 0x112) {
-            bmu2ros.max_current.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.max_current.id = frame.data[2];
-            bmu2ros.min_current.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.min_current.id = frame.data[6];
-        } else if (frame.id == 0x113) {
-            bmu2ros.bmu_fw_ver = frame.data[0];
-            bmu2ros.mod_fw_ver = frame.data[1];
-            bmu2ros.serial_config = frame.data[2];
-            bmu2ros.parallel_config = frame.data[3];
-            bmu2ros.bmu_alarm1 = frame.data[4];
-            bmu2ros.bmu_alarm2 = frame.data[5];
-        } else if (frame.id == 0x120) {
-            bmu2ros.min_cell_voltage.value = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.min_cell_voltage.id = frame.data[2];
-            bmu2ros.max_cell_voltage.value = (frame.data[4] << 8) | frame.data[5];
-            bmu2ros.max_cell_voltage.id = frame.data[6];
-        } else if (frame.id == 0x130) {
-            bmu2ros.manufacturing = (frame.data[0] << 8) | frame.data[1];
-            bmu2ros.inspection = (frame.data[2] << 8) | frame.data[3];
-            bmu2ros.serial = (frame.data[4] << 8) | frame.data[5];
-            result = true;
+    TCM_CODE static void rx_put(rx_queue &q, const zcan_frame *frame) {
+        record_input(*frame);
+        // Stamp in the ISR so the latency includes the RX queue wait.
+        stamped_frame stamped{*frame, k_cycle_get_32()};
+        if (k_msgq_put(q.msgq, &stamped, K_NO_WAIT) != 0) {
+            ++q.dropped;
+            return;
+        }
+        ++q.received;
+        if (uint32_t used{k_msgq_num_used_get(q.msgq)}; used > q.high_water)
+            q.high_water = used;
+    }
+    TCM_CODE static void record_input(const zcan_frame &frame) {
+#ifdef CONFIG_LEXXHARD_RECORDER
+        uint8_t payload[3 + sizeof frame.data]{
+            static_cast<uint8_t>(frame.id), static_cast<uint8_t>(frame.id >> 8), frame.dlc
+        };
+        memcpy(&payload[3], frame.data, frame.dlc);
+        recorder::record(RECORDING_CAN, payload, 3 + frame.dlc);
+#endif
+    }
+    TCM_CODE static void rx_frame(zcan_frame *frame, void *arg) {
+        uint32_t begin_cycle{isr_timing::begin()};
+        rx_put(*static_cast<rx_queue*>(arg), frame);
+        isr_timing::end(isr_timing::CAN_RX, begin_cycle);
+    }
+    TCM_CODE static void rx_board(zcan_frame *frame, void *arg) {
+        uint32_t begin_cycle{isr_timing::begin()};
+        if (frame->id == 0x200) {
+            // Hand the switches to the arbiter here, not after the RX queue.
+            emergency::set(emergency::CAN_EMERGENCY_SWITCH, (frame->data[0] & 0b00000110) != 0);
+            emergency::set(emergency::CAN_BUMPER, (frame->data[0] & 0b00011000) != 0);
         }
-        return result;
+        rx_put(*static_cast<rx_queue*>(arg), frame);
+        isr_timing::end(isr_timing::CAN_RX, begin_cycle);
+    }
+    static void record_blackbox(uint8_t type, const zcan_frame &frame) {
+        blackbox::can_sample sample{static_cast<uint16_t>(frame.id), frame.dlc};
+        memcpy(sample.data, frame.data, sizeof sample.data);
+        blackbox::record(type, &sample, sizeof sample);
+    }
+    bool handler_bmu(zcan_frame &frame) {
+        return decode_bmu(frame.id, frame.data, bmu2ros);
     }
     void handler_board(zcan_frame &frame) {
+        uint8_t prev_state{board2ros.state};
+        bool prev_wait_shutdown{board2ros.wait_shutdown};
+        decode_board(frame.id, frame.data, board2ros);
         if (frame.id == 0x200) {
-            uint8_t prev_state{board2ros.state};
-            bool prev_wait_shutdown{board2ros.wait_shutdown};
-            board2ros.bumper_switch[0] = (frame.data[0] & 0b00001000) != 0;
-            board2ros.bumper_switch[1] = (frame.data[0] & 0b00010000) != 0;
-            board2ros.emergency_switch[0] = (frame.data[0] & 0b00000010) != 0;
-            board2ros.emergency_switch[1] = (frame.data[0] & 0b00000100) != 0;
-            board2ros.power_switch = (frame.data[0] & 0b00000001) != 0;
-            board2ros.wait_shutdown = (frame.data[1] & 0b10000000) != 0;
-            board2ros.auto_charging = (frame.data[1] & 0b00000010) != 0;
-            board2ros.shutdown_reason = (frame.data[1] & 0b01111100) >> 2;
-            board2ros.manual_charging = (frame.data[1] & 0b00000001) != 0;
-            board2ros.c_fet = (frame.data[2] & 0b00010000) != 0;
-            board2ros.d_fet = (frame.data[2] & 0b00100000) != 0;
-            board2ros.p_dsg = (frame.data[2] & 0b01000000) != 0;
-            board2ros.v5_fail = (frame.data[2] & 0b00000001) != 0;
-            board2ros.v16_fail = (frame.data[2] & 0b00000010) != 0;
-            board2ros.wheel_disable[0] = (frame.data[3] & 0b00000001) != 0;
-            board2ros.wheel_disable[1] = (frame.data[3] & 0b00000010) != 0;
-            board2ros.state = (frame.data[3] & 0b11111100) >> 2;
-            board2ros.fan_duty = frame.data[4];
-            board2ros.charge_connector_temp[0] = frame.data[5];
-            board2ros.charge_connector_temp[1] = frame.data[6];
-            board2ros.power_board_temp = frame.data[7];
+            fresh_board.update(0);
             board2ros.main_board_temp = misc_controller::get_main_board_temp();
-            for (auto i{0}; i < 3; ++i)
+            board2ros.main_board_temp_stale = misc_controller::is_main_board_temp_stale();
+            for (auto i{0}; i < 3; ++i) {
                 board2ros.actuator_board_temp[i] = misc_controller::get_actuator_board_temp(i);
+                board2ros.actuator_board_temp_stale[i] = misc_controller::is_actuator_board_temp_stale(i);
+            }
             static constexpr uint8_t LOCKDOWN_STATE{7};
             if (prev_state != LOCKDOWN_STATE && board2ros.state == LOCKDOWN_STATE) {
                 led_controller::msg message{led_controller::msg::LOCKDOWN, 1000000000};
@@ -346,12 +360,6 @@ private:
                 version_powerboard[n++] = '.';
             }
             version_powerboard[frame.dlc] = '\0';
-        } else if (frame.id == 0x204) {
-            uint16_t voltage_mv{static_cast<uint16_t>(frame.data[0] | (frame.data[1] << 8))};
-            board2ros.charge_connector_voltage = voltage_mv * 1e-3f;
-            board2ros.charge_check_count = frame.data[2];
-            board2ros.charge_heartbeat_delay = frame.data[3];
-            board2ros.charge_temperature_error = frame.data[4];
         }
     }
     void handler_log(zcan_frame &frame) {
@@ -362,11 +370,12 @@ private:
             log.putc(data);
         }
     }
-    void send_message() const {
-        bool main_overheat{board2ros.main_board_temp > 75.0f};
+    void send_message(k_timeout_t timeout) const {
+        float overheat{config::get_float(config::CAN_OVERHEAT_DEG)};
+        bool main_overheat{board2ros.main_board_temp > overheat};
         bool actuator_overheat{false};
         for (const auto &i: board2ros.actuator_board_temp) {
-            if (i > 75.0f)
+            if (i > overheat)
                 actuator_overheat = true;
         }
         zcan_frame frame{
@@ -375,7 +384,7 @@ private:
             .id_type{CAN_STANDARD_IDENTIFIER},
             .dlc{6},
             .data{
-                ros2board.emergency_stop,
+                ros2board.emergency_stop || emergency::is_active(),
                 ros2board.power_off,
                 !get_emergency_switch() && heartbeat_timeout,
                 main_overheat,
@@ -383,14 +392,18 @@ private:
                 ros2board.wheel_power_off
             }
         };
-        can_send(dev, &frame, K_MSEC(100), nullptr, nullptr);
+        can_send(dev, &frame, timeout, nullptr, nullptr);
     }
     msg_bmu bmu2ros{0};
     msg_board board2ros{0};
     msg_control ros2board{true, false};
     log_printer log;
+    freshness<1> fresh_board{CONFIG_LEXXHARD_STALE_CAN_BOARD_MS};
+    freshness<1> fresh_bmu{CONFIG_LEXXHARD_STALE_CAN_BMU_MS};
     uint32_t prev_cycle_ros{0}, prev_cycle_send{0};
+    rx_queue rxq[RX_QUEUE_NUM]{{&msgq_can_bmu}, {&msgq_can_board}, {&msgq_can_log}};
     const device *dev{nullptr};
+    atomic_t ready{ATOMIC_INIT(0)};
     char version_powerboard[32]{""};
     bool heartbeat_timeout{true};
 
@@ -455,9 +468,24 @@ bool get_bumper_switch()
     return impl.get_bumper_switch();
 }
 
-bool is_emergency()
+void send_emergency()
+{
+    impl.send_emergency();
+}
+
+uint32_t get_stale_mask()
+{
+    return impl.get_stale_mask();
+}
+
+void get_rx_stats(rx_stats (&stats)[RX_QUEUE_NUM])
+{
+    impl.get_rx_stats(stats);
+}
+
+void reset_rx_stats()
 {
-    return impl.is_emergency();
+    impl.reset_rx_stats();
 }
 
 k_thread thread;
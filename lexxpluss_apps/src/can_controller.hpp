@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include "can_frame_layout.hpp"
 
 namespace lexxhard::can_controller {
 
@@ -55,8 +56,125 @@ struct msg_board {
     bool c_fet, d_fet, p_dsg, v5_fail, v16_fail;
     bool wheel_disable[2];
     bool charge_temperature_error;
+    bool main_board_temp_stale, actuator_board_temp_stale[3];
+    uint32_t stamp_cycle;
 } __attribute__((aligned(4)));
 
+#define BMU_FIELD(ID, OFFSET, WIDTH, MEMBER, HEX) \
+    CAN_FIELD_LAYOUT(msg_bmu, ID, OFFSET, WIDTH, BIG, MEMBER, 1.0f, HEX)
+#define BOARD_FIELD(ID, OFFSET, WIDTH, MEMBER) \
+    CAN_FIELD_LAYOUT(msg_board, ID, OFFSET, WIDTH, LITTLE, MEMBER, 1.0f, false)
+
+// BMU frames, big endian.
+inline constexpr field_layout bmu_fields[]{
+    BMU_FIELD(0x100,  0,  8, mod_status1, true),
+    BMU_FIELD(0x100,  8,  8, bmu_status, true),
+    BMU_FIELD(0x100, 16,  8, asoc, false),
+    BMU_FIELD(0x100, 24,  8, rsoc, false),
+    BMU_FIELD(0x100, 32,  8, soh, false),
+    BMU_FIELD(0x100, 40, 16, fet_temp, false),
+    BMU_FIELD(0x101,  0, 16, pack_current, false),
+    BMU_FIELD(0x101, 16, 16, charging_current, false),
+    BMU_FIELD(0x101, 32, 16, pack_voltage, false),
+    BMU_FIELD(0x101, 48,  8, mod_status2, true),
+    BMU_FIELD(0x103,  0, 16, design_capacity, false),
+    BMU_FIELD(0x103, 16, 16, full_charge_capacity, false),
+    BMU_FIELD(0x103, 32, 16, remain_capacity, false),
+    BMU_FIELD(0x110,  0, 16, max_voltage.value, false),
+    BMU_FIELD(0x110, 16,  8, max_voltage.id, false),
+    BMU_FIELD(0x110, 32, 16, min_voltage.value, false),
+    BMU_FIELD(0x110, 48,  8, min_voltage.id, false),
+    BMU_FIELD(0x111,  0, 16, max_temp.value, false),
+    BMU_FIELD(0x111, 16,  8, max_temp.id, false),
+    BMU_FIELD(0x111, 32, 16, min_temp.value, false),
+    BMU_FIELD(0x111, 48,  8, min_temp.id, false),
+    BMU_FIELD(0x112,  0, 16, max_current.value, false),
+    BMU_FIELD(0x112, 16,  8, max_current.id, false),
+    BMU_FIELD(0x112, 32, 16, min_current.value, false),
+    BMU_FIELD(0x112, 48,  8, min_current.id, false),
+    BMU_FIELD(0x113,  0,  8, bmu_fw_ver, true),
+    BMU_FIELD(0x113,  8,  8, mod_fw_ver, true),
+    BMU_FIELD(0x113, 16,  8, serial_config, true),
+    BMU_FIELD(0x113, 24,  8, parallel_config, true),
+    BMU_FIELD(0x113, 32,  8, bmu_alarm1, true),
+    BMU_FIELD(0x113, 40,  8, bmu_alarm2, true),
+    BMU_FIELD(0x120,  0, 16, min_cell_voltage.value, false),
+    BMU_FIELD(0x120, 16,  8, min_cell_voltage.id, false),
+    BMU_FIELD(0x120, 32, 16, max_cell_voltage.value, false),
+    BMU_FIELD(0x120, 48,  8, max_cell_voltage.id, false),
+    BMU_FIELD(0x130,  0, 16, manufacturing, false),
+    BMU_FIELD(0x130, 16, 16, inspection, false),
+    BMU_FIELD(0x130, 32, 16, serial, false),
+};
+
+// Power board frames, little endian.  0x202 and 0x203 carry no fields,
+// the controller acts on them.
+inline constexpr field_layout board_fields[]{
+    BOARD_FIELD(0x200,  0, 1, power_switch),
+    BOARD_FIELD(0x200,  1, 1, emergency_switch[0]),
+    BOARD_FIELD(0x200,  2, 1, emergency_switch[1]),
+    BOARD_FIELD(0x200,  3, 1, bumper_switch[0]),
+    BOARD_FIELD(0x200,  4, 1, bumper_switch[1]),
+    BOARD_FIELD(0x200,  8, 1, manual_charging),
+    BOARD_FIELD(0x200,  9, 1, auto_charging),
+    BOARD_FIELD(0x200, 10, 5, shutdown_reason),
+    BOARD_FIELD(0x200, 15, 1, wait_shutdown),
+    BOARD_FIELD(0x200, 16, 1, v5_fail),
+    BOARD_FIELD(0x200, 17, 1, v16_fail),
+    BOARD_FIELD(0x200, 20, 1, c_fet),
+    BOARD_FIELD(0x200, 21, 1, d_fet),
+    BOARD_FIELD(0x200, 22, 1, p_dsg),
+    BOARD_FIELD(0x200, 24, 1, wheel_disable[0]),
+    BOARD_FIELD(0x200, 25, 1, wheel_disable[1]),
+    BOARD_FIELD(0x200, 26, 6, state),
+    BOARD_FIELD(0x200, 32, 8, fan_duty),
+    BOARD_FIELD(0x200, 40, 8, charge_connector_temp[0]),
+    BOARD_FIELD(0x200, 48, 8, charge_connector_temp[1]),
+    BOARD_FIELD(0x200, 56, 8, power_board_temp),
+    CAN_FIELD_LAYOUT(msg_board, 0x204, 0, 16, LITTLE, charge_connector_voltage, 1e-3f, false),
+    BOARD_FIELD(0x204, 16, 8, charge_check_count),
+    BOARD_FIELD(0x204, 24, 8, charge_heartbeat_delay),
+    BOARD_FIELD(0x204, 32, 8, charge_temperature_error),
+};
+
+#undef BMU_FIELD
+#undef BOARD_FIELD
+
+// The ranges of the acceptance filters of can_controller.
+inline constexpr frame_layout<msg_bmu, 0x100, 0x40, bmu_fields> bmu_layout;
+inline constexpr frame_layout<msg_board, 0x200, 0x08, board_fields> board_layout;
+static_assert(bmu_layout.valid() && board_layout.valid());
+
+// Updates the fields carried by one BMU frame, true on 0x130 which
+// closes the BMU report cycle.
+inline bool decode_bmu(uint32_t id, const uint8_t *data, msg_bmu &bmu)
+{
+    return bmu_layout.decode(id, data, bmu) && id == 0x130;
+}
+
+// Updates the fields carried by one power board frame, false on a frame
+// without fields.
+inline bool decode_board(uint32_t id, const uint8_t *data, msg_board &board)
+{
+    return board_layout.decode(id, data, board);
+}
+
+enum {
+    STALE_BOARD = 0,
+    STALE_BMU
+};
+
+enum {
+    RX_BMU = 0,
+    RX_BOARD,
+    RX_LOG,
+    RX_QUEUE_NUM
+};
+
+struct rx_stats {
+    uint32_t received, dropped, high_water, size;
+};
+
 struct msg_control {
     bool emergency_stop, power_off, wheel_power_off;
 } __attribute__((aligned(4)));
@@ -66,7 +184,12 @@ void run(void *p1, void *p2, void *p3);
 uint32_t get_rsoc();
 bool get_emergency_switch();
 bool get_bumper_switch();
-bool is_emergency();
+// Sends 0x201 at once, called by the emergency arbiter.
+void send_emergency();
+uint32_t get_stale_mask();
+// Counters of the frame queues between the CAN ISR and the controller loop.
+void get_rx_stats(rx_stats (&stats)[RX_QUEUE_NUM]);
+void reset_rx_stats();
 extern k_thread thread;
 extern k_msgq msgq_bmu, msgq_board, msgq_control;
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace lexxhard::can_controller {
+
+enum class byte_order : uint8_t {BIG, LITTLE};
+enum class field_type : uint8_t {BOOL, U8, I16, U16, F32};
+
+// One value carried by a frame: width bits from bit offset of the payload,
+// bit 0 being the LSB of data[0], and the member of the message it goes to.
+// Fields of 8 bits or more are whole bytes in the given order, narrower
+// fields sit within one byte.  Integer members take the raw value as it
+// converts, float members the raw value times scale.
+struct field_layout {
+    uint16_t id;
+    uint8_t offset, width;
+    byte_order order;
+    field_type type;
+    bool hex;
+    uint16_t member;
+    float scale;
+    const char *name;
+};
+
+template <typename T>
+constexpr field_type field_type_of()
+{
+    if constexpr (std::is_same_v<T, bool>)
+        return field_type::BOOL;
+    else if constexpr (std::is_same_v<T, uint8_t>)
+        return field_type::U8;
+    else if constexpr (std::is_same_v<T, int16_t>)
+        return field_type::I16;
+    else if constexpr (std::is_same_v<T, uint16_t>)
+        return field_type::U16;
+    else if constexpr (std::is_same_v<T, float>)
+        return field_type::F32;
+    else
+        static_assert(sizeof (T) == 0, "no field_type for this member");
+}
+
+#define CAN_FIELD_LAYOUT(MSG, ID, OFFSET, WIDTH, ORDER, MEMBER, SCALE, HEX)                           \
+    ::lexxhard::can_controller::field_layout{                                                           \
+        ID, OFFSET, WIDTH, ::lexxhard::can_controller::byte_order::ORDER,                              \
+        ::lexxhard::can_controller::field_type_of<                                                     \
+            std::remove_reference_t<decltype(std::declval<MSG&>().MEMBER)>>(),                         \
+        HEX, offsetof(MSG, MEMBER), SCALE, #MEMBER                                                     \
+    }
+
+// Expands the fields of the frames from BASE to BASE + SPAN - 1, the range
+// of the acceptance filter, into one id compare per frame that has fields,
+// followed by straight line stores, all inlined into decode() as a hand
+// written chain of ifs would be.  The fields of one frame must be next to
+// each other.
+template <typename MSG, uint16_t BASE, size_t SPAN, const auto &FIELDS>
+class frame_layout {
+public:
+    // False on a field out of the range or the payload, too wide for its
+    // member or apart from the other fields of its frame.
+    static constexpr bool valid() {
+        for (size_t i{0}; i < N; ++i) {
+            const field_layout &f{FIELDS[i]};
+            auto slot{static_cast<size_t>(f.id - BASE)};
+            if (slot >= SPAN || i < ranges[slot].first || i >= ranges[slot].first + ranges[slot].count)
+                return false;
+            if (f.width == 0 || f.offset + f.width > 64)
+                return false;
+            if (f.width < 8 ? f.offset % 8 + f.width > 8 : f.offset % 8 != 0 || f.width % 8 != 0 || f.width > 32)
+                return false;
+            if ((f.type == field_type::U8 && f.width > 8) ||
+                ((f.type == field_type::I16 || f.type == field_type::U16) && f.width > 16))
+                return false;
+        }
+        return true;
+    }
+    // Stores the fields of the frame in msg, false if the id has none.
+    static bool decode(uint32_t id, const uint8_t *data, MSG &msg) {
+        return decode_slots(id - BASE, data, msg, std::make_index_sequence<SPAN>{});
+    }
+    // Gives out() the fields of the frame as "name:value", packed into
+    // lines of about LINE_WIDTH characters, the first one led by the id.
+    template <typename OUT>
+    static void print_frame(uint32_t id, const MSG &msg, OUT out) {
+        uint32_t slot{id - BASE};
+        if (slot >= SPAN || ranges[slot].count == 0)
+            return;
+        char line[LINE_WIDTH + 48];
+        int len{snprintf(line, sizeof line, "0x%03x", static_cast<unsigned int>(id))};
+        for (size_t i{ranges[slot].first}, end{i + ranges[slot].count}; i < end; ++i) {
+            char item[48];
+            int n{std::min(format(FIELDS[i], msg, item, sizeof item), static_cast<int>(sizeof item - 1))};
+            if (len + 1 + n > LINE_WIDTH) {
+                out(line);
+                len = snprintf(line, sizeof line, "     ");
+            }
+            len += snprintf(&line[len], sizeof line - len, " %s", item);
+        }
+        out(line);
+    }
+    template <typename OUT>
+    static void print(const MSG &msg, OUT out) {
+        for (uint32_t slot{0}; slot < SPAN; ++slot)
+            print_frame(BASE + slot, msg, out);
+    }
+    static constexpr int LINE_WIDTH{80};
+private:
+    struct range {
+        size_t first, count;
+    };
+    static constexpr size_t N{std::size(FIELDS)};
+    static constexpr std::array<range, SPAN> make_ranges() {
+        std::array<range, SPAN> r{};
+        for (size_t i{0}; i < N; ++i) {
+            auto slot{static_cast<size_t>(FIELDS[i].id - BASE)};
+            if (r[slot].count++ == 0)
+                r[slot].first = i;
+        }
+        return r;
+    }
+    static constexpr uint32_t extract(const field_layout &f, const uint8_t *data) {
+        if (f.width < 8)
+            return (data[f.offset / 8] >> (f.offset % 8)) & ((1U << f.width) - 1);
+        uint32_t raw{0}, byte{f.offset / 8U}, n{f.width / 8U};
+        for (uint32_t i{0}; i < n; ++i)
+            raw |= data[byte + i] << (8 * (f.order == byte_order::BIG ? n - 1 - i : i));
+        return raw;
+    }
+    template <size_t I>
+    static void store(const uint8_t *data, MSG &msg) {
+        constexpr field_layout f{FIELDS[I]};
+        auto *p{reinterpret_cast<uint8_t*>(&msg) + f.member};
+        uint32_t raw{extract(f, data)};
+        if constexpr (f.type == field_type::BOOL)
+            *reinterpret_cast<bool*>(p) = raw != 0;
+        else if constexpr (f.type == field_type::U8)
+            *p = raw;
+        else if constexpr (f.type == field_type::I16)
+            *reinterpret_cast<int16_t*>(p) = raw;
+        else if constexpr (f.type == field_type::U16)
+            *reinterpret_cast<uint16_t*>(p) = raw;
+        else
+            *reinterpret_cast<float*>(p) = raw * f.scale;
+    }
+    template <size_t FIRST, size_t... I>
+    static void decode_frame(const uint8_t *data, MSG &msg, std::index_sequence<I...>) {
+        (store<FIRST + I>(data, msg), ...);
+    }
+    template <size_t SLOT>
+    static bool decode_slot(const uint8_t *data, MSG &msg) {
+        if constexpr (ranges[SLOT].count == 0) {
+            return false;
+        } else {
+            decode_frame<ranges[SLOT].first>(data, msg, std::make_index_sequence<ranges[SLOT].count>{});
+            return true;
+        }
+    }
+    // Slots without fields fold away to false.
+    template <size_t... SLOT>
+    static bool decode_slots(uint32_t slot, const uint8_t *data, MSG &msg, std::index_sequence<SLOT...>) {
+        return ((slot == SLOT && decode_slot<SLOT>(data, msg)) || ...);
+    }
+    static int format(const field_layout &f, const MSG &msg, char *buf, size_t size) {
+        const auto *p{reinterpret_cast<const uint8_t*>(&msg) + f.member};
+        switch (f.type) {
+        case field_type::BOOL: return snprintf(buf, size, "%s:%d", f.name, *reinterpret_cast<const bool*>(p));
+        case field_type::U8:   return snprintf(buf, size, f.hex ? "%s:0x%02x" : "%s:%u", f.name, *p);
+        case field_type::I16:  return snprintf(buf, size, "%s:%d", f.name, *reinterpret_cast<const int16_t*>(p));
+        case field_type::U16:  return snprintf(buf, size, f.hex ? "%s:0x%04x" : "%s:%u", f.name, *reinterpret_cast<const uint16_t*>(p));
+        case field_type::F32:  return snprintf(buf, size, "%s:%.3f", f.name, static_cast<double>(*reinterpret_cast<const float*>(p)));
+        }
+        return 0;
+    }
+    static constexpr std::array<range, SPAN> ranges{make_ranges()};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/can.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <cstdlib>
+#include <cstring>
+#include "can_controller.hpp"
+#include "can_load.hpp"
+#include "periodic.hpp"
+#ifdef CONFIG_BOARD_NATIVE_POSIX
+#include "sim.h"
+#endif
+
+#ifdef CONFIG_LEXXHARD_CAN_LOAD
+
+namespace lexxhard::can_load {
+
+LOG_MODULE_REGISTER(can_load);
+
+namespace {
+
+K_THREAD_STACK_DEFINE(load_stack, CONFIG_LEXXHARD_CAN_LOAD_STACK_SIZE);
+
+struct source {
+    uint16_t id;
+    uint16_t period_ms;
+    uint8_t dlc;
+    uint8_t data[8];
+};
+
+// Nominal traffic of one robot: the BMU report cycle closed by 0x130, the
+// power board status at 10Hz with its version and charge connector frames,
+// and one log line per second.
+constexpr source profile[]{
+    {0x100,  100, 7, {0x00, 0x00, 90, 90, 100, 0x00, 0x19}},
+    {0x101,  100, 7, {0xff, 0xf6, 0x00, 0x00, 0x65, 0x90, 0x00}},
+    {0x103, 1000, 6, {0x00, 0x3c, 0x00, 0x3a, 0x00, 0x34}},
+    {0x110, 1000, 7, {0x0f, 0xa0, 0x01, 0x00, 0x0f, 0x8c, 0x05}},
+    {0x111, 1000, 7, {0x00, 0x1e, 0x02, 0x00, 0x00, 0x19, 0x07}},
+    {0x112, 1000, 7, {0x00, 0x0a, 0x03, 0x00, 0xff, 0xf6, 0x04}},
+    {0x113, 1000, 6, {0x12, 0x34, 0x07, 0x01, 0x00, 0x00}},
+    {0x120, 1000, 7, {0x0f, 0x8c, 0x05, 0x00, 0x0f, 0xa0, 0x01}},
+    {0x130, 1000, 6, {0x07, 0xe8, 0x07, 0xe8, 0x00, 0x01}},
+    {0x200,  100, 8, {0b00000001, 0x00, 0x30, 2 << 2, 0, 25, 25, 30}},
+    {0x203, 1000, 4, {'0', '0', '0', '\0'}},
+    {0x204, 1000, 5, {0x00, 0x00, 0, 0, 0}},
+    {0x300, 1000, 8, {'c', 'a', 'n', 'l', 'o', 'a', 'd', '\n'}},
+};
+constexpr uint32_t SOURCE_NUM{sizeof profile / sizeof profile[0]};
+// A burst repeats the BMU report cycle, the first nine sources.
+constexpr uint32_t BURST_SOURCES{9};
+// Time the controller gets to empty its queues after a run.
+constexpr uint32_t DRAIN_MS{200};
+
+constexpr uint32_t frame_bits(uint32_t dlc)
+{
+    // Standard data frame without stuff bits.
+    return 47 + 8 * dlc;
+}
+
+}
+
+struct plan {
+    uint32_t scale, seconds, burst, burst_period_ms, max_scale;
+    bool sweep;
+};
+
+class can_load_impl {
+public:
+    bool start(const plan &p) {
+        if (running)
+            return false;
+        dev = device_get_binding("CAN_2");
+        if (!device_is_ready(dev))
+            return false;
+        this->p = p;
+        saturation = 0;
+        stop_requested = false;
+        running = true;
+        // Above the CAN controller, so a saturated controller cannot
+        // throttle the offered load.  This shares the lowest control loop
+        // priority, which is only acceptable on a test bench.
+        k_thread_create(&thread, load_stack, K_THREAD_STACK_SIZEOF(load_stack),
+                        entry, this, nullptr, nullptr, periodic::get_service_priority() - 1, 0, K_NO_WAIT);
+        k_thread_name_set(&thread, "can_load");
+        return true;
+    }
+    void stop() {
+        stop_requested = true;
+    }
+    void handled(uint32_t id, uint32_t stamp_cycle) {
+        uint32_t latency{k_cycle_get_32() - stamp_cycle};
+        for (uint32_t i{0}; i < SOURCE_NUM; ++i) {
+            if (profile[i].id == id) {
+                auto &s{stats[i]};
+                ++s.handled;
+                if (latency < s.latency_min)
+                    s.latency_min = latency;
+                if (latency > s.latency_max)
+                    s.latency_max = latency;
+                s.latency_sum += latency;
+                break;
+            }
+        }
+    }
+    void report(const shell *shell) const {
+        shell_print(shell, "scale x%u burst %u every %ums for %ums%s",
+                    scale, p.burst, p.burst_period_ms, elapsed_ms, running ? " (running)" : "");
+        shell_print(shell, "%-5s %8s %8s %8s %8s %8s %8s %8s",
+                    "id", "sent", "txfail", "handled", "lost", "min_us", "avg_us", "max_us");
+        for (uint32_t i{0}; i < SOURCE_NUM; ++i) {
+            const auto &s{stats[i]};
+            uint32_t avg{s.handled == 0 ? 0 : static_cast<uint32_t>(s.latency_sum / s.handled)};
+            shell_print(shell, "0x%03x %8u %8u %8u %8u %8u %8u %8u",
+                        profile[i].id, s.sent, s.tx_fail, s.handled, s.sent > s.handled ? s.sent - s.handled : 0,
+                        s.handled == 0 ? 0 : k_cyc_to_us_near32(s.latency_min),
+                        k_cyc_to_us_near32(avg), k_cyc_to_us_near32(s.latency_max));
+        }
+        can_controller::rx_stats rx[can_controller::RX_QUEUE_NUM];
+        can_controller::get_rx_stats(rx);
+        static constexpr const char *queue_name[]{"bmu", "board", "log"};
+        for (uint32_t i{0}; i < can_controller::RX_QUEUE_NUM; ++i) {
+            shell_print(shell, "queue %-5s size %2u high-water %2u received %u dropped %u",
+                        queue_name[i], rx[i].size, rx[i].high_water, rx[i].received, rx[i].dropped);
+        }
+        summary s;
+        summarize(s);
+        shell_print(shell, "offered %u fps handled %u fps bus load %u.%u%% at 500kbps",
+                    s.offered_fps, s.handled_fps, s.bus_permille / 10, s.bus_permille % 10);
+        if (saturation != 0)
+            shell_print(shell, "saturation at x%u", saturation);
+    }
+private:
+    struct id_stats {
+        uint32_t sent, tx_fail, handled;
+        uint32_t latency_min, latency_max;
+        uint64_t latency_sum;
+    };
+    struct summary {
+        uint32_t sent, handled, lost, dropped, high_water;
+        uint32_t offered_fps, handled_fps, bus_permille, latency_max_us;
+    };
+    static void entry(void *p1, void *p2, void *p3) {
+        static_cast<can_load_impl*>(p1)->execute();
+    }
+    void execute() {
+#ifdef CONFIG_BOARD_NATIVE_POSIX
+        // The emulated power board would add frames never counted as sent.
+        sim_power_board_set_enabled(false);
+#endif
+        if (p.sweep)
+            sweep();
+        else
+            step(p.scale);
+#ifdef CONFIG_BOARD_NATIVE_POSIX
+        sim_power_board_set_enabled(true);
+#endif
+        running = false;
+    }
+    // Doubles the rate until the controller loses a frame.
+    void sweep() {
+        for (uint32_t scale{1}; scale <= p.max_scale && !stop_requested; scale *= 2) {
+            step(scale);
+            summary s;
+            summarize(s);
+            LOG_INF("x%u offered %u fps handled %u fps bus %u.%u%% lost %u dropped %u high-water %u latency %uus",
+                    scale, s.offered_fps, s.handled_fps, s.bus_permille / 10, s.bus_permille % 10,
+                    s.lost, s.dropped, s.high_water, s.latency_max_us);
+            if (s.lost > 0 || s.dropped > 0) {
+                saturation = scale;
+                break;
+            }
+        }
+        if (saturation != 0)
+            LOG_INF("saturation at x%u", saturation);
+        else
+            LOG_INF("no loss up to x%u", p.max_scale);
+    }
+    void step(uint32_t step_scale) {
+        reset();
+        scale = step_scale;
+        uint64_t period_us[SOURCE_NUM], due_us[SOURCE_NUM];
+        for (uint32_t i{0}; i < SOURCE_NUM; ++i) {
+            period_us[i] = profile[i].period_ms * 1000ULL / scale;
+            due_us[i] = 0;
+        }
+        int64_t begin_ms{k_uptime_get()};
+        uint32_t next_burst_ms{p.burst_period_ms};
+        while (!stop_requested) {
+            uint32_t now_ms{static_cast<uint32_t>(k_uptime_get() - begin_ms)};
+            if (now_ms >= p.seconds * 1000)
+                break;
+            elapsed_ms = now_ms;
+            uint64_t now_us{now_ms * 1000ULL};
+            for (uint32_t i{0}; i < SOURCE_NUM; ++i) {
+                for (; due_us[i] <= now_us; due_us[i] += period_us[i])
+                    send(i);
+            }
+            if (p.burst > 0 && now_ms >= next_burst_ms) {
+                for (uint32_t n{0}; n < p.burst; ++n) {
+                    for (uint32_t i{0}; i < BURST_SOURCES; ++i)
+                        send(i);
+                }
+                next_burst_ms += p.burst_period_ms;
+            }
+            k_msleep(1);
+        }
+        elapsed_ms = static_cast<uint32_t>(k_uptime_get() - begin_ms);
+        k_msleep(DRAIN_MS);
+    }
+    void send(uint32_t index) {
+        const auto &src{profile[index]};
+        zcan_frame frame{
+            .id{src.id},
+            .rtr{CAN_DATAFRAME},
+            .id_type{CAN_STANDARD_IDENTIFIER},
+            .dlc{src.dlc}
+        };
+        memcpy(frame.data, src.data, sizeof src.data);
+        if (can_send(dev, &frame, K_NO_WAIT, nullptr, nullptr) == 0)
+            ++stats[index].sent;
+        else
+            ++stats[index].tx_fail;
+    }
+    void reset() {
+        for (auto &i: stats)
+            i = id_stats{0, 0, 0, UINT32_MAX, 0, 0};
+        can_controller::reset_rx_stats();
+        elapsed_ms = 0;
+    }
+    void summarize(summary &s) const {
+        s = summary{};
+        uint64_t bits{0};
+        uint32_t latency_max{0};
+        for (uint32_t i{0}; i < SOURCE_NUM; ++i) {
+            s.sent += stats[i].sent;
+            s.handled += stats[i].handled;
+            bits += static_cast<uint64_t>(stats[i].sent) * frame_bits(profile[i].dlc);
+            if (stats[i].latency_max > latency_max)
+                latency_max = stats[i].latency_max;
+        }
+        s.lost = s.sent > s.handled ? s.sent - s.handled : 0;
+        can_controller::rx_stats rx[can_controller::RX_QUEUE_NUM];
+        can_controller::get_rx_stats(rx);
+        for (const auto &i: rx) {
+            s.dropped += i.dropped;
+            if (i.high_water > s.high_water)
+                s.high_water = i.high_water;
+        }
+        if (elapsed_ms > 0) {
+            s.offered_fps = static_cast<uint32_t>(s.sent * 1000ULL / elapsed_ms);
+            s.handled_fps = static_cast<uint32_t>(s.handled * 1000ULL / elapsed_ms);
+            s.bus_permille = static_cast<uint32_t>(bits * 1000ULL / 500000ULL * 1000ULL / elapsed_ms);
+        }
+        s.latency_max_us = k_cyc_to_us_near32(latency_max);
+    }
+    plan p{1, 10, 0, 1000, 1, false};
+    id_stats stats[SOURCE_NUM]{};
+    k_thread thread;
+    const device *dev{nullptr};
+    uint32_t scale{1}, elapsed_ms{0}, saturation{0};
+    volatile bool running{false}, stop_requested{false};
+} impl;
+
+int start(const shell *shell, size_t argc, char **argv)
+{
+    if (argc < 2 || argc > 5) {
+        shell_error(shell, "Usage: %s %s <scale> [seconds] [burst] [burst_period_ms]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    plan p{
+        static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)),
+        argc >= 3 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 10U,
+        argc >= 4 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 0U,
+        argc >= 5 ? static_cast<uint32_t>(strtoul(argv[4], nullptr, 10)) : 1000U,
+        0,
+        false
+    };
+    if (p.scale == 0 || p.seconds == 0 || p.burst_period_ms == 0) {
+        shell_error(shell, "Usage: %s %s <scale> [seconds] [burst] [burst_period_ms]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    p.max_scale = p.scale;
+    if (!impl.start(p)) {
+        shell_error(shell, "already running or CAN_2 not ready\n");
+        return 1;
+    }
+    return 0;
+}
+
+int sweep(const shell *shell, size_t argc, char **argv)
+{
+    if (argc > 3) {
+        shell_error(shell, "Usage: %s %s [seconds] [max_scale]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    plan p{
+        1,
+        argc >= 2 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 5U,
+        0,
+        1000,
+        argc >= 3 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1024U,
+        true
+    };
+    if (p.seconds == 0) {
+        shell_error(shell, "Usage: %s %s [seconds] [max_scale]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (!impl.start(p)) {
+        shell_error(shell, "already running or CAN_2 not ready\n");
+        return 1;
+    }
+    return 0;
+}
+
+int stop(const shell *shell, size_t argc, char **argv)
+{
+    impl.stop();
+    return 0;
+}
+
+int report(const shell *shell, size_t argc, char **argv)
+{
+    impl.report(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(start, NULL, "Send <scale> times the nominal traffic [seconds] [burst] [burst_period_ms]", start),
+    SHELL_CMD(sweep, NULL, "Double the rate until frames are lost [seconds] [max_scale]", sweep),
+    SHELL_CMD(stop, NULL, "Stop the generator", stop),
+    SHELL_CMD(report, NULL, "Per ID and per queue counters of the last run", report),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(canload, &sub, "CAN traffic generator commands", NULL);
+
+void handled(uint32_t id, uint32_t stamp_cycle)
+{
+    impl.handled(id, stamp_cycle);
+}
+
+}
+
+#endif
+
+// vim: set expandtab shiftwidth=4:
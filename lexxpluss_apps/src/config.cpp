@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <fs/fs.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <sys/atomic.h>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "config.hpp"
+
+namespace lexxhard::config {
+
+LOG_MODULE_REGISTER(config);
+
+struct entry {
+    const char *name;
+    bool is_float;
+    float def, min, max;
+};
+
+// Loop period ranges stay inside the periods declared to the watchdog supervisor.
+const entry table[]{
+    {"actuator.pos_p",           true,  1.0f,     0.0f, 100.0f},
+    {"actuator.vel_p",           true,  0.0f,     0.0f, 100.0f},
+    {"actuator.vel_i",           true,  0.13f,    0.0f, 100.0f},
+    {"actuator.period_ms",       false, 10.0f,    1.0f, 100.0f},
+    {"adc.period_ms",            false, 20.0f,    1.0f, 100.0f},
+    {"can.heartbeat_timeout_ms", false, 3000.0f,  100.0f, 60000.0f},
+    {"can.overheat_deg",         true,  75.0f,    30.0f, 120.0f},
+    {"imu.period_ms",            false, 1.0f,     1.0f, 20.0f},
+    {"interlock.period_ms",      false, 200.0f,   1.0f, 400.0f},
+    {"led.clamp_threshold",      false, 128.0f,   0.0f, 255.0f},
+    {"misc.period_ms",           false, 100.0f,   1.0f, 400.0f},
+    {"pgv.period_ms",            false, 10.0f,    1.0f, 200.0f},
+    {"runaway.yaw_accel_limit",  true,  1.5f * static_cast<float>(M_PI), 0.0f, 100.0f},
+    {"sdlog.min_free_mb",        false, 1024.0f,  0.0f, 65536.0f},
+    {"tof.period_ms",            false, 20.0f,    1.0f, 400.0f},
+    {"towing_unit.period_ms",    false, 20.0f,    1.0f, 400.0f},
+    {"uss.filter_weight",        false, 75.0f,    0.0f, 100.0f},
+    {"uss.period_ms",            false, 100.0f,   1.0f, 400.0f},
+    {"tof.cliff_mm",             false, 0.0f,     0.0f, 2000.0f},
+};
+
+static_assert(ARRAY_SIZE(table) == KEY_NUM, "one entry per key, in key order");
+
+class config_impl {
+public:
+    void init() {
+        restore_values();
+        ++generation;
+    }
+    int load(const char *root) {
+        snprintf(path, sizeof path, "%s/%s", root, FILE_NAME);
+        snprintf(temp_path, sizeof temp_path, "%s/%s", root, TEMP_NAME);
+        stored = true;
+        fs_file_t fp;
+        fs_file_t_init(&fp);
+        if (fs_open(&fp, path, FS_O_READ) != 0) {
+            LOG_INF("no %s, defaults only", path);
+            return 0;
+        }
+        ssize_t n{fs_read(&fp, file_buffer, sizeof file_buffer - 1)};
+        fs_close(&fp);
+        if (n < 0) {
+            LOG_ERR("failed to read %s, defaults only", path);
+            return -1;
+        }
+        file_buffer[n] = '\0';
+        char *saveptr;
+        for (char *line{strtok_r(file_buffer, "\r\n", &saveptr)}; line != nullptr; line = strtok_r(nullptr, "\r\n", &saveptr)) {
+            char *value{strchr(line, '=')};
+            if (value == nullptr)
+                continue;
+            *value++ = '\0';
+            int k{find(line)};
+            if (int32_t raw; k < 0 || parse(k, value, raw) != 0)
+                LOG_WRN("%s=%s ignored, using default", line, value);
+            else
+                values[k] = raw;
+        }
+        ++generation;
+        return 0;
+    }
+    void save() {
+        if (!stored || atomic_clear(&dirty) == 0)
+            return;
+        fs_file_t fp;
+        fs_file_t_init(&fp);
+        fs_unlink(temp_path);
+        if (fs_open(&fp, temp_path, FS_O_WRITE | FS_O_CREATE) != 0) {
+            LOG_ERR("failed to create %s", temp_path);
+            return;
+        }
+        bool ok{true};
+        for (int i{0}; i < KEY_NUM && ok; ++i) {
+            int32_t def{default_value(i)};
+            if (values[i] == def)
+                continue;
+            char line[64];
+            int len;
+            if (table[i].is_float)
+                len = snprintf(line, sizeof line, "%s=%.9g\n", table[i].name, static_cast<double>(get_float(static_cast<key>(i))));
+            else
+                len = snprintf(line, sizeof line, "%s=%d\n", table[i].name, values[i]);
+            ok = fs_write(&fp, line, len) == len;
+        }
+        ok = fs_close(&fp) == 0 && ok;
+        // Replacing the file at once leaves either the old or the new one.
+        if (!ok || fs_rename(temp_path, path) != 0)
+            LOG_ERR("failed to save %s", path);
+    }
+    int find(const char *name) const {
+        for (int i{0}; i < KEY_NUM; ++i) {
+            if (strcmp(table[i].name, name) == 0)
+                return i;
+        }
+        return -ENOENT;
+    }
+    int set(int k, const char *str) {
+        if (k < 0 || k >= KEY_NUM)
+            return -ENOENT;
+        int32_t value;
+        if (int result{parse(k, str, value)}; result != 0)
+            return result;
+        values[k] = value;
+        ++generation;
+        LOG_INF("%s set", table[k].name);
+        atomic_set(&dirty, 1);
+        return 0;
+    }
+    int format(int k, char *buf, size_t len) const {
+        if (k < 0 || k >= KEY_NUM)
+            return -ENOENT;
+        if (table[k].is_float)
+            return snprintf(buf, len, "%s=%g", table[k].name, static_cast<double>(get_float(static_cast<key>(k))));
+        return snprintf(buf, len, "%s=%d", table[k].name, values[k]);
+    }
+    void restore_defaults() {
+        restore_values();
+        ++generation;
+        atomic_set(&dirty, 1);
+    }
+private:
+    static int32_t default_value(int k) {
+        int32_t value;
+        if (table[k].is_float)
+            memcpy(&value, &table[k].def, sizeof value);
+        else
+            value = static_cast<int32_t>(table[k].def);
+        return value;
+    }
+    static void restore_values() {
+        for (int i{0}; i < KEY_NUM; ++i)
+            values[i] = default_value(i);
+    }
+    static int parse(int k, const char *str, int32_t &value) {
+        char *end;
+        if (table[k].is_float) {
+            float f{strtof(str, &end)};
+            memcpy(&value, &f, sizeof value);
+        } else {
+            value = strtol(str, &end, 0);
+        }
+        if (end == str || *end != '\0')
+            return -EINVAL;
+        return in_range(k, value) ? 0 : -ERANGE;
+    }
+    static bool in_range(int k, int32_t value) {
+        const entry &e{table[k]};
+        if (!e.is_float)
+            return value >= e.min && value <= e.max;
+        float f;
+        memcpy(&f, &value, sizeof f);
+        return std::isfinite(f) && f >= e.min && f <= e.max;
+    }
+    static constexpr char FILE_NAME[]{"config.txt"}, TEMP_NAME[]{"config.tmp"};
+    char path[32], temp_path[32];
+    char file_buffer[KEY_NUM * 48];
+    atomic_t dirty{ATOMIC_INIT(0)};
+    bool stored{false};
+} impl;
+
+int list(const shell *shell, size_t argc, char **argv)
+{
+    char buf[64];
+    for (int i{0}; i < KEY_NUM; ++i) {
+        impl.format(i, buf, sizeof buf);
+        shell_print(shell, "%s", buf);
+    }
+    return 0;
+}
+
+int get(const shell *shell, size_t argc, char **argv)
+{
+    if (argc != 2) {
+        shell_error(shell, "Usage: %s %s <name>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    char buf[64];
+    if (impl.format(impl.find(argv[1]), buf, sizeof buf) < 0) {
+        shell_error(shell, "unknown name %s", argv[1]);
+        return 1;
+    }
+    shell_print(shell, "%s", buf);
+    return 0;
+}
+
+int set_value(const shell *shell, size_t argc, char **argv)
+{
+    if (argc != 3) {
+        shell_error(shell, "Usage: %s %s <name> <value>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (int result{impl.set(impl.find(argv[1]), argv[2])}; result != 0) {
+        shell_error(shell, "failed to set %s (%d)", argv[1], result);
+        return 1;
+    }
+    return 0;
+}
+
+int defaults(const shell *shell, size_t argc, char **argv)
+{
+    impl.restore_defaults();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(list, NULL, "List all values", list),
+    SHELL_CMD(get, NULL, "Get a value", get),
+    SHELL_CMD(set, NULL, "Set and save a value", set_value),
+    SHELL_CMD(default, NULL, "Restore and save all defaults", defaults),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(config, &sub, "Runtime configuration commands", NULL);
+
+void init()
+{
+    impl.init();
+}
+
+int load(const char *root)
+{
+    return impl.load(root);
+}
+
+void save()
+{
+    impl.save();
+}
+
+int find(const char *name)
+{
+    return impl.find(name);
+}
+
+const char *get_name(int k)
+{
+    return k >= 0 && k < KEY_NUM ? table[k].name : "unknown";
+}
+
+int set(int k, const char *value)
+{
+    return impl.set(k, value);
+}
+
+int format(int k, char *buf, size_t len)
+{
+    return impl.format(k, buf, len);
+}
+
+void restore_defaults()
+{
+    impl.restore_defaults();
+}
+
+int32_t values[KEY_NUM];
+uint32_t generation{0};
+
+}
+
+// vim: set expandtab shiftwidth=4:
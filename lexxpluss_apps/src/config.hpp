@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstring>
+
+namespace lexxhard::config {
+
+// Saved by name, in the order of the table in config.cpp.
+enum key {
+    ACTUATOR_POS_P = 0,
+    ACTUATOR_VEL_P,
+    ACTUATOR_VEL_I,
+    ACTUATOR_PERIOD_MS,
+    ADC_PERIOD_MS,
+    CAN_HEARTBEAT_TIMEOUT_MS,
+    CAN_OVERHEAT_DEG,
+    IMU_PERIOD_MS,
+    INTERLOCK_PERIOD_MS,
+    LED_CLAMP_THRESHOLD,
+    MISC_PERIOD_MS,
+    PGV_PERIOD_MS,
+    RUNAWAY_YAW_ACCEL_LIMIT,
+    SDLOG_MIN_FREE_MB,
+    TOF_PERIOD_MS,
+    TOWING_UNIT_PERIOD_MS,
+    USS_FILTER_WEIGHT,
+    USS_PERIOD_MS,
+    TOF_CLIFF_MM,
+    KEY_NUM
+};
+
+void init();
+// Reads the values saved under root, keeping the default of any missing or
+// out of range.  Until then, and without a card, the defaults are used.
+int load(const char *root);
+// Writes the values that differ from the default if any value changed,
+// from the thread that owns the card.
+void save();
+int find(const char *name);
+const char *get_name(int k);
+// Range checked, applied at once and saved by the next save().
+int set(int k, const char *value);
+int format(int k, char *buf, size_t len);
+void restore_defaults();
+
+// RAM copy of every value, read directly on the hot paths.
+extern int32_t values[KEY_NUM];
+extern uint32_t generation;
+
+inline int32_t get_int(key k)
+{
+    return values[k];
+}
+
+inline float get_float(key k)
+{
+    float value;
+    memcpy(&value, &values[k], sizeof value);
+    return value;
+}
+
+// Changes whenever any value changes, for users that derive state from values.
+inline uint32_t get_generation()
+{
+    return generation;
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
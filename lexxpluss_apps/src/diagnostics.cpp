@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <shell/shell.h>
+#include "diagnostics.hpp"
+
+namespace lexxhard::diagnostics {
+
+struct status {
+    uint8_t level, code;
+    uint8_t worst_level, worst_code;
+    uint16_t count;
+};
+
+class diagnostics_impl {
+public:
+    void report(int subsystem, int level, int code) {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        status &s{subsystems[subsystem]};
+        s.level = level;
+        s.code = code;
+        if (level != OK && s.count < UINT16_MAX)
+            ++s.count;
+        if (s.worst_level < level) {
+            s.worst_level = level;
+            s.worst_code = code;
+        }
+        k_spin_unlock(&lock, key);
+    }
+    uint32_t snapshot(int subsystem) {
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        status &s{subsystems[subsystem]};
+        uint32_t packed{pack(s.worst_level, s.worst_code, s.count)};
+        s.worst_level = s.level;
+        s.worst_code = s.code;
+        k_spin_unlock(&lock, key);
+        return packed;
+    }
+    void info(const shell *shell) const {
+        static const char *const level_name[]{"OK", "WARN", "ERROR"};
+        shell_print(shell, "%-10s %-5s %4s %5s", "name", "level", "code", "count");
+        for (int i{0}; i < SUBSYSTEM_NUM; ++i) {
+            const status &s{subsystems[i]};
+            shell_print(shell, "%-10s %-5s %4u %5u", names[i], level_name[s.level], s.code, s.count);
+        }
+    }
+    static uint32_t pack(uint32_t level, uint32_t code, uint32_t count) {
+        return level << 24 | code << 16 | count;
+    }
+    static const char *const names[SUBSYSTEM_NUM];
+private:
+    status subsystems[SUBSYSTEM_NUM]{};
+    k_spinlock lock;
+} impl;
+
+const char *const diagnostics_impl::names[SUBSYSTEM_NUM]{
+    "actuator", "adc", "can", "imu", "led", "misc", "pgv", "sdlog", "uss", "watchdog"
+};
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Subsystem health", info),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(diag, &sub, "Diagnostics commands", NULL);
+
+void report(int subsystem, int level, int code)
+{
+    impl.report(subsystem, level, code);
+}
+
+uint32_t snapshot(int subsystem)
+{
+    return impl.snapshot(subsystem);
+}
+
+const char *get_name(int subsystem)
+{
+    return subsystem >= 0 && subsystem < SUBSYSTEM_NUM ? diagnostics_impl::names[subsystem] : "unknown";
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
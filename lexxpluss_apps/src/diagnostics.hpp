@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::diagnostics {
+
+enum {
+    ACTUATOR = 0,
+    ADC,
+    CAN,
+    IMU,
+    LED,
+    MISC,
+    PGV,
+    SDLOG,
+    USS,
+    WATCHDOG,
+    SUBSYSTEM_NUM
+};
+
+enum {
+    OK = 0,
+    WARN,
+    ERROR
+};
+
+enum {
+    CODE_NONE = 0,
+    CODE_DEVICE_NOT_READY,
+    CODE_FAULT,
+    CODE_FAULT_PERSISTENT,
+    CODE_HEARTBEAT_TIMEOUT,
+    CODE_INVALID_DATA,
+    CODE_NO_MEDIA,
+    CODE_LOOP_LATE
+};
+
+// Latest status of a subsystem; every non-OK report also bumps its counter.
+void report(int subsystem, int level, int code);
+// level << 24 | code << 16 | count, with the worst level seen since the
+// previous snapshot so short faults are not lost between publishes.
+uint32_t snapshot(int subsystem);
+const char *get_name(int subsystem);
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include "actuator_controller.hpp"
+#include "blackbox.hpp"
+#include "can_controller.hpp"
+#include "emergency.hpp"
+
+namespace lexxhard::emergency {
+
+LOG_MODULE_REGISTER(emergency);
+
+const char *const names[]{
+    "can_emergency_switch",
+    "can_bumper",
+    "ros",
+    "interlock",
+    "runaway",
+    "cliff",
+};
+
+static_assert(ARRAY_SIZE(names) == SOURCE_NUM, "one name per source, in source order");
+
+static constexpr atomic_val_t LATCHED{BIT(RUNAWAY) | BIT(CLIFF)};
+
+class emergency_impl {
+public:
+    int init() {
+        k_sem_init(&sem, 0, 1);
+        // The board boots with the ROS emergency stop requested, as before.
+        atomic_set(&active_mask, BIT(ROS));
+        return 0;
+    }
+    void run() {
+        while (true) {
+            k_sem_take(&sem, K_FOREVER);
+            uint32_t rising{static_cast<uint32_t>(atomic_clear(&pending))};
+            if (rising == 0)
+                continue;
+            actuator_controller::emergency_stop();
+            uint32_t off_cycle{k_cycle_get_32()};
+            can_controller::send_emergency();
+            for (int i{0}; i < SOURCE_NUM; ++i) {
+                if ((rising & BIT(i)) == 0)
+                    continue;
+                source_stats &s{stats[i]};
+                s.last_us = k_cyc_to_us_near32(off_cycle - stamp_cycle[i]);
+                if (s.max_us < s.last_us)
+                    s.max_us = s.last_us;
+                ++s.count;
+                LOG_WRN("%s asserted, PWM off after %uus", names[i], s.last_us);
+                blackbox::trigger(i);
+            }
+        }
+    }
+    void set(int source, bool active) {
+        atomic_val_t bit{static_cast<atomic_val_t>(BIT(source))};
+        if (active) {
+            if ((atomic_or(&active_mask, bit) & bit) == 0) {
+                stamp_cycle[source] = k_cycle_get_32();
+                atomic_or(&pending, bit);
+                k_sem_give(&sem);
+            }
+        } else if ((bit & LATCHED) == 0) {
+            // Releasing the ROS emergency stop acknowledges the latched sources.
+            if ((atomic_and(&active_mask, ~bit) & bit) != 0 && source == ROS)
+                clear_latched();
+        }
+    }
+    void clear_latched() {
+        atomic_and(&active_mask, ~LATCHED);
+    }
+    void info(const shell *shell) const {
+        uint32_t mask{static_cast<uint32_t>(atomic_get(&active_mask))};
+        shell_print(shell, "%-20s %6s %6s %8s %8s %8s",
+                    "source", "active", "latch", "count", "last(us)", "max(us)");
+        for (int i{0}; i < SOURCE_NUM; ++i) {
+            const source_stats &s{stats[i]};
+            shell_print(shell, "%-20s %6d %6d %8u %8u %8u",
+                        names[i], (mask & BIT(i)) != 0, (LATCHED & BIT(i)) != 0,
+                        s.count, s.last_us, s.max_us);
+        }
+    }
+private:
+    struct source_stats {
+        uint32_t count, last_us, max_us;
+    } stats[SOURCE_NUM]{};
+    uint32_t stamp_cycle[SOURCE_NUM]{};
+    atomic_t pending{ATOMIC_INIT(0)};
+    k_sem sem;
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int clear(const shell *shell, size_t argc, char **argv)
+{
+    impl.clear_latched();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Emergency sources and stop latency", info),
+    SHELL_CMD(clear, NULL, "Clear latched sources", clear),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(emergency, &sub, "Emergency arbiter commands", NULL);
+
+void init()
+{
+    impl.init();
+}
+
+void run(void *p1, void *p2, void *p3)
+{
+    impl.run();
+}
+
+void set(int source, bool active)
+{
+    impl.set(source, active);
+}
+
+void clear_latched()
+{
+    impl.clear_latched();
+}
+
+const char *get_name(int source)
+{
+    return source >= 0 && source < SOURCE_NUM ? names[source] : "unknown";
+}
+
+k_thread thread;
+atomic_t active_mask{ATOMIC_INIT(0)};
+
+}
+
+// vim: set expandtab shiftwidth=4:
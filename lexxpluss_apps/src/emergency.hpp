@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <sys/atomic.h>
+
+namespace lexxhard::emergency {
+
+enum {
+    CAN_EMERGENCY_SWITCH = 0,
+    CAN_BUMPER,
+    ROS,
+    INTERLOCK,
+    RUNAWAY,
+    CLIFF,
+    SOURCE_NUM
+};
+
+void init();
+void run(void *p1, void *p2, void *p3);
+// ISR safe, call it with every sample; only a rising edge wakes the arbiter.
+// RUNAWAY and CLIFF stay latched until the ROS emergency stop is released.
+void set(int source, bool active);
+void clear_latched();
+const char *get_name(int source);
+extern k_thread thread;
+
+extern atomic_t active_mask;
+
+// Read on every PWM write, keep it to a single load.
+inline bool is_active()
+{
+    return atomic_get(&active_mask) != 0;
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include "executor.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
+
+namespace lexxhard::executor {
+
+LOG_MODULE_REGISTER(executor);
+
+struct task {
+    const char *name;
+    void (*poll)();
+    config::key period_key;
+    int64_t period, release;
+    int priority;
+    uint32_t runs, overruns, skips;
+    uint32_t max_jitter, max_exec;
+    uint64_t sum_jitter;
+};
+
+class executor_impl {
+public:
+    int add(const char *name, void (*poll)(), config::key period_ms, int priority) {
+        if (num_tasks >= MAX_TASKS)
+            return -1;
+        task &t{tasks[num_tasks]};
+        t = task{};
+        t.name = name;
+        t.poll = poll;
+        t.period_key = period_ms;
+        t.period = k_ms_to_ticks_ceil32(config::get_int(period_ms));
+        t.priority = priority;
+        t.release = k_uptime_ticks();
+        ++num_tasks; // publish the entry only after it is complete
+        return 0;
+    }
+    void run() {
+        for (uint32_t i{0}; i < num_tasks; ++i)
+            tasks[i].release = k_uptime_ticks();
+        watchdog_supervisor::declare(watchdog_supervisor::EXECUTOR, "executor", 500, true);
+        while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::EXECUTOR);
+            if (uint32_t gen{config::get_generation()}; gen != config_generation) {
+                config_generation = gen;
+                for (uint32_t i{0}; i < num_tasks; ++i)
+                    tasks[i].period = k_ms_to_ticks_ceil32(config::get_int(tasks[i].period_key));
+            }
+            int64_t now{k_uptime_ticks()};
+            task *next{nullptr};
+            int64_t wakeup{INT64_MAX};
+            for (uint32_t i{0}; i < num_tasks; ++i) {
+                task &t{tasks[i]};
+                if (t.release > now) {
+                    if (wakeup > t.release)
+                        wakeup = t.release;
+                } else if (next == nullptr ||
+                           t.priority < next->priority ||
+                           (t.priority == next->priority && t.release < next->release)) {
+                    next = &t;
+                }
+            }
+            if (next != nullptr)
+                execute(*next, now);
+            else if (wakeup == INT64_MAX)
+                k_msleep(100);
+            else
+                k_sleep(K_TICKS(wakeup - now));
+        }
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "%-12s %6s %4s %8s %8s %8s %8s %6s %6s",
+                    "name", "period", "prio", "runs", "jit(us)", "max(us)", "exec(us)", "over", "skip");
+        for (uint32_t i{0}; i < num_tasks; ++i) {
+            const task &t{tasks[i]};
+            uint32_t mean{t.runs == 0 ? 0 : static_cast<uint32_t>(t.sum_jitter / t.runs)};
+            shell_print(shell, "%-12s %6u %4d %8u %8u %8u %8u %6u %6u",
+                        t.name, k_ticks_to_ms_near32(t.period), t.priority, t.runs,
+                        k_ticks_to_us_near32(mean), k_ticks_to_us_near32(t.max_jitter),
+                        k_ticks_to_us_near32(t.max_exec), t.overruns, t.skips);
+        }
+    }
+    void reset() {
+        for (uint32_t i{0}; i < num_tasks; ++i) {
+            task &t{tasks[i]};
+            t.runs = t.overruns = t.skips = t.max_jitter = t.max_exec = 0;
+            t.sum_jitter = 0;
+        }
+    }
+private:
+    void execute(task &t, int64_t start) {
+        uint8_t index{static_cast<uint8_t>(&t - tasks)};
+        TRACE_BEGIN_N(EXECUTOR, index);
+        t.poll();
+        TRACE_END_N(EXECUTOR, index);
+        int64_t end{k_uptime_ticks()};
+        uint32_t jitter{static_cast<uint32_t>(start - t.release)};
+        uint32_t exec{static_cast<uint32_t>(end - start)};
+        ++t.runs;
+        t.sum_jitter += jitter;
+        if (t.max_jitter < jitter)
+            t.max_jitter = jitter;
+        if (t.max_exec < exec)
+            t.max_exec = exec;
+        t.release += t.period;
+        if (end > t.release)
+            ++t.overruns;
+        if (t.release + t.period <= end) {
+            // Fell more than a whole period behind, drop the missed releases.
+            ++t.skips;
+            t.release = end;
+        }
+    }
+    static constexpr uint32_t MAX_TASKS{8};
+    task tasks[MAX_TASKS];
+    uint32_t num_tasks{0}, config_generation{0};
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int reset(const shell *shell, size_t argc, char **argv)
+{
+    impl.reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Executor task information", info),
+    SHELL_CMD(reset, NULL, "Reset executor statistics", reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(executor, &sub, "Executor commands", NULL);
+
+void init()
+{
+}
+
+void run(void *p1, void *p2, void *p3)
+{
+    impl.run();
+}
+
+int add(const char *name, void (*poll)(), config::key period_ms, int priority)
+{
+    return impl.add(name, poll, period_ms, priority);
+}
+
+k_thread thread;
+
+}
+
+// vim: set expandtab shiftwidth=4:
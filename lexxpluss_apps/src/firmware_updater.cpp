@@ -28,9 +28,16 @@
 #include <storage/flash_map.h>
 #include <sys/reboot.h>
 #include "firmware_updater.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::firmware_updater {
 
+namespace {
+
+constexpr uint32_t SECTORS_MAX{32}, FEED_WAIT_MS{1000};
+
+}
+
 class {
 public:
     void init() {
@@ -38,7 +45,10 @@ public:
         k_msgq_init(&msgq_response, msgq_response_buffer, sizeof (response_array), 2);
     }
     void run() {
+        // Erasing the secondary slot can take several seconds, see erase_slot().
+        watchdog_supervisor::declare(watchdog_supervisor::FIRMWARE_UPDATER, "firmware_updater", 10000, false);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::FIRMWARE_UPDATER);
             cmd();
             failsafe();
             reboot();
@@ -110,30 +120,52 @@ private:
             respond(RESP::ERR_FLASH_AREA);
             return;
         }
-        static constexpr uint32_t LENGTH{0x00040000};
-        for (uint32_t current_offset{0}; current_offset < LENGTH; current_offset += 4) {
-            uint32_t buf{0};
-            flash_area_read(fa, current_offset, &buf, sizeof buf);
-            if (buf != 0xffffffff) {
-                if (flash_area_erase(fa, 0, LENGTH) != 0) {
-                    flash_area_reset();
-                    respond(RESP::ERR_FLASH_ERASE);
-                    return;
-                }
-            }
+        if (!erase_slot()) {
+            flash_area_reset();
+            respond(RESP::ERR_FLASH_ERASE);
+            return;
         }
         cmd_data(data);
     }
+    // A sector erase stalls every instruction fetch from this single bank
+    // flash, so the slot is erased one sector at a time and the next erase
+    // waits until the loops have caught up and the IWDG has been fed.
+    bool erase_slot() {
+        flash_sector sectors[SECTORS_MAX];
+        uint32_t count{SECTORS_MAX};
+        if (flash_area_get_sectors(FLASH_AREA_ID(image_1), &count, sectors) != 0)
+            return false;
+        for (uint32_t i{0}; i < count; ++i) {
+            if (is_blank(sectors[i]))
+                continue;
+            if (flash_area_erase(fa, sectors[i].fs_off, sectors[i].fs_size) != 0)
+                return false;
+            watchdog_supervisor::checkin(watchdog_supervisor::FIRMWARE_UPDATER);
+            uint32_t feed_count{watchdog_supervisor::get_feed_count()};
+            for (uint32_t waited_ms{0}; watchdog_supervisor::get_feed_count() == feed_count && waited_ms < FEED_WAIT_MS;
+                 waited_ms += CONFIG_LEXXHARD_WATCHDOG_CHECK_MS)
+                k_msleep(CONFIG_LEXXHARD_WATCHDOG_CHECK_MS);
+        }
+        return true;
+    }
+    bool is_blank(const flash_sector &sector) const {
+        for (uint32_t offset{0}; offset < sector.fs_size; offset += sizeof blank_buffer) {
+            if (flash_area_read(fa, sector.fs_off + offset, blank_buffer, sizeof blank_buffer) != 0)
+                return false;
+            for (auto i : blank_buffer) {
+                if (i != 0xffffffff)
+                    return false;
+            }
+        }
+        return true;
+    }
     void cmd_data(const uint8_t *data) {
         if (fa == nullptr) {
             flash_area_reset();
             respond(RESP::ERR_POINTER);
             return;
         }
-        uint8_t checksum{0x0};
-        for (int i{3}; i < 259; i++)
-            checksum += data[i];
-        if (checksum != data[259]) {
+        if (!checksum_ok(data)) {
             flash_area_reset();
             respond(RESP::ERR_CHECKSUM);
             return;
@@ -167,6 +199,7 @@ private:
         response.data[0] = static_cast<uint16_t>(resp);
         k_msgq_put(&msgq_response, response.data, K_MSEC(2000));
     }
+    mutable uint32_t blank_buffer[16];
     char __aligned(4) msgq_data_buffer[2 * sizeof (packet_array)];
     char __aligned(4) msgq_response_buffer[2 * sizeof (response_array)];
     response_array response;
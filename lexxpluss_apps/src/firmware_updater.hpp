@@ -38,6 +38,15 @@ struct response_array {
     uint16_t data[2];
 } __attribute__((aligned(4)));
 
+// Byte 259 of a packet is the 8 bit sum of the 256 payload bytes at 3..258.
+inline bool checksum_ok(const uint8_t *data)
+{
+    uint8_t checksum{0x0};
+    for (int i{3}; i < 259; i++)
+        checksum += data[i];
+    return checksum == data[259];
+}
+
 void init();
 void run(void *p1, void *p2, void *p3);
 extern k_thread thread;
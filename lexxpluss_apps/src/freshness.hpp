@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard {
+
+// A channel stays stale from boot until its first update, so a sensor
+// that never answers is never reported fresh.
+template<int N>
+class freshness {
+public:
+    static_assert(N <= 32);
+    explicit freshness(uint32_t limit_ms) : limit_ms{limit_ms} {}
+    void update(int index) {
+        last_ms[index] = k_uptime_get_32();
+        updated |= 1U << index;
+    }
+    // UINT32_MAX until the first update.
+    uint32_t age_ms(int index) const {
+        if ((updated & (1U << index)) == 0)
+            return UINT32_MAX;
+        return k_uptime_get_32() - last_ms[index];
+    }
+    bool is_stale(int index) const {
+        return age_ms(index) > limit_ms;
+    }
+    uint32_t stale_mask() const {
+        uint32_t mask{0};
+        for (int i{0}; i < N; ++i) {
+            if (is_stale(i))
+                mask |= 1U << i;
+        }
+        return mask;
+    }
+    void set_limit(uint32_t limit_ms) {
+        this->limit_ms = limit_ms;
+    }
+    uint32_t get_limit() const {
+        return limit_ms;
+    }
+private:
+    uint32_t last_ms[N]{0};
+    uint32_t updated{0};
+    uint32_t limit_ms;
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -27,8 +27,16 @@
 #include <drivers/sensor.h>
 #include <logging/log.h>
 #include <shell/shell.h>
+#include "blackbox.hpp"
+#include "diagnostics.hpp"
+#include "freshness.hpp"
 #include "imu_controller.hpp"
+#include "latency.hpp"
+#include "periodic.hpp"
+#include "recorder.hpp"
 #include "runaway_detector.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::imu_controller {
 
@@ -54,10 +62,17 @@ public:
         return 0;
     }
     void run() {
-        if (!device_is_ready(dev))
+        if (!device_is_ready(dev)) {
+            diagnostics::report(diagnostics::IMU, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
+        watchdog_supervisor::declare(watchdog_supervisor::IMU_CONTROLLER, "imu_controller", 50, true);
+        periodic::start(periodic::IMU_CONTROLLER);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::IMU_CONTROLLER);
+            TRACE_BEGIN(IMU_CONTROLLER);
             if (sensor_sample_fetch_chan(dev, SENSOR_CHAN_ALL) == 0) {
+                message.stamp_cycle = k_cycle_get_32();
                 message.accel[0] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_X);
                 message.accel[1] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_Y);
                 message.accel[2] = get_sensor_value_as_float(SENSOR_CHAN_ACCEL_Z);
@@ -65,22 +80,27 @@ public:
                 message.gyro[1] = get_sensor_value_as_float(SENSOR_CHAN_GYRO_Y);
                 message.gyro[2] = get_sensor_value_as_float(SENSOR_CHAN_GYRO_Z);
                 message.temp = get_sensor_value_as_float(SENSOR_CHAN_DIE_TEMP);
+                record_input();
                 message.delta_ang[0] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START);
                 message.delta_ang[1] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 1);
                 message.delta_ang[2] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 2);
                 message.delta_vel[0] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 3);
                 message.delta_vel[1] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 4);
                 message.delta_vel[2] = get_sensor_value_as_float(SENSOR_CHAN_PRIV_START, 5);
+                fresh.update(0);
                 while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
                     k_msgq_purge(&msgq);
+                latency::record(latency::PATH_IMU, latency::HOP_QUEUE, message.stamp_cycle);
                 runaway_detector::msg message_runaway{
                     .accel{message.accel[0], message.accel[1], message.accel[2]},
                     .gyro{message.gyro[0], message.gyro[1], message.gyro[2]}
                 };
                 while (k_msgq_put(&runaway_detector::msgq, &message_runaway, K_NO_WAIT) != 0)
                     k_msgq_purge(&runaway_detector::msgq);
+                record_blackbox();
             }
-            k_msleep(1);
+            TRACE_END(IMU_CONTROLLER);
+            periodic::wait(periodic::IMU_CONTROLLER);
         }
     }
     void info(const shell *shell) const {
@@ -90,14 +110,39 @@ public:
                     "gyro: %f %f %f (deg/s)\n"
                     "vel: %f %f %f (m/s)\n"
                     "ang: %f %f %f (deg)\n"
-                    "temp: %fdeg",
+                    "temp: %fdeg\n"
+                    "age: %ums stale: %d",
                     m.accel[0], m.accel[1], m.accel[2],
                     m.gyro[0], m.gyro[1], m.gyro[2],
                     m.delta_vel[0], m.delta_vel[1], m.delta_vel[2],
                     m.delta_ang[0], m.delta_ang[1], m.delta_ang[2],
-                    m.temp);
+                    m.temp,
+                    fresh.age_ms(0), is_stale());
+    }
+    bool is_stale() const {
+        return fresh.is_stale(0);
     }
 private:
+    void record_input() const {
+        recording_imu sample{{
+            message.accel[0], message.accel[1], message.accel[2],
+            message.gyro[0], message.gyro[1], message.gyro[2],
+            message.temp
+        }};
+        recorder::record(RECORDING_IMU, &sample, sizeof sample);
+    }
+    void record_blackbox() {
+        // 100Hz is enough to see what happened and keeps the ring seconds long.
+        if (uint32_t now_ms{k_uptime_get_32()}; now_ms - blackbox_ms >= 10) {
+            blackbox_ms = now_ms;
+            blackbox::imu_sample sample;
+            for (int i{0}; i < 3; ++i) {
+                sample.accel[i] = static_cast<int16_t>(message.accel[i] * 100.0f);
+                sample.gyro[i] = static_cast<int16_t>(message.gyro[i] * 10.0f);
+            }
+            blackbox::record(blackbox::IMU, &sample, sizeof sample);
+        }
+    }
     float get_sensor_value_as_float(enum sensor_channel chan, uint32_t offset) const {
         chan = static_cast<enum sensor_channel>(static_cast<uint32_t>(chan) + offset);
         return get_sensor_value_as_float(chan);
@@ -109,6 +154,8 @@ private:
     }
     const device *dev{nullptr};
     msg message;
+    freshness<1> fresh{CONFIG_LEXXHARD_STALE_IMU_MS};
+    uint32_t blackbox_ms{0};
 } impl;
 
 int info(const shell *shell, size_t argc, char **argv)
@@ -133,6 +180,11 @@ void run(void *p1, void *p2, void *p3)
     impl.run();
 }
 
+bool is_stale()
+{
+    return impl.is_stale();
+}
+
 k_thread thread;
 k_msgq msgq;
 
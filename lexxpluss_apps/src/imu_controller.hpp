@@ -35,10 +35,12 @@ struct msg {
     float delta_ang[3];
     float delta_vel[3];
     float temp;
+    uint32_t stamp_cycle;
 } __attribute__((aligned(4)));
 
 void init();
 void run(void *p1, void *p2, void *p3);
+bool is_stale();
 extern k_thread thread;
 extern k_msgq msgq;
 
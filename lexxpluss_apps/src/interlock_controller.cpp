@@ -28,6 +28,7 @@
 #include <drivers/gpio.h>
 #include <logging/log.h>
 #include "can_controller.hpp"
+#include "emergency.hpp"
 #include "interlock_controller.hpp"
 
 namespace lexxhard::interlock_controller {
@@ -46,62 +47,69 @@ public:
         k_msgq_init(&msgq_can_interlock, msgq_can_interlock_buffer, sizeof (msg_can_interlock), 8);
         is_emergency_stop_at_amr = false;
         is_emergency_stop_at_connected_robot = false;
-        return 0;
-    }
-    void run() {
-        const device *gpioc{device_get_binding("GPIOC")};
+        gpioc = device_get_binding("GPIOC");
         if (device_is_ready(gpioc)) {
             gpio_pin_configure(gpioc, 4, GPIO_INPUT      | GPIO_ACTIVE_HIGH);
             gpio_pin_configure(gpioc, 5, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
+#ifdef ENABLE_INTERLOCK
+            // The poll below is too slow for a stop, let the pin edge reach the arbiter.
+            gpio_init_callback(&callback, interlock_isr, BIT(4));
+            gpio_add_callback(gpioc, &callback);
+            gpio_pin_interrupt_configure(gpioc, 4, GPIO_INT_EDGE_BOTH);
+#endif  // ENABLE_INTERLOCK
         }
-
-        while (true) {
+        return 0;
+    }
+    void poll() {
 #ifdef ENABLE_INTERLOCK
-            if (device_is_ready(gpioc)) {
-                is_emergency_stop_at_connected_robot = (gpio_pin_get(gpioc, 4) == 0);
-            } else {
-                is_emergency_stop_at_connected_robot = true;
-            }
+        if (device_is_ready(gpioc)) {
+            is_emergency_stop_at_connected_robot = (gpio_pin_get(gpioc, 4) == 0);
+        } else {
+            is_emergency_stop_at_connected_robot = true;
+        }
+        emergency::set(emergency::INTERLOCK, is_emergency_stop_at_connected_robot);
 
-            msg_connected_robot_status message_connected_robot_status;
-            message_connected_robot_status.is_emergency_stop = is_emergency_stop_at_connected_robot;
-            while (k_msgq_put(&msgq_connected_robot_status, &message_connected_robot_status, K_NO_WAIT) != 0) {
-                k_msgq_purge(&msgq_connected_robot_status);
-            }
+        msg_connected_robot_status message_connected_robot_status;
+        message_connected_robot_status.is_emergency_stop = is_emergency_stop_at_connected_robot;
+        while (k_msgq_put(&msgq_connected_robot_status, &message_connected_robot_status, K_NO_WAIT) != 0) {
+            k_msgq_purge(&msgq_connected_robot_status);
+        }
 
-            msg_amr_status message_amr_status;
-            if (k_msgq_get(&msgq_amr_status, &message_amr_status, K_NO_WAIT) == 0) {
-                is_emergency_stop_at_amr = message_amr_status.is_emergency_stop   ||
-                                           can_controller::get_emergency_switch() ||
-					   can_controller::get_bumper_switch();
-            } else {
-                is_emergency_stop_at_amr = true;
-            }
+        msg_amr_status message_amr_status;
+        if (k_msgq_get(&msgq_amr_status, &message_amr_status, K_NO_WAIT) == 0) {
+            is_emergency_stop_at_amr = message_amr_status.is_emergency_stop   ||
+                                       can_controller::get_emergency_switch() ||
+                                       can_controller::get_bumper_switch();
+        } else {
+            is_emergency_stop_at_amr = true;
+        }
 
-            if (device_is_ready(gpioc)) {
-                if (is_emergency_stop_at_amr) {
-                    gpio_pin_set(gpioc, 5, 0);
-                } else {
-                    gpio_pin_set(gpioc, 5, 1);
-                }
+        if (device_is_ready(gpioc)) {
+            if (is_emergency_stop_at_amr) {
+                gpio_pin_set(gpioc, 5, 0);
+            } else {
+                gpio_pin_set(gpioc, 5, 1);
             }
+        }
 #else
-            msg_connected_robot_status message_connected_robot_status;
-            message_connected_robot_status.is_emergency_stop = false;
-            while (k_msgq_put(&msgq_connected_robot_status, &message_connected_robot_status, K_NO_WAIT) != 0) {
-                k_msgq_purge(&msgq_connected_robot_status);
-            }
-            msg_can_interlock message_can_interlock;
-            message_can_interlock.is_emergency_stop = false;
-            while (k_msgq_put(&msgq_can_interlock, &message_can_interlock, K_NO_WAIT) != 0) {
-                k_msgq_purge(&msgq_can_interlock);
-            }
-#endif  // ENABLE_INTERLOCK
-
-            k_msleep(200);
+        msg_connected_robot_status message_connected_robot_status;
+        message_connected_robot_status.is_emergency_stop = false;
+        while (k_msgq_put(&msgq_connected_robot_status, &message_connected_robot_status, K_NO_WAIT) != 0) {
+            k_msgq_purge(&msgq_connected_robot_status);
         }
+        msg_can_interlock message_can_interlock;
+        message_can_interlock.is_emergency_stop = false;
+        while (k_msgq_put(&msgq_can_interlock, &message_can_interlock, K_NO_WAIT) != 0) {
+            k_msgq_purge(&msgq_can_interlock);
+        }
+#endif  // ENABLE_INTERLOCK
     }
 private:
+    static void interlock_isr(const device *dev, gpio_callback *cb, gpio_port_pins_t pins) {
+        emergency::set(emergency::INTERLOCK, gpio_pin_get(dev, 4) == 0);
+    }
+    gpio_callback callback;
+    const device *gpioc{nullptr};
     bool is_emergency_stop_at_amr;
     bool is_emergency_stop_at_connected_robot;
 } impl;
@@ -111,12 +119,11 @@ void init()
     impl.init();
 }
 
-void run(void *p1, void *p2, void *p3)
+void poll()
 {
-    impl.run();
+    impl.poll();
 }
 
-k_thread thread;
 k_msgq msgq_amr_status;
 k_msgq msgq_connected_robot_status;
 k_msgq msgq_can_interlock;
@@ -42,8 +42,7 @@ struct msg_can_interlock {
 } __attribute__((aligned(4)));
 
 void init();
-void run(void *p1, void *p2, void *p3);
-extern k_thread thread;
+void poll();
 extern k_msgq msgq_connected_robot_status;
 extern k_msgq msgq_amr_status;
 extern k_msgq msgq_can_interlock;
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <shell/shell.h>
+#include "isr_timing.hpp"
+#include "tcm.hpp"
+
+namespace lexxhard::isr_timing {
+
+const char *const names[ISR_NUM]{
+    "rosserial_uart",
+    "pgv_uart",
+    "can_rx",
+};
+
+uint32_t to_ns(uint64_t cycles)
+{
+    return static_cast<uint32_t>(cycles * 1000000000ULL / sys_clock_hw_cycles_per_sec());
+}
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    shell_print(shell, "%-16s %10s %8s %8s %8s %8s", "isr", "count", "min[ns]", "avg[ns]", "max[ns]", "jitter");
+    for (int i{0}; i < ISR_NUM; ++i) {
+        unsigned int key{irq_lock()};
+        stats s{table[i]};
+        irq_unlock(key);
+        if (s.count == 0) {
+            shell_print(shell, "%-16s %10u", names[i], 0);
+            continue;
+        }
+        shell_print(shell, "%-16s %10u %8u %8u %8u %8u", names[i], s.count,
+                    to_ns(s.min), to_ns(s.sum / s.count), to_ns(s.max), to_ns(s.max - s.min));
+    }
+    return 0;
+}
+
+int reset(const shell *shell, size_t argc, char **argv)
+{
+    unsigned int key{irq_lock()};
+    for (auto &s: table)
+        s = stats{};
+    irq_unlock(key);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "ISR execution time", info),
+    SHELL_CMD(reset, NULL, "Reset ISR statistics", reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(isr, &sub, "ISR timing commands", NULL);
+
+void init()
+{
+#ifdef CONFIG_CPU_CORTEX_M
+    CoreDebug->DEMCR = CoreDebug->DEMCR | CoreDebug_DEMCR_TRCENA_Msk;
+    // The Cortex-M7 DWT ignores writes until it is unlocked.
+    DWT->LAR = 0xc5acce55;
+    DWT->CYCCNT = 0;
+    DWT->CTRL = DWT->CTRL | DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+TCM_BSS stats table[ISR_NUM];
+
+}
+
+// vim: set expandtab shiftwidth=4:
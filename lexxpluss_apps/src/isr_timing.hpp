@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+// Cycle accurate execution time of the hot ISRs, taken from the DWT cycle
+// counter so that the measurement itself costs only two register reads.
+// The simulated board has no DWT and uses the kernel cycle counter.
+
+namespace lexxhard::isr_timing {
+
+enum {
+    ROSSERIAL_UART = 0,
+    PGV_UART,
+    CAN_RX,
+    ISR_NUM
+};
+
+struct stats {
+    uint32_t count, min, max;
+    uint64_t sum;
+};
+
+extern stats table[ISR_NUM];
+
+inline uint32_t cycle()
+{
+#ifdef CONFIG_CPU_CORTEX_M
+    return DWT->CYCCNT;
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+inline uint32_t begin()
+{
+    return cycle();
+}
+
+inline void end(int id, uint32_t begin_cycle)
+{
+    uint32_t cycles{cycle() - begin_cycle};
+    stats &s{table[id]};
+    if (s.count == 0 || cycles < s.min)
+        s.min = cycles;
+    if (cycles > s.max)
+        s.max = cycles;
+    s.sum += cycles;
+    ++s.count;
+}
+
+void init();
+
+}
+
+// vim: set expandtab shiftwidth=4:
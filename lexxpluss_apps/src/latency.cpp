@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include "latency.hpp"
+
+namespace lexxhard::latency {
+
+LOG_MODULE_REGISTER(latency);
+
+// Two buckets per power of two of microseconds, about 41% resolution.
+class histogram {
+public:
+    void add(uint32_t us) {
+        if (count == 0 || min > us)
+            min = us;
+        if (max < us)
+            max = us;
+        ++count;
+        ++bucket[index(us)];
+    }
+    void reset() {
+        count = min = max = 0;
+        for (auto &i: bucket)
+            i = 0;
+    }
+    void get(summary &s) const {
+        s.count = count;
+        s.min_us = min;
+        s.max_us = max;
+        s.p50_us = percentile(50);
+        s.p99_us = percentile(99);
+    }
+private:
+    static int index(uint32_t us) {
+        if (us < 2)
+            return us;
+        int msb{31 - __builtin_clz(us)};
+        return msb * 2 + ((us >> (msb - 1)) & 1);
+    }
+    static uint32_t upper(int index) {
+        if (index < 2)
+            return index;
+        int msb{index / 2};
+        uint32_t base{1U << msb};
+        return (index & 1) ? (base << 1) - 1 : base + (base >> 1) - 1;
+    }
+    uint32_t percentile(uint32_t p) const {
+        if (count == 0)
+            return 0;
+        uint32_t target{(count * p + 99) / 100}, sum{0};
+        for (int i{0}; i < BUCKET_NUM; ++i) {
+            sum += bucket[i];
+            if (sum >= target) {
+                uint32_t value{upper(i)};
+                return value > max ? max : value < min ? min : value;
+            }
+        }
+        return max;
+    }
+    static constexpr int BUCKET_NUM{64};
+    uint32_t bucket[BUCKET_NUM]{0};
+    uint32_t count{0}, min{0}, max{0};
+};
+
+class latency_impl {
+public:
+    void record(int path, int hop, uint32_t stamp_cycle) {
+        hist[path][hop].add(k_cyc_to_us_floor32(k_cycle_get_32() - stamp_cycle));
+    }
+    void tx_mark(int path, uint32_t stamp_cycle) {
+        marker &m{markers[path]};
+        m.stamp_cycle = stamp_cycle;
+        m.position = written;
+        m.armed = true;
+    }
+    void tx_written(uint32_t bytes) {
+        written += bytes;
+    }
+    void tx_drained(uint32_t bytes) {
+        drained += bytes;
+        for (int i{0}; i < PATH_NUM; ++i) {
+            marker &m{markers[i]};
+            if (m.armed && static_cast<int32_t>(drained - m.position) >= 0) {
+                m.armed = false;
+                record(i, HOP_TX_DRAIN, m.stamp_cycle);
+            }
+        }
+    }
+    bool get_summary(int path, int hop, summary &s) const {
+        hist[path][hop].get(s);
+        return s.count > 0;
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "%-6s %-9s %8s %8s %8s %8s %8s",
+                    "path", "hop", "count", "min", "p50", "p99", "max");
+        for (int i{0}; i < PATH_NUM; ++i) {
+            for (int j{0}; j < HOP_NUM; ++j) {
+                if (summary s; get_summary(i, j, s)) {
+                    shell_print(shell, "%-6s %-9s %8u %8u %8u %8u %8u",
+                                path_name[i], hop_name[j],
+                                s.count, s.min_us, s.p50_us, s.p99_us, s.max_us);
+                }
+            }
+        }
+    }
+    void reset() {
+        for (auto &i: hist) {
+            for (auto &j: i)
+                j.reset();
+        }
+    }
+    static constexpr const char *path_name[PATH_NUM]{"board", "imu"};
+    static constexpr const char *hop_name[HOP_NUM]{
+        "rx_queue", "handler", "queue", "poll", "publish", "tx_drain"
+    };
+private:
+    struct marker {
+        uint32_t stamp_cycle{0}, position{0};
+        bool armed{false};
+    } markers[PATH_NUM];
+    histogram hist[PATH_NUM][HOP_NUM];
+    uint32_t written{0}, drained{0};
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int reset(const shell *shell, size_t argc, char **argv)
+{
+    impl.reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Latency histograms (us)", info),
+    SHELL_CMD(reset, NULL, "Reset latency histograms", reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(latency, &sub, "Latency commands", NULL);
+
+void record(int path, int hop, uint32_t stamp_cycle)
+{
+    impl.record(path, hop, stamp_cycle);
+}
+
+void tx_mark(int path, uint32_t stamp_cycle)
+{
+    impl.tx_mark(path, stamp_cycle);
+}
+
+void tx_written(uint32_t bytes)
+{
+    impl.tx_written(bytes);
+}
+
+void tx_drained(uint32_t bytes)
+{
+    impl.tx_drained(bytes);
+}
+
+bool get_summary(int path, int hop, summary &s)
+{
+    return impl.get_summary(path, hop, s);
+}
+
+const char *get_path_name(int path)
+{
+    return latency_impl::path_name[path];
+}
+
+const char *get_hop_name(int hop)
+{
+    return latency_impl::hop_name[hop];
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
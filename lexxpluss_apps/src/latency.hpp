@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::latency {
+
+enum {
+    PATH_BOARD = 0,
+    PATH_IMU,
+    PATH_NUM
+};
+
+enum {
+    HOP_RX_QUEUE = 0,
+    HOP_HANDLER,
+    HOP_QUEUE,
+    HOP_POLL,
+    HOP_PUBLISH,
+    HOP_TX_DRAIN,
+    HOP_NUM
+};
+
+struct summary {
+    uint32_t count, min_us, p50_us, p99_us, max_us;
+};
+
+// Latency of a hop measured from the cycle stamp taken at the path origin.
+void record(int path, int hop, uint32_t stamp_cycle);
+// Arm a TX drain measurement for the bytes published so far.
+void tx_mark(int path, uint32_t stamp_cycle);
+void tx_written(uint32_t bytes);
+void tx_drained(uint32_t bytes);
+bool get_summary(int path, int hop, summary &s);
+const char *get_path_name(int path);
+const char *get_hop_name(int hop);
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -31,7 +31,14 @@
 #include <algorithm>
 #include <cstdlib>
 #include "can_controller.hpp"
+#include "config.hpp"
+#include "diagnostics.hpp"
+#include "emergency.hpp"
 #include "led_controller.hpp"
+#include "led_pattern.hpp"
+#include "periodic.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::led_controller {
 
@@ -47,7 +54,7 @@ public:
     }
     bool get_message(msg &output) {
         bool updated{false};
-        if (msg message_new; k_msgq_get(&msgq, &message_new, K_MSEC(DELAY_MS)) == 0) {
+        if (msg message_new; k_msgq_get(&msgq, &message_new, K_NO_WAIT) == 0) {
             if (message.interrupt_ms > 0) {
                 if (message_new.interrupt_ms == 0) {
                     message_interrupted = message_new;
@@ -75,7 +82,6 @@ public:
         output = message;
         return updated;
     }
-    static constexpr uint32_t DELAY_MS{25};
 private:
     bool is_new_message(const msg &message_new) const {
         if (message_new.pattern != message.pattern)
@@ -106,76 +112,40 @@ public:
         if (!device_is_ready(dev[LED_LEFT]) || !device_is_ready(dev[LED_RIGHT]) ||
             !device_is_ready(dev[2]) || !device_is_ready(dev[3]))
             return -1;
-        fill(black);
+        pattern.fill(led_pattern<PIXELS>::black);
         update();
         return 0;
     }
     void run() {
         if (!device_is_ready(dev[LED_LEFT]) || !device_is_ready(dev[LED_RIGHT]) ||
-            !device_is_ready(dev[2]) || !device_is_ready(dev[3]))
+            !device_is_ready(dev[2]) || !device_is_ready(dev[3])) {
+            diagnostics::report(diagnostics::LED, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
+        watchdog_supervisor::declare(watchdog_supervisor::LED_CONTROLLER, "led_controller", 200, false);
+        periodic::start(periodic::LED_CONTROLLER);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::LED_CONTROLLER);
             msg message;
             if (rec.get_message(message))
-                counter = 0;
+                pattern.restart();
+            TRACE_BEGIN(LED_CONTROLLER);
             poll(message);
+            TRACE_END(LED_CONTROLLER);
+            periodic::wait(periodic::LED_CONTROLLER);
         }
     }
 private:
     void poll(const msg &message) {
-        switch (message.pattern) {
-        default:
-        case msg::NONE:            fill(black); break;
-        case msg::EMERGENCY_STOP:  fill_strobe(emergency_stop, 10, 50, 1000); break;
-        case msg::AMR_MODE:        fill(amr_mode); break;
-        case msg::AGV_MODE:        fill(agv_mode); break;
-        case msg::MISSION_PAUSE:   fill(mission_pause); break;
-        case msg::PATH_BLOCKED:    fill(path_blocked); break;
-        case msg::MANUAL_DRIVE:    fill(manual_drive); break;
-        case msg::CHARGING:        fill_rainbow(); break;
-        case msg::WAITING_FOR_JOB: fill_fade(waiting_for_job, 9); break;
-        case msg::LEFT_WINKER:     fill_blink_sequence(sequence, LED_LEFT); break;
-        case msg::RIGHT_WINKER:    fill_blink_sequence(sequence, LED_RIGHT); break;
-        case msg::BOTH_WINKER:     fill_blink_sequence(sequence, LED_BOTH); break;
-        case msg::MOVE_ACTUATOR:   fill_strobe(move_actuator, 10, 200, 200); break;
-        case msg::CHARGE_LEVEL:    fill_charge_level(); break;
-        case msg::SHOWTIME:        fill_knight_industries_two_thousand(); break;
-        case msg::LOCKDOWN:        fill_strobe(lockdown, 10, 200, 0); break;
-        case msg::RGB:             fill(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}); break;
-        case msg::RGB_BLINK:       fill_blink(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}, message.cpm); break;
-        case msg::RGB_BREATH:      fill_fade(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}, message.cpm);break;
-        }
-        clamp();
+        pattern.render(message, can_controller::get_rsoc(),
+                       static_cast<uint32_t>(config::get_int(config::LED_CLAMP_THRESHOLD)));
         update();
-        ++counter;
-    }
-    led_rgb clamp_rgb(led_rgb rgb) const {
-        auto const max_channel_value{std::max({rgb.r, rgb.g, rgb.b})};
-        auto const acc_channel_value(static_cast<float>(rgb.r) + static_cast<float>(rgb.g) + static_cast<float>(rgb.b));
-
-        auto const channel_wise_ratio{static_cast<float>(clamp_threshold) / max_channel_value};
-        auto const agg_ratio{3 * static_cast<float>(clamp_threshold) / acc_channel_value};
-        auto const clamp_ratio = std::min(channel_wise_ratio, agg_ratio);
-        if (1.0f <= clamp_ratio) {
-            return rgb;
-        }
-
-        return led_rgb{
-            .r=static_cast<uint8_t>(clamp_ratio * rgb.r + 0.5f),
-            .g=static_cast<uint8_t>(clamp_ratio * rgb.g + 0.5f),
-            .b=static_cast<uint8_t>(clamp_ratio * rgb.b + 0.5f)
-        };
-    }
-    void clamp() {
-        for (uint32_t i{0}; i < PIXELS; ++i) {
-            pixeldata[LED_LEFT][i] = clamp_rgb(pixeldata[LED_LEFT][i]);
-            pixeldata[LED_RIGHT][i] = clamp_rgb(pixeldata[LED_RIGHT][i]);
-        }
     }
     void update() {
+        auto &pixeldata{pattern.pixeldata};
         std::copy(&pixeldata[LED_LEFT][0],  &pixeldata[LED_LEFT][PIXELS_BACK],  &pixeldata_back[LED_LEFT][0]);
         std::copy(&pixeldata[LED_RIGHT][0], &pixeldata[LED_RIGHT][PIXELS_BACK], &pixeldata_back[LED_RIGHT][0]);
-        if (can_controller::is_emergency()) {
+        if (emergency::is_active()) {
             static uint32_t blink_counter{0};
             ++blink_counter;
             if (blink_counter < 20) {
@@ -191,193 +161,14 @@ private:
         led_strip_update_rgb(dev[2], pixeldata_back[LED_LEFT], PIXELS_BACK);
         led_strip_update_rgb(dev[3], pixeldata_back[LED_RIGHT], PIXELS_BACK);
     }
-    void fill(const led_rgb &color, uint32_t select = LED_BOTH) {
-        if (select == LED_BOTH) {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = color;
-        } else {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[select][i] = color;
-        }
-    }
-    void fill_strobe(const led_rgb &color, uint32_t nstrobe, uint32_t strobedelay, uint32_t endpause) {
-        static constexpr auto delay{led_message_receiver::DELAY_MS};
-        if (counter < nstrobe * strobedelay / delay) {
-            if ((counter % (strobedelay * 2 / delay)) == 0)
-                fill(color);
-            else if ((counter % (strobedelay * 2 / delay)) == strobedelay / delay)
-                fill(black);
-        } else if (counter == (nstrobe * strobedelay + endpause) / delay) {
-            fill(black);
-            counter = 0;
-        }
-    }
-    void fill_rainbow(uint32_t select = LED_BOTH) {
-        if (counter % 3 == 0)
-            return;
-        if (counter > 256 * 3)
-            counter = 0;
-        if (select == LED_BOTH) {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = wheel(((i * 256 / PIXELS) + counter / 3) & 255);
-        } else {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[select][i] = wheel(((i * 256 / PIXELS) + counter / 3) & 255);
-        }
-    }
-    void fill_fade(const led_rgb &color, uint32_t count_per_min) {
-        uint32_t hz{1000 / led_message_receiver::DELAY_MS};
-        uint32_t thres{60 * hz / count_per_min};
-        if (counter >= thres)
-            counter = 0;
-        int percent;
-        if (counter < thres / 2)
-            percent = counter * 100 / (thres / 2);
-        else
-            percent = (thres - counter) * 100 / (thres / 2);
-        fill(fader(color, percent));
-    }
-    void fill_blink(const led_rgb &color, int count_per_min) {
-        uint32_t hz{1000 / led_message_receiver::DELAY_MS};
-        uint32_t thres{60 * hz / count_per_min};
-        if (counter >= thres)
-            counter = 0;
-        fill(counter < thres / 2 ? color : black);
-    }
-    void fill_blink_sequence(const led_rgb &color, uint32_t select = LED_BOTH) {
-        uint32_t n{0};
-        if (counter >= 8 && counter < 25) {
-            n = (counter - 8) * 6;
-            if (n > PIXELS)
-                n = PIXELS;
-        }
-        if (select == LED_BOTH) {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = i < n ? color : black;
-        } else {
-            for (uint32_t i{0}; i < PIXELS; ++i)
-                pixeldata[select][i] = i < n ? color : black;
-            fill(black, select == LED_LEFT ? LED_RIGHT : LED_LEFT);
-        }
-        if (counter > 25)
-            counter = 0;
-    }
-    void fill_toggle(const led_rgb &color) {
-        static constexpr uint32_t thres{5};
-        if (counter >= thres * 2)
-            counter = 0;
-        led_rgb c0, c1;
-        if (counter < thres)
-            c0 = color, c1 = black;
-        else
-            c0 = black, c1 = color;
-        for (uint32_t i{0}; i < PIXELS; ++i) {
-            if (i % 2 == 0)
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = c0;
-            else
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = c1;
-        }
-    }
-    void fill_charge_level() {
-        static constexpr uint32_t thres{40};
-        if (counter >= thres * 2)
-            counter = 0;
-        uint32_t head;
-        if (counter >= thres)
-            head = 0;
-        else
-            head = PIXELS - (PIXELS * counter / thres);
-        static constexpr led_rgb color{.r{0xff}, .g{0x20}, .b{0x00}};
-        uint32_t rsoc{can_controller::get_rsoc()};
-        uint32_t n;
-        if (rsoc < 100) {
-            n = PIXELS - (PIXELS * rsoc / 100U);
-            if (n < head)
-                n = head;
-        } else {
-            n = head;
-        }
-        for (uint32_t i{0}; i < PIXELS; ++i)
-            pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = i < n ? black : color;
-    }
-    void fill_knight_industries_two_thousand() {
-        static constexpr int32_t width{20};
-        if (counter >= (PIXELS + width) * 2)
-            counter = 0;
-        bool back{counter >= PIXELS + width};
-        int32_t pos;
-        if (back)
-            pos = (PIXELS + width) * 2 - counter - width;
-        else
-            pos = counter;
-        for (int32_t i{0}, end{PIXELS}; i < end; ++i) {
-            bool no_color;
-            if (back)
-                no_color = i < pos || i > pos + width;
-            else
-                no_color = i < pos - width || i > pos;
-            if (no_color) {
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = black;
-            } else {
-                static constexpr led_rgb color{.r{0x00}, .g{0x80}, .b{0x20}};
-                int gain{(width - abs(pos - i)) * 100 / width};
-                gain = gain * gain * gain / 100 / 100;
-                led_rgb dimmed{fader(color, gain)};
-                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = dimmed;
-            }
-        }
-    }
-    led_rgb fader(const led_rgb &color, int percent) const {
-        led_rgb color_;
-        color_.r = color.r * percent / 100;
-        color_.g = color.g * percent / 100;
-        color_.b = color.b * percent / 100;
-        return color_;
-    }
-    led_rgb wheel(uint32_t wheelpos) const {
-        static constexpr uint32_t thres{256 / 3};
-        led_rgb color;
-        if (wheelpos < thres) {
-            color.r = wheelpos * 3;
-            color.g = 255 - wheelpos * 3;
-            color.b = 0;
-        } else if (wheelpos < thres * 2) {
-            wheelpos -= thres;
-            color.r = 255 - wheelpos * 3;
-            color.g = 0;
-            color.b = wheelpos * 3;
-        } else {
-            wheelpos -= thres * 2;
-            color.r = 0;
-            color.g = wheelpos * 3;
-            color.b = 255 - wheelpos * 3;
-        }
-        return color;
-    }
     led_message_receiver rec;
     static constexpr uint32_t PIXELS{DT_PROP(DT_NODELABEL(led_strip0), chain_length)};
     static constexpr uint32_t PIXELS_BACK{DT_PROP(DT_NODELABEL(led_strip2), chain_length)};
-    static constexpr uint32_t LED_LEFT{0}, LED_RIGHT{1}, LED_BOTH{2};
+    static constexpr uint32_t LED_LEFT{led_pattern<PIXELS>::LED_LEFT}, LED_RIGHT{led_pattern<PIXELS>::LED_RIGHT};
     const device *dev[4]{nullptr, nullptr, nullptr, nullptr};
-    led_rgb pixeldata[2][PIXELS], pixeldata_back[2][PIXELS_BACK];
-    uint32_t counter{0};
-    static constexpr uint8_t clamp_threshold{0x80};
-    static const led_rgb emergency_stop, amr_mode, agv_mode, mission_pause, path_blocked, manual_drive;
-    static const led_rgb dock_mode, waiting_for_job, orange, sequence, move_actuator, lockdown, black;
+    led_pattern<PIXELS> pattern;
+    led_rgb pixeldata_back[2][PIXELS_BACK];
 } impl;
-const led_rgb led_controller_impl::emergency_stop {.r{0x80}, .g{0x00}, .b{0x00}};
-const led_rgb led_controller_impl::amr_mode       {.r{0x00}, .g{0x80}, .b{0x80}};
-const led_rgb led_controller_impl::agv_mode       {.r{0x45}, .g{0xff}, .b{0x00}};
-const led_rgb led_controller_impl::mission_pause  {.r{0xff}, .g{0xff}, .b{0x00}};
-const led_rgb led_controller_impl::path_blocked   {.r{0xe6}, .g{0x08}, .b{0xff}};
-const led_rgb led_controller_impl::manual_drive   {.r{0xfe}, .g{0xf4}, .b{0xff}};
-const led_rgb led_controller_impl::dock_mode      {.r{0x00}, .g{0x00}, .b{0xff}};
-const led_rgb led_controller_impl::waiting_for_job{.r{0xff}, .g{0xff}, .b{0x00}};
-const led_rgb led_controller_impl::orange         {.r{0xff}, .g{0xa5}, .b{0x00}};
-const led_rgb led_controller_impl::sequence       {.r{0x90}, .g{0x20}, .b{0x00}};
-const led_rgb led_controller_impl::move_actuator  {.r{0x45}, .g{0xff}, .b{0x00}};
-const led_rgb led_controller_impl::lockdown       {.r{0x00}, .g{0x00}, .b{0x80}};
-const led_rgb led_controller_impl::black          {.r{0x00}, .g{0x00}, .b{0x00}};
 
 int pattern(const shell *shell, size_t argc, char **argv)
 {
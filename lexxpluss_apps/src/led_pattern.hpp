@@ -0,0 +1,278 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <drivers/led_strip.h>
+#include <algorithm>
+#include <cstdlib>
+#include "led_controller.hpp"
+
+namespace lexxhard::led_controller {
+
+// Animation of the two side strips, PIXELS long each.  Pure rendering into
+// pixeldata; the controller owns the devices and the back strips.
+template <uint32_t PIXELS>
+class led_pattern {
+public:
+    // Renders one frame of message, called every DELAY_MS.
+    void render(const msg &message, uint32_t rsoc, uint32_t clamp_threshold) {
+        switch (message.pattern) {
+        default:
+        case msg::NONE:            fill(black); break;
+        case msg::EMERGENCY_STOP:  fill_strobe(emergency_stop, 10, 50, 1000); break;
+        case msg::AMR_MODE:        fill(amr_mode); break;
+        case msg::AGV_MODE:        fill(agv_mode); break;
+        case msg::MISSION_PAUSE:   fill(mission_pause); break;
+        case msg::PATH_BLOCKED:    fill(path_blocked); break;
+        case msg::MANUAL_DRIVE:    fill(manual_drive); break;
+        case msg::CHARGING:        fill_rainbow(); break;
+        case msg::WAITING_FOR_JOB: fill_fade(waiting_for_job, 9); break;
+        case msg::LEFT_WINKER:     fill_blink_sequence(sequence, LED_LEFT); break;
+        case msg::RIGHT_WINKER:    fill_blink_sequence(sequence, LED_RIGHT); break;
+        case msg::BOTH_WINKER:     fill_blink_sequence(sequence, LED_BOTH); break;
+        case msg::MOVE_ACTUATOR:   fill_strobe(move_actuator, 10, 200, 200); break;
+        case msg::CHARGE_LEVEL:    fill_charge_level(rsoc); break;
+        case msg::SHOWTIME:        fill_knight_industries_two_thousand(); break;
+        case msg::LOCKDOWN:        fill_strobe(lockdown, 10, 200, 0); break;
+        case msg::RGB:             fill(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}); break;
+        case msg::RGB_BLINK:       fill_blink(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}, message.cpm); break;
+        case msg::RGB_BREATH:      fill_fade(led_rgb{.r{message.rgb[0]}, .g{message.rgb[1]}, .b{message.rgb[2]}}, message.cpm);break;
+        }
+        clamp(clamp_threshold);
+        ++counter;
+    }
+    void restart() {
+        counter = 0;
+    }
+    void fill(const led_rgb &color, uint32_t select = LED_BOTH) {
+        if (select == LED_BOTH) {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = color;
+        } else {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[select][i] = color;
+        }
+    }
+    static led_rgb clamp_rgb(led_rgb rgb, uint32_t clamp_threshold) {
+        // The aggregate ratio 3 * threshold / (r + g + b) is never below the
+        // channel-wise ratio threshold / max, so scale by threshold / max.
+        uint32_t const max_channel_value{std::max({rgb.r, rgb.g, rgb.b})};
+        if (max_channel_value <= clamp_threshold) {
+            return rgb;
+        }
+
+        auto const scale = [max_channel_value, clamp_threshold](uint8_t value) {
+            return static_cast<uint8_t>((value * clamp_threshold * 2 + max_channel_value) / (max_channel_value * 2));
+        };
+        return led_rgb{
+            .r=scale(rgb.r),
+            .g=scale(rgb.g),
+            .b=scale(rgb.b)
+        };
+    }
+    void clamp(uint32_t threshold) {
+        for (uint32_t i{0}; i < PIXELS; ++i) {
+            pixeldata[LED_LEFT][i] = clamp_rgb(pixeldata[LED_LEFT][i], threshold);
+            pixeldata[LED_RIGHT][i] = clamp_rgb(pixeldata[LED_RIGHT][i], threshold);
+        }
+    }
+    static constexpr uint32_t DELAY_MS{25};
+    static constexpr uint32_t LED_LEFT{0}, LED_RIGHT{1}, LED_BOTH{2};
+    static constexpr led_rgb black          {.r{0x00}, .g{0x00}, .b{0x00}};
+    led_rgb pixeldata[2][PIXELS];
+private:
+    void fill_strobe(const led_rgb &color, uint32_t nstrobe, uint32_t strobedelay, uint32_t endpause) {
+        static constexpr auto delay{DELAY_MS};
+        if (counter < nstrobe * strobedelay / delay) {
+            if ((counter % (strobedelay * 2 / delay)) == 0)
+                fill(color);
+            else if ((counter % (strobedelay * 2 / delay)) == strobedelay / delay)
+                fill(black);
+        } else if (counter == (nstrobe * strobedelay + endpause) / delay) {
+            fill(black);
+            counter = 0;
+        }
+    }
+    void fill_rainbow(uint32_t select = LED_BOTH) {
+        if (counter % 3 == 0)
+            return;
+        if (counter > 256 * 3)
+            counter = 0;
+        if (select == LED_BOTH) {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = wheel(((i * 256 / PIXELS) + counter / 3) & 255);
+        } else {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[select][i] = wheel(((i * 256 / PIXELS) + counter / 3) & 255);
+        }
+    }
+    void fill_fade(const led_rgb &color, uint32_t count_per_min) {
+        uint32_t hz{1000 / DELAY_MS};
+        uint32_t thres{60 * hz / count_per_min};
+        if (counter >= thres)
+            counter = 0;
+        int percent;
+        if (counter < thres / 2)
+            percent = counter * 100 / (thres / 2);
+        else
+            percent = (thres - counter) * 100 / (thres / 2);
+        fill(fader(color, percent));
+    }
+    void fill_blink(const led_rgb &color, int count_per_min) {
+        uint32_t hz{1000 / DELAY_MS};
+        uint32_t thres{60 * hz / count_per_min};
+        if (counter >= thres)
+            counter = 0;
+        fill(counter < thres / 2 ? color : black);
+    }
+    void fill_blink_sequence(const led_rgb &color, uint32_t select = LED_BOTH) {
+        uint32_t n{0};
+        if (counter >= 8 && counter < 25) {
+            n = (counter - 8) * 6;
+            if (n > PIXELS)
+                n = PIXELS;
+        }
+        if (select == LED_BOTH) {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = i < n ? color : black;
+        } else {
+            for (uint32_t i{0}; i < PIXELS; ++i)
+                pixeldata[select][i] = i < n ? color : black;
+            fill(black, select == LED_LEFT ? LED_RIGHT : LED_LEFT);
+        }
+        if (counter > 25)
+            counter = 0;
+    }
+    void fill_toggle(const led_rgb &color) {
+        static constexpr uint32_t thres{5};
+        if (counter >= thres * 2)
+            counter = 0;
+        led_rgb c0, c1;
+        if (counter < thres)
+            c0 = color, c1 = black;
+        else
+            c0 = black, c1 = color;
+        for (uint32_t i{0}; i < PIXELS; ++i) {
+            if (i % 2 == 0)
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = c0;
+            else
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = c1;
+        }
+    }
+    void fill_charge_level(uint32_t rsoc) {
+        static constexpr uint32_t thres{40};
+        if (counter >= thres * 2)
+            counter = 0;
+        uint32_t head;
+        if (counter >= thres)
+            head = 0;
+        else
+            head = PIXELS - (PIXELS * counter / thres);
+        static constexpr led_rgb color{.r{0xff}, .g{0x20}, .b{0x00}};
+        uint32_t n;
+        if (rsoc < 100) {
+            n = PIXELS - (PIXELS * rsoc / 100U);
+            if (n < head)
+                n = head;
+        } else {
+            n = head;
+        }
+        for (uint32_t i{0}; i < PIXELS; ++i)
+            pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = i < n ? black : color;
+    }
+    void fill_knight_industries_two_thousand() {
+        static constexpr int32_t width{20};
+        if (counter >= (PIXELS + width) * 2)
+            counter = 0;
+        bool back{counter >= PIXELS + width};
+        int32_t pos;
+        if (back)
+            pos = (PIXELS + width) * 2 - counter - width;
+        else
+            pos = counter;
+        for (int32_t i{0}, end{PIXELS}; i < end; ++i) {
+            bool no_color;
+            if (back)
+                no_color = i < pos || i > pos + width;
+            else
+                no_color = i < pos - width || i > pos;
+            if (no_color) {
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = black;
+            } else {
+                static constexpr led_rgb color{.r{0x00}, .g{0x80}, .b{0x20}};
+                int gain{(width - abs(pos - i)) * 100 / width};
+                gain = gain * gain * gain / 100 / 100;
+                led_rgb dimmed{fader(color, gain)};
+                pixeldata[LED_LEFT][i] = pixeldata[LED_RIGHT][i] = dimmed;
+            }
+        }
+    }
+    led_rgb fader(const led_rgb &color, int percent) const {
+        led_rgb color_;
+        color_.r = color.r * percent / 100;
+        color_.g = color.g * percent / 100;
+        color_.b = color.b * percent / 100;
+        return color_;
+    }
+    led_rgb wheel(uint32_t wheelpos) const {
+        static constexpr uint32_t thres{256 / 3};
+        led_rgb color;
+        if (wheelpos < thres) {
+            color.r = wheelpos * 3;
+            color.g = 255 - wheelpos * 3;
+            color.b = 0;
+        } else if (wheelpos < thres * 2) {
+            wheelpos -= thres;
+            color.r = 255 - wheelpos * 3;
+            color.g = 0;
+            color.b = wheelpos * 3;
+        } else {
+            wheelpos -= thres * 2;
+            color.r = 0;
+            color.g = wheelpos * 3;
+            color.b = 255 - wheelpos * 3;
+        }
+        return color;
+    }
+    uint32_t counter{0};
+    static constexpr led_rgb emergency_stop {.r{0x80}, .g{0x00}, .b{0x00}};
+    static constexpr led_rgb amr_mode       {.r{0x00}, .g{0x80}, .b{0x80}};
+    static constexpr led_rgb agv_mode       {.r{0x45}, .g{0xff}, .b{0x00}};
+    static constexpr led_rgb mission_pause  {.r{0xff}, .g{0xff}, .b{0x00}};
+    static constexpr led_rgb path_blocked   {.r{0xe6}, .g{0x08}, .b{0xff}};
+    static constexpr led_rgb manual_drive   {.r{0xfe}, .g{0xf4}, .b{0xff}};
+    static constexpr led_rgb dock_mode      {.r{0x00}, .g{0x00}, .b{0xff}};
+    static constexpr led_rgb waiting_for_job{.r{0xff}, .g{0xff}, .b{0x00}};
+    static constexpr led_rgb orange         {.r{0xff}, .g{0xa5}, .b{0x00}};
+    static constexpr led_rgb sequence       {.r{0x90}, .g{0x20}, .b{0x00}};
+    static constexpr led_rgb move_actuator  {.r{0x45}, .g{0xff}, .b{0x00}};
+    static constexpr led_rgb lockdown       {.r{0x00}, .g{0x00}, .b{0x80}};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
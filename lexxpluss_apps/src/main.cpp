@@ -27,41 +27,78 @@
 #include <drivers/gpio.h>
 #include "actuator_controller.hpp"
 #include "adc_reader.hpp"
+#include "arena.hpp"
+#include "boot.hpp"
 #include "can_controller.hpp"
+#include "config.hpp"
+#include "emergency.hpp"
+#include "executor.hpp"
 #include "firmware_updater.hpp"
 #include "imu_controller.hpp"
 #include "interlock_controller.hpp"
+#include "isr_timing.hpp"
 #include "led_controller.hpp"
+#include "microbench.hpp"
 #include "misc_controller.hpp"
+#include "periodic.hpp"
 #include "pgv_controller.hpp"
 #include "rosserial.hpp"
 #include "rosserial_service.hpp"
 #include "runaway_detector.hpp"
+#include "sdlog_controller.hpp"
+#include "thread_monitor.hpp"
 #include "tof_controller.hpp"
 #include "uss_controller.hpp"
+#include "watchdog_supervisor.hpp"
 #include "towing_unit_controller.hpp"
 
 namespace {
 
-K_THREAD_STACK_DEFINE(actuator_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(adc_reader_stack, 2048);
-K_THREAD_STACK_DEFINE(can_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(firmware_updater_stack, 2048);
-K_THREAD_STACK_DEFINE(imu_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(interlock_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(led_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(misc_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(pgv_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(rosserial_stack, 2048);
-K_THREAD_STACK_DEFINE(rosserial_service_stack, 2048);
-K_THREAD_STACK_DEFINE(runaway_detector_stack, 2048);
-K_THREAD_STACK_DEFINE(tof_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(uss_controller_stack, 2048);
-K_THREAD_STACK_DEFINE(towing_unit_controller_stack, 2048);
-
-#define RUN(name, prio) \
+K_THREAD_STACK_DEFINE(actuator_controller_stack, CONFIG_LEXXHARD_ACTUATOR_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(adc_reader_stack, CONFIG_LEXXHARD_ADC_READER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(can_controller_stack, CONFIG_LEXXHARD_CAN_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(emergency_stack, CONFIG_LEXXHARD_EMERGENCY_STACK_SIZE);
+K_THREAD_STACK_DEFINE(executor_stack, CONFIG_LEXXHARD_EXECUTOR_STACK_SIZE);
+K_THREAD_STACK_DEFINE(firmware_updater_stack, CONFIG_LEXXHARD_FIRMWARE_UPDATER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(imu_controller_stack, CONFIG_LEXXHARD_IMU_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(led_controller_stack, CONFIG_LEXXHARD_LED_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(pgv_controller_stack, CONFIG_LEXXHARD_PGV_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(rosserial_stack, CONFIG_LEXXHARD_ROSSERIAL_STACK_SIZE);
+K_THREAD_STACK_DEFINE(rosserial_service_stack, CONFIG_LEXXHARD_ROSSERIAL_SERVICE_STACK_SIZE);
+K_THREAD_STACK_DEFINE(runaway_detector_stack, CONFIG_LEXXHARD_RUNAWAY_DETECTOR_STACK_SIZE);
+K_THREAD_STACK_DEFINE(sdlog_controller_stack, CONFIG_LEXXHARD_SDLOG_CONTROLLER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(thread_monitor_stack, CONFIG_LEXXHARD_THREAD_MONITOR_STACK_SIZE);
+K_THREAD_STACK_DEFINE(watchdog_supervisor_stack, CONFIG_LEXXHARD_WATCHDOG_SUPERVISOR_STACK_SIZE);
+
+// Each thread runs its own init(), then waits only for the subsystems listed in deps.
+// Only threads doing control math keep an FP context; the rest use integer math.
+#define RUN_WITH(name, init, id, prio, options, deps) \
+    static const lexxhard::boot::entry name##_entry{lexxhard::boot::id, #name, init, lexxhard::name::run, deps}; \
     k_thread_create(&lexxhard::name::thread, name##_stack, K_THREAD_STACK_SIZEOF(name##_stack), \
-                    lexxhard::name::run, nullptr, nullptr, nullptr, prio, K_FP_REGS, K_MSEC(2000));
+                    lexxhard::boot::runner, const_cast<lexxhard::boot::entry*>(&name##_entry), nullptr, nullptr, \
+                    prio, options, K_FOREVER); \
+    k_thread_name_set(&lexxhard::name::thread, #name); \
+    k_thread_start(&lexxhard::name::thread);
+
+#define RUN(name, id, prio, options, deps) RUN_WITH(name, lexxhard::name::init, id, prio, options, deps)
+
+#ifdef CONFIG_FPU_SHARING
+#define FP K_FP_REGS
+#else
+#define FP 0
+#endif
+#define NO_FP 0
+
+#define DEP(id) BIT(lexxhard::boot::id)
+
+// Periodic loops are ranked by period, everything else but the CAN
+// controller sits below them.
+#define RM(id) lexxhard::periodic::get_priority(lexxhard::periodic::id)
+#define BELOW_RM(n) (lexxhard::periodic::PRIORITY_END + (n))
+static_assert(BELOW_RM(5) < CONFIG_NUM_PREEMPT_PRIORITIES, "lowest thread beyond the preemptive priorities");
+
+#define ADD(name, period_key, prio) \
+    lexxhard::executor::add(#name, lexxhard::name::poll, lexxhard::config::period_key, prio);
 
 void reset_usb_hub()
 {
@@ -93,43 +130,18 @@ uint8_t get_board_setting()
     return brd_setting;
 }
 
-}
-
-void main()
+void init_executor()
 {
-    reset_usb_hub();
-    lexxhard::actuator_controller::init();
-    lexxhard::adc_reader::init();
-    lexxhard::can_controller::init();
-    lexxhard::firmware_updater::init();
-    lexxhard::imu_controller::init();
+    lexxhard::executor::init();
     lexxhard::interlock_controller::init();
-    lexxhard::led_controller::init();
     lexxhard::misc_controller::init();
-    lexxhard::pgv_controller::init();
-    lexxhard::rosserial::init();
-    lexxhard::rosserial_service::init();
-    lexxhard::runaway_detector::init();
     lexxhard::tof_controller::init();
     lexxhard::uss_controller::init();
-    
-    RUN(actuator_controller, 2);
-    RUN(adc_reader, 2);
-    RUN(can_controller, 4);
-    RUN(firmware_updater, 7);
-    RUN(imu_controller, 2);
-    RUN(interlock_controller, 5);
-    RUN(led_controller, 1);
-    RUN(misc_controller, 2);
-    RUN(pgv_controller, 1);
-    RUN(tof_controller, 2);
-    RUN(uss_controller, 2);
-    RUN(runaway_detector, 4);
 
     switch (get_board_setting()) {
         case 0: //Wani Unit
             lexxhard::towing_unit_controller::init();
-            RUN(towing_unit_controller, 2);
+            ADD(towing_unit_controller, TOWING_UNIT_PERIOD_MS, 2);
             break;
         case 1: //Reserved
             break;
@@ -139,8 +151,54 @@ void main()
             break;
     }
 
-    RUN(rosserial, 5); // The rosserial thread will be started last.
-    RUN(rosserial_service, 6); // The rosserial thread will be started last.
+    // Low-rate controllers share the executor thread instead of owning one each.
+    ADD(tof_controller, TOF_PERIOD_MS, 2);
+    ADD(misc_controller, MISC_PERIOD_MS, 2);
+    ADD(uss_controller, USS_PERIOD_MS, 2);
+    ADD(interlock_controller, INTERLOCK_PERIOD_MS, 5);
+}
+
+}
+
+void main()
+{
+    lexxhard::config::init();
+    lexxhard::boot::init();
+    lexxhard::isr_timing::init();
+    reset_usb_hub();
+
+    // Cooperative and above everything, a stop is never preempted by a thread.
+    RUN(emergency, EMERGENCY, K_PRIO_COOP(0), NO_FP, 0);
+    RUN(watchdog_supervisor, WATCHDOG_SUPERVISOR, 0, NO_FP, 0);
+    RUN(adc_reader, ADC_READER, RM(ADC_READER), NO_FP, 0);
+    RUN(runaway_detector, RUNAWAY_DETECTOR, RM(RUNAWAY_DETECTOR), FP, DEP(EMERGENCY));
+    RUN(led_controller, LED_CONTROLLER, RM(LED_CONTROLLER), NO_FP, 0);
+    RUN(pgv_controller, PGV_CONTROLLER, RM(PGV_CONTROLLER), NO_FP, 0);
+    RUN(firmware_updater, FIRMWARE_UPDATER, BELOW_RM(3), NO_FP, 0);
+    RUN(thread_monitor, THREAD_MONITOR, BELOW_RM(4), NO_FP, 0);
+    // Owns the SD card: the log and the saved config values.
+    RUN(sdlog_controller, SDLOG_CONTROLLER, BELOW_RM(5), NO_FP, 0);
+    RUN(imu_controller, IMU_CONTROLLER, RM(IMU_CONTROLLER), FP, DEP(RUNAWAY_DETECTOR));
+    RUN(actuator_controller, ACTUATOR_CONTROLLER, RM(ACTUATOR_CONTROLLER), FP, DEP(ADC_READER));
+    // tof, misc, uss, interlock and towing_unit
+    RUN_WITH(executor, init_executor, EXECUTOR, BELOW_RM(0), NO_FP, DEP(ADC_READER) | DEP(EMERGENCY));
+    // Above the LED, PGV and ADC loops: it carries the power board and BMU
+    // state and the emergency stop to the power board.
+    RUN(can_controller, CAN_CONTROLLER, lexxhard::periodic::get_service_priority(), FP,
+        DEP(LED_CONTROLLER) | DEP(EXECUTOR) | DEP(EMERGENCY));
+    RUN(rosserial_service, ROSSERIAL_SERVICE, BELOW_RM(2), FP, DEP(ACTUATOR_CONTROLLER));
+    // rosserial touches the message queues of every other subsystem.
+    RUN(rosserial, ROSSERIAL, BELOW_RM(1), FP,
+        BIT_MASK(lexxhard::boot::STAGE_NUM) & ~(DEP(ROSSERIAL) | DEP(ROSSERIAL_SERVICE)));
+
+    // Nothing may allocate once every subsystem has finished its init().
+    if (!lexxhard::boot::wait_ready(BIT_MASK(lexxhard::boot::STAGE_NUM), 10000))
+        printk("boot: not every stage finished init, sealing the arena anyway\n");
+    lexxhard::arena::seal();
+#ifdef CONFIG_LEXXHARD_BENCH_AUTORUN
+    lexxhard::microbench::run_all(nullptr, 1000);
+#endif
+
     const device *gpiog{device_get_binding("GPIOG")};
     if (gpiog != nullptr)
         gpio_pin_configure(gpiog, 7, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
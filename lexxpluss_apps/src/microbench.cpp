@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <devicetree.h>
+#include <shell/shell.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "adc_reader.hpp"
+#include "can_controller.hpp"
+#include "firmware_updater.hpp"
+#include "isr_timing.hpp"
+#include "led_pattern.hpp"
+#include "microbench.hpp"
+#include "pgv_controller.hpp"
+#include "position_control.hpp"
+#include "yaw_checker.hpp"
+#include "lexxauto_msgs/Battery.h"
+#include "lexxauto_msgs/BoardTemperatures.h"
+#include "lexxauto_msgs/Imu.h"
+#include "lexxauto_msgs/PositionGuideVision.h"
+#include "std_msgs/Float64MultiArray.h"
+#include "std_msgs/Int32MultiArray.h"
+#include "std_msgs/String.h"
+
+#ifdef CONFIG_LEXXHARD_BENCH
+
+namespace lexxhard::microbench {
+
+namespace {
+
+K_THREAD_STACK_DEFINE(bench_stack, CONFIG_LEXXHARD_BENCH_STACK_SIZE);
+
+void empty() {}
+
+}
+
+class microbench_impl {
+public:
+    int add(const char *name, function fn) {
+        if (count >= MAX_ENTRIES)
+            return -1;
+        entries[count++] = entry{name, fn};
+        return 0;
+    }
+    uint32_t size() const {return count;}
+    const char *get_name(uint32_t index) const {return entries[index].name;}
+    // The empty entry is measured first and its cost, the timing itself
+    // and the runner frames, is subtracted from every other entry.
+    void calibrate() {
+        overhead_cycles = overhead_stack = 0;
+        result r;
+        measure(empty, 1000, r);
+        overhead_cycles = r.min;
+        overhead_stack = r.stack_used;
+    }
+    void measure(uint32_t index, uint32_t samples, result &r) {
+        measure(entries[index].fn, samples, r);
+    }
+private:
+    struct entry {
+        const char *name;
+        function fn;
+    };
+    struct job {
+        function fn;
+        uint32_t samples;
+        uint32_t overhead_cycles;
+        result *r;
+    };
+    void measure(function fn, uint32_t samples, result &r) {
+        job j{fn, samples, overhead_cycles, &r};
+#ifdef CONFIG_FPU_SHARING
+        static constexpr uint32_t options{K_FP_REGS};
+#else
+        static constexpr uint32_t options{0};
+#endif
+        // A new thread repaints its stack, so the high-water mark below
+        // belongs to this entry alone.
+        k_thread_create(&thread, bench_stack, K_THREAD_STACK_SIZEOF(bench_stack),
+                        runner, &j, nullptr, nullptr, K_LOWEST_APPLICATION_THREAD_PRIO, options, K_NO_WAIT);
+        k_thread_name_set(&thread, "microbench");
+        k_thread_join(&thread, K_FOREVER);
+        size_t unused{0};
+        k_thread_stack_space_get(&thread, &unused);
+        uint32_t used{static_cast<uint32_t>(thread.stack_info.size - unused)};
+        r.stack_used = used > overhead_stack ? used - overhead_stack : 0;
+    }
+    static void runner(void *p1, void *p2, void *p3) {
+        const job &j{*static_cast<job*>(p1)};
+        result &r{*j.r};
+        r = result{j.samples, UINT32_MAX, 0, 0, 0};
+        uint64_t sum{0};
+        j.fn(); // warm the caches and any lazy state
+        for (uint32_t i{0}; i < j.samples; ++i) {
+            unsigned int key{irq_lock()};
+            uint32_t begin{isr_timing::cycle()};
+            j.fn();
+            uint32_t cycles{isr_timing::cycle() - begin};
+            irq_unlock(key);
+            cycles = cycles > j.overhead_cycles ? cycles - j.overhead_cycles : 0;
+            if (cycles < r.min)
+                r.min = cycles;
+            if (cycles > r.max)
+                r.max = cycles;
+            sum += cycles;
+        }
+        r.mean = j.samples == 0 ? 0 : sum / j.samples;
+    }
+    static constexpr uint32_t MAX_ENTRIES{32};
+    entry entries[MAX_ENTRIES]{};
+    uint32_t count{0};
+    uint32_t overhead_cycles{0}, overhead_stack{0};
+    k_thread thread{};
+};
+// Constant initialised, MICROBENCH() registers from other static initialisers.
+constinit microbench_impl impl;
+
+int list(const shell *shell, size_t argc, char **argv)
+{
+    for (uint32_t i{0}; i < impl.size(); ++i)
+        shell_print(shell, "%s", impl.get_name(i));
+    return 0;
+}
+
+int run_shell(const shell *shell, size_t argc, char **argv, bool csv)
+{
+    if (argc > 3) {
+        shell_error(shell, "Usage: %s %s [filter] [samples]\n", argv[-1], argv[0]);
+        return 1;
+    }
+    const char *filter{argc >= 2 && strcmp(argv[1], "all") != 0 ? argv[1] : nullptr};
+    uint32_t samples{argc >= 3 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 1000U};
+    impl.calibrate();
+    if (csv) {
+        shell_print(shell, "bench,clock_hz,%u", sys_clock_hw_cycles_per_sec());
+        shell_print(shell, "bench,name,samples,min_cycles,mean_cycles,max_cycles,stack_bytes");
+    } else {
+        shell_print(shell, "%-28s %8s %8s %8s %8s %8s", "name", "samples", "min", "mean", "max", "stack");
+    }
+    for (uint32_t i{0}; i < impl.size(); ++i) {
+        if (filter != nullptr && strstr(impl.get_name(i), filter) == nullptr)
+            continue;
+        result r;
+        impl.measure(i, samples, r);
+        if (csv)
+            shell_print(shell, "bench,%s,%u,%u,%u,%u,%u", impl.get_name(i), r.samples, r.min, r.mean, r.max, r.stack_used);
+        else
+            shell_print(shell, "%-28s %8u %8u %8u %8u %8u", impl.get_name(i), r.samples, r.min, r.mean, r.max, r.stack_used);
+    }
+    return 0;
+}
+
+int run(const shell *shell, size_t argc, char **argv)
+{
+    return run_shell(shell, argc, argv, false);
+}
+
+int csv(const shell *shell, size_t argc, char **argv)
+{
+    return run_shell(shell, argc, argv, true);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(list, NULL, "List benchmarks", list),
+    SHELL_CMD(run, NULL, "Run benchmarks [filter] [samples], cycles per call", run),
+    SHELL_CMD(csv, NULL, "Run benchmarks [filter] [samples], CSV output", csv),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(bench, &sub, "Microbenchmark commands", NULL);
+
+int add(const char *name, function fn)
+{
+    return impl.add(name, fn);
+}
+
+void run_all(const char *filter, uint32_t samples)
+{
+    impl.calibrate();
+    printk("bench,clock_hz,%u\n", sys_clock_hw_cycles_per_sec());
+    printk("bench,name,samples,min_cycles,mean_cycles,max_cycles,stack_bytes\n");
+    for (uint32_t i{0}; i < impl.size(); ++i) {
+        if (filter != nullptr && strstr(impl.get_name(i), filter) == nullptr)
+            continue;
+        result r;
+        impl.measure(i, samples, r);
+        printk("bench,%s,%u,%u,%u,%u,%u\n", impl.get_name(i), r.samples, r.min, r.mean, r.max, r.stack_used);
+    }
+    printk("bench,done\n");
+}
+
+}
+
+// The suite.  Entries that need a module's private classes are registered
+// in that module, e.g. actuator_counter_poll.
+
+namespace {
+
+using namespace lexxhard;
+
+// Keeps results that are otherwise unused.
+volatile int32_t sink;
+
+struct can_frame {
+    uint32_t id;
+    uint8_t data[8];
+};
+
+// One BMU report cycle, decoded one frame per sample.
+const can_frame bmu_cycle[]{
+    {0x100, {0x01, 0x02, 80, 78, 99, 0x00, 0xfa, 0x00}},
+    {0x101, {0xff, 0x38, 0x00, 0x00, 0x6d, 0x60, 0x03, 0x00}},
+    {0x103, {0x27, 0x10, 0x26, 0xac, 0x1e, 0x14, 0x00, 0x00}},
+    {0x110, {0x0d, 0x48, 0x03, 0x00, 0x0d, 0x2a, 0x0b, 0x00}},
+    {0x111, {0x01, 0x18, 0x02, 0x00, 0x00, 0xfa, 0x07, 0x00}},
+    {0x112, {0x00, 0x64, 0x01, 0x00, 0xff, 0x9c, 0x04, 0x00}},
+    {0x113, {0x12, 0x05, 0x0e, 0x01, 0x00, 0x00, 0x00, 0x00}},
+    {0x120, {0x0c, 0xf8, 0x09, 0x00, 0x0d, 0x05, 0x02, 0x00}},
+    {0x130, {0x07, 0xe8, 0x07, 0xe8, 0x12, 0x34, 0x00, 0x00}},
+};
+
+MICROBENCH(can_decode_bmu)
+{
+    static can_controller::msg_bmu bmu;
+    static uint32_t index{0};
+    const can_frame &frame{bmu_cycle[index]};
+    can_controller::decode_bmu(frame.id, frame.data, bmu);
+    if (++index >= ARRAY_SIZE(bmu_cycle))
+        index = 0;
+}
+
+MICROBENCH(can_decode_board)
+{
+    static const uint8_t data[8]{0b00011010, 0b10000110, 0b01110011, 0b00011101, 60, 31, 32, 40};
+    static can_controller::msg_board board;
+    can_controller::decode_board(0x200, data, board);
+}
+
+// A lane tracking response with its XOR check byte.
+struct pgv_response {
+    pgv_response() {
+        for (uint32_t i{0}; i < 20; ++i)
+            buf[i] = (i * 37 + 11) & 0x7f;
+        buf[1] = 0x14;
+        buf[20] = buf[0];
+        for (uint32_t i{1}; i < 20; ++i)
+            buf[20] ^= buf[i];
+    }
+    uint8_t buf[21];
+} const pgv_lane;
+
+MICROBENCH(pgv_validate_decode)
+{
+    static pgv_controller::msg data;
+    if (pgv_controller::validate(pgv_lane.buf, sizeof pgv_lane.buf))
+        pgv_controller::decode(pgv_lane.buf, data);
+}
+
+constexpr uint32_t PIXELS{DT_PROP(DT_NODELABEL(led_strip0), chain_length)};
+led_controller::led_pattern<PIXELS> pattern;
+
+MICROBENCH(led_clamp_rgb_frame)
+{
+    for (uint32_t i{0}; i < PIXELS; ++i) {
+        pattern.pixeldata[0][i] = led_controller::led_pattern<PIXELS>::clamp_rgb(pattern.pixeldata[0][i], 128);
+        pattern.pixeldata[1][i] = led_controller::led_pattern<PIXELS>::clamp_rgb(pattern.pixeldata[1][i], 128);
+    }
+}
+
+MICROBENCH(led_fill_rainbow)
+{
+    static const led_controller::msg message{led_controller::msg::CHARGING, 0};
+    pattern.render(message, 50, 255);
+}
+
+MICROBENCH(led_fill_showtime)
+{
+    static const led_controller::msg message{led_controller::msg::SHOWTIME, 0};
+    pattern.render(message, 50, 255);
+}
+
+struct fake_counter {
+    int32_t get_location() const {return location;}
+    int32_t get_velocity() const {return velocity;}
+    int32_t location{0}, velocity{0};
+};
+
+MICROBENCH(actuator_position_control)
+{
+    static fake_counter cnt;
+    static actuator_controller::position_control<fake_counter> posctl{cnt};
+    if (posctl.is_near()) {
+        cnt.location = 0;
+        posctl.on(100, 100);
+    }
+    auto [activated, direction, control]{posctl.poll(10)};
+    cnt.velocity = static_cast<int32_t>(control * 30);
+    cnt.location += cnt.velocity / 100;
+}
+
+MICROBENCH(adc_reader_get)
+{
+    sink = adc_reader::get(adc_reader::ACTUATOR_0);
+}
+
+MICROBENCH(runaway_yaw_checker)
+{
+    static runaway_detector::yaw_checker yaw;
+    static uint32_t cycle{0}, n{0};
+    cycle += sys_clock_hw_cycles_per_sec() / 50;
+    float vz{0.5f * sinf(static_cast<float>(n++ % 500) * 0.0126f)};
+    sink = yaw.detect(vz, cycle, 1.5f * static_cast<float>(M_PI));
+}
+
+MICROBENCH(firmware_updater_checksum)
+{
+    static firmware_updater::packet_array packet;
+    sink = firmware_updater::checksum_ok(packet.data);
+}
+
+// rosserial publish cost is serialisation into the node handle buffer plus
+// the UART ring buffer copy, the latter shows in "isr info".
+uint8_t serialize_buffer[512];
+
+MICROBENCH(rosserial_serialize_imu)
+{
+    static lexxauto_msgs::Imu msg;
+    msg.gyro.z += 0.001f;
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_battery)
+{
+    static sensor_msgs::Temperature temps[3];
+    static lexxauto_msgs::Battery msg;
+    msg.temps = temps;
+    msg.temps_length = ARRAY_SIZE(temps);
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_pgv)
+{
+    static lexxauto_msgs::PositionGuideVision msg;
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_uss)
+{
+    static double data[5]{0.5, 1.0, 1.5, 2.0, 2.5};
+    static std_msgs::Float64MultiArray msg;
+    msg.data = data;
+    msg.data_length = ARRAY_SIZE(data);
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_encoder)
+{
+    static int32_t data[3]{120, -40, 3000};
+    static std_msgs::Int32MultiArray msg;
+    msg.data = data;
+    msg.data_length = ARRAY_SIZE(data);
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_temperature)
+{
+    static lexxauto_msgs::BoardTemperatures msg;
+    msg.serialize(serialize_buffer);
+}
+
+MICROBENCH(rosserial_serialize_string)
+{
+    static std_msgs::String msg;
+    msg.data = "led_controller 0x0001 error device not ready 12345678";
+    msg.serialize(serialize_buffer);
+}
+
+}
+
+#endif // CONFIG_LEXXHARD_BENCH
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+// On-target microbenchmarks of hot functions.  Each entry runs once per
+// sample with interrupts locked and is timed with isr_timing::cycle(), on a
+// freshly painted stack so the stack high-water mark is per entry.
+// Built only with CONFIG_LEXXHARD_BENCH, see bench.conf.
+
+namespace lexxhard::microbench {
+
+using function = void (*)();
+
+struct result {
+    uint32_t samples, min, max, mean, stack_used;
+};
+
+// Called from the static initialisers generated by MICROBENCH().
+int add(const char *name, function fn);
+// Runs every entry whose name contains filter (all when nullptr) and
+// prints one CSV line per entry with printk.
+void run_all(const char *filter, uint32_t samples);
+
+}
+
+#define MICROBENCH(name) \
+    static void microbench_##name(); \
+    [[maybe_unused]] static const int microbench_registered_##name{lexxhard::microbench::add(#name, microbench_##name)}; \
+    static void microbench_##name()
+
+// vim: set expandtab shiftwidth=4:
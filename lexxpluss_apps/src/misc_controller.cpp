@@ -27,6 +27,8 @@
 #include <drivers/i2c.h>
 #include <logging/log.h>
 #include <shell/shell.h>
+#include "diagnostics.hpp"
+#include "freshness.hpp"
 #include "misc_controller.hpp"
 
 namespace lexxhard::misc_controller {
@@ -37,8 +39,10 @@ class impl {
 public:
     int init() {
         dev = device_get_binding("I2C_4");
-        if (!device_is_ready(dev))
+        if (!device_is_ready(dev)) {
+            diagnostics::report(diagnostics::MISC, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return -1;
+        }
         for (int i{0}; i < TEMPERATURE_NUM; ++i) {
             uint8_t wbuf[1]{0x0b}, rbuf[2];
             if (i2c_write_read(dev, ADDR + i, wbuf, sizeof wbuf, rbuf, sizeof rbuf) == 0 &&
@@ -49,18 +53,16 @@ public:
         }
         return 0;
     }
-    void run() {
+    void poll() {
         if (!device_is_ready(dev))
             return;
-        while (true) {
-            for (int i{0}; i < TEMPERATURE_NUM; ++i) {
-                uint8_t wbuf[1]{0x00}, rbuf[2];
-                if (i2c_write_read(dev, ADDR + i, wbuf, sizeof wbuf, rbuf, sizeof rbuf) == 0) {
-                    int16_t value{static_cast<int16_t>((rbuf[0] << 8) | rbuf[1])};
-                    temperature[i] = temperature[i] * 0.5f + value / 128.0f * 0.5f;
-                }
+        for (int i{0}; i < TEMPERATURE_NUM; ++i) {
+            uint8_t wbuf[1]{0x00}, rbuf[2];
+            if (i2c_write_read(dev, ADDR + i, wbuf, sizeof wbuf, rbuf, sizeof rbuf) == 0) {
+                int16_t value{static_cast<int16_t>((rbuf[0] << 8) | rbuf[1])};
+                temperature[i] = (temperature[i] + value) / 2;
+                fresh.update(i);
             }
-            k_msleep(100);
         }
     }
     void info(const shell *shell) const {
@@ -71,20 +73,33 @@ public:
                     get_actuator_board_temp(0),
                     get_actuator_board_temp(1),
                     get_actuator_board_temp(2));
+        shell_print(shell, "stale:0x%x", get_stale_mask());
     }
-    float get_main_board_temp() const {return temperature[3];}
+    // Conversion to degrees happens in the caller's thread.
+    float get_main_board_temp() const {return temperature[3] / 128.0f;}
     float get_actuator_board_temp(int index) const {
         switch (index) {
-        case 0:  return temperature[0];
-        case 1:  return temperature[2];
-        case 2:  return temperature[1];
+        case 0:  return temperature[0] / 128.0f;
+        case 1:  return temperature[2] / 128.0f;
+        case 2:  return temperature[1] / 128.0f;
         default: return 0.0f;
         }
     }
+    bool is_main_board_temp_stale() const {return fresh.is_stale(3);}
+    bool is_actuator_board_temp_stale(int index) const {
+        switch (index) {
+        case 0:  return fresh.is_stale(0);
+        case 1:  return fresh.is_stale(2);
+        case 2:  return fresh.is_stale(1);
+        default: return true;
+        }
+    }
+    uint32_t get_stale_mask() const {return fresh.stale_mask();}
 private:
     const device *dev{nullptr};
     static constexpr int TEMPERATURE_NUM{4};
-    float temperature[TEMPERATURE_NUM]{0.0f, 0.0f, 0.0f, 0.0f};
+    int32_t temperature[TEMPERATURE_NUM]{0, 0, 0, 0}; // 1/128 deg units
+    freshness<TEMPERATURE_NUM> fresh{CONFIG_LEXXHARD_STALE_TEMPERATURE_MS};
     static constexpr uint8_t ADDR{0b1001000};
 } impl;
 
@@ -105,9 +120,9 @@ void init()
     impl.init();
 }
 
-void run(void *p1, void *p2, void *p3)
+void poll()
 {
-    impl.run();
+    impl.poll();
 }
 
 float get_main_board_temp()
@@ -120,7 +135,21 @@ float get_actuator_board_temp(int index)
     return impl.get_actuator_board_temp(index);
 }
 
-k_thread thread;
+bool is_main_board_temp_stale()
+{
+    return impl.is_main_board_temp_stale();
+}
+
+bool is_actuator_board_temp_stale(int index)
+{
+    return impl.is_actuator_board_temp_stale(index);
+}
+
+uint32_t get_stale_mask()
+{
+    return impl.get_stale_mask();
+}
+
 
 }
 
@@ -30,10 +30,12 @@
 namespace lexxhard::misc_controller {
 
 void init();
-void run(void *p1, void *p2, void *p3);
+void poll();
 float get_main_board_temp();
 float get_actuator_board_temp(int index = 0);
-extern k_thread thread;
+bool is_main_board_temp_stale();
+bool is_actuator_board_temp_stale(int index = 0);
+uint32_t get_stale_mask();
 
 }
 
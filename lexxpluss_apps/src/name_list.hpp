@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include <cstring>
+
+namespace lexxhard::sdlog_controller {
+
+// Keeps the first MAX_ENTRIES names in sorted order, longer names are
+// truncated to MAX_FNAME - 1 characters.
+template <uint32_t MAX_ENTRIES, uint32_t MAX_FNAME>
+class name_list {
+public:
+    enum class ORDER {ASCENT, DESCENT};
+    name_list() {
+        reset();
+    }
+    void reset() {
+        for (auto &i : entries)
+            i[0] = '\0';
+    }
+    void push(ORDER order, const char* str) {
+        for (uint32_t i{0}; i < MAX_ENTRIES; ++i) {
+            if (entries[i][0] == 0) {
+                stor(entries[i], str);
+                break;
+            } else {
+                int comp{strcmp(str, entries[i])};
+                if ((order == ORDER::ASCENT && comp < 0) ||
+                    (order == ORDER::DESCENT && comp > 0)) {
+                    for (uint32_t j{MAX_ENTRIES - 1}; j > i; --j) {
+                        if (entries[j - 1][0] != 0)
+                            stor(entries[j], entries[j - 1]);
+                    }
+                    stor(entries[i], str);
+                    break;
+                }
+            }
+        }
+    }
+    const char *operator[](int index) const {
+        return entries[index];
+    }
+private:
+    void stor(char *to, const char *from) const {
+        snprintf(to, MAX_FNAME, "%s", from);
+    }
+    char entries[MAX_ENTRIES][MAX_FNAME];
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <shell/shell.h>
+#include "config.hpp"
+#include "periodic.hpp"
+
+namespace lexxhard::periodic {
+
+struct entry {
+    const char *name;
+    int period_key;
+    uint32_t period_ms, deadline_ms;
+    bool control;
+};
+
+static constexpr int FIXED{-1};
+
+// The deadline is relative to the release and never longer than the period.
+// runaway_detector is sporadic, released by each IMU sample, so it only
+// takes part in the ranking and never calls wait().  So are the USS
+// fetchers, paced by their sensors and ranked at the rate the readings
+// are published.
+const entry table[]{
+    {"imu_controller",      config::IMU_PERIOD_MS,      0,  1,  true},
+    {"runaway_detector",    config::IMU_PERIOD_MS,      0,  0,  true},
+    {"actuator_controller", config::ACTUATOR_PERIOD_MS, 0,  10, true},
+    {"pgv_controller",      config::PGV_PERIOD_MS,      0,  10, false},
+    {"adc_reader",          config::ADC_PERIOD_MS,      0,  20, false},
+    {"led_controller",      FIXED,                      25, 25, false}, // animation frame, led_pattern::DELAY_MS
+    {"uss_fetcher0",        config::USS_PERIOD_MS,      0,  0,  false},
+    {"uss_fetcher1",        config::USS_PERIOD_MS,      0,  0,  false},
+    {"uss_fetcher2",        config::USS_PERIOD_MS,      0,  0,  false},
+    {"uss_fetcher3",        config::USS_PERIOD_MS,      0,  0,  false},
+};
+
+static constexpr int CONTROL_NUM{[] {
+    int n{0};
+    for (const auto &i : table)
+        n += i.control ? 1 : 0;
+    return n;
+}()};
+
+static_assert(ARRAY_SIZE(table) == LOOP_NUM, "one entry per loop, in loop order");
+
+struct state {
+    k_tid_t thread;
+    int64_t period, deadline, release, start;
+    uint32_t runs, misses, skips;
+    uint32_t max_jitter, max_exec;
+    uint64_t sum_jitter;
+    uint32_t config_generation;
+};
+
+class periodic_impl {
+public:
+    int get_priority(int loop) const {
+        uint32_t period_ms{get_period_ms(loop)};
+        int rank{0};
+        for (int i{0}; i < LOOP_NUM; ++i) {
+            if (table[i].control != table[loop].control)
+                continue;
+            uint32_t other_ms{get_period_ms(i)};
+            if (other_ms < period_ms || (other_ms == period_ms && i < loop))
+                ++rank;
+        }
+        return table[loop].control ? PRIORITY_BASE + rank : get_service_priority() + 1 + rank;
+    }
+    int get_service_priority() const {
+        return PRIORITY_BASE + CONTROL_NUM;
+    }
+    void start(int loop) {
+        state &s{states[loop]};
+        s.config_generation = config::get_generation();
+        load(loop);
+        s.thread = k_current_get();
+        k_thread_priority_set(s.thread, get_priority(loop));
+        s.release = s.start = k_uptime_ticks();
+    }
+    void wait(int loop) {
+        state &s{states[loop]};
+        int64_t end{k_uptime_ticks()};
+        uint32_t exec{static_cast<uint32_t>(end - s.start)};
+        if (s.max_exec < exec)
+            s.max_exec = exec;
+        if (end - s.release > s.deadline)
+            ++s.misses;
+        if (uint32_t gen{config::get_generation()}; gen != s.config_generation) {
+            s.config_generation = gen;
+            load(loop);
+            rerank();
+        }
+        s.release += s.period;
+        if (s.release + s.period <= end) {
+            // Fell more than a whole period behind, drop the missed releases.
+            ++s.skips;
+            s.release = end;
+        }
+        if (s.release > end)
+            k_sleep(K_TIMEOUT_ABS_TICKS(s.release));
+        s.start = k_uptime_ticks();
+        uint32_t jitter{static_cast<uint32_t>(s.start - s.release)};
+        ++s.runs;
+        s.sum_jitter += jitter;
+        if (s.max_jitter < jitter)
+            s.max_jitter = jitter;
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "%-20s %6s %6s %4s %8s %8s %8s %8s %6s %6s",
+                    "name", "period", "dl", "prio", "runs", "jit(us)", "max(us)", "exec(us)", "miss", "skip");
+        for (int i{0}; i < LOOP_NUM; ++i) {
+            const state &s{states[i]};
+            uint32_t mean{s.runs == 0 ? 0 : static_cast<uint32_t>(s.sum_jitter / s.runs)};
+            shell_print(shell, "%-20s %6u %6u %4d %8u %8u %8u %8u %6u %6u",
+                        table[i].name, get_period_ms(i), get_deadline_ms(i), get_priority(i), s.runs,
+                        k_ticks_to_us_near32(mean), k_ticks_to_us_near32(s.max_jitter),
+                        k_ticks_to_us_near32(s.max_exec), s.misses, s.skips);
+        }
+    }
+    void reset() {
+        for (int i{0}; i < LOOP_NUM; ++i) {
+            state &s{states[i]};
+            s.runs = s.misses = s.skips = s.max_jitter = s.max_exec = 0;
+            s.sum_jitter = 0;
+        }
+    }
+private:
+    static uint32_t get_period_ms(int loop) {
+        const entry &e{table[loop]};
+        return e.period_key == FIXED ? e.period_ms : config::get_int(static_cast<config::key>(e.period_key));
+    }
+    static uint32_t get_deadline_ms(int loop) {
+        uint32_t period_ms{get_period_ms(loop)};
+        uint32_t deadline_ms{table[loop].deadline_ms};
+        return deadline_ms == 0 || deadline_ms > period_ms ? period_ms : deadline_ms;
+    }
+    void load(int loop) {
+        state &s{states[loop]};
+        s.period = k_ms_to_ticks_ceil32(get_period_ms(loop));
+        s.deadline = k_ms_to_ticks_ceil32(get_deadline_ms(loop));
+    }
+    void rerank() const {
+        // A period change can reorder every loop, not only the caller.
+        for (int i{0}; i < LOOP_NUM; ++i) {
+            if (states[i].thread != nullptr)
+                k_thread_priority_set(states[i].thread, get_priority(i));
+        }
+    }
+    state states[LOOP_NUM]{};
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+int reset(const shell *shell, size_t argc, char **argv)
+{
+    impl.reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Periodic loop information", info),
+    SHELL_CMD(reset, NULL, "Reset periodic loop statistics", reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(periodic, &sub, "Periodic loop commands", NULL);
+
+int get_priority(int loop)
+{
+    return impl.get_priority(loop);
+}
+
+int get_service_priority()
+{
+    return impl.get_service_priority();
+}
+
+void start(int loop)
+{
+    impl.start(loop);
+}
+
+void wait(int loop)
+{
+    impl.wait(loop);
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::periodic {
+
+enum {
+    IMU_CONTROLLER = 0,
+    RUNAWAY_DETECTOR,
+    ACTUATOR_CONTROLLER,
+    PGV_CONTROLLER,
+    ADC_READER,
+    LED_CONTROLLER,
+    USS_FETCHER_0,
+    USS_FETCHER_1,
+    USS_FETCHER_2,
+    USS_FETCHER_3,
+    LOOP_NUM
+};
+
+// The loops own one preemptive priority each, starting from PRIORITY_BASE,
+// with PRIORITY_SERVICE left free between the control loops and the others.
+// Threads outside the table are placed relative to PRIORITY_END.
+static constexpr int PRIORITY_BASE{1};
+static constexpr int PRIORITY_END{PRIORITY_BASE + LOOP_NUM + 1};
+
+// Rate monotonic within each band: the shorter the period, the higher the
+// priority.  The control loops rank above every other loop.
+int get_priority(int loop);
+// The free priority below the control loops and above the other loops.
+int get_service_priority();
+// Called from the loop's own thread, the first release is now.
+void start(int loop);
+// Sleeps until the next absolute release, counting deadline misses and jitter.
+void wait(int loop);
+
+}
+
+// vim: set expandtab shiftwidth=4:
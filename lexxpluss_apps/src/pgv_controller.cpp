@@ -30,7 +30,18 @@
 #include <logging/log.h>
 #include <shell/shell.h>
 #include <sys/ring_buffer.h>
+#include <algorithm>
+#include <cstring>
+#include "blackbox.hpp"
+#include "diagnostics.hpp"
+#include "freshness.hpp"
+#include "isr_timing.hpp"
+#include "periodic.hpp"
 #include "pgv_controller.hpp"
+#include "recorder.hpp"
+#include "tcm.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::pgv_controller {
 
@@ -79,8 +90,10 @@ public:
     void run() {
         if (!device_is_ready(dev_485) ||
             !device_is_ready(dev_en) ||
-            !device_is_ready(dev_en_n))
+            !device_is_ready(dev_en_n)) {
+            diagnostics::report(diagnostics::PGV, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
         for (int i{0}; i < 30; ++i) {
             ring_buf_reset(&rxbuf.rb);
             set_direction_decision(DIR::STRAIGHT);
@@ -93,14 +106,23 @@ public:
         if (device_is_ready(gpiog))
             gpio_pin_configure(gpiog, 4, GPIO_OUTPUT_LOW | GPIO_ACTIVE_HIGH);
         int heartbeat_led{1};
+        watchdog_supervisor::declare(watchdog_supervisor::PGV_CONTROLLER, "pgv_controller", 500, false);
+        periodic::start(periodic::PGV_CONTROLLER);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::PGV_CONTROLLER);
+            TRACE_BEGIN(PGV_CONTROLLER);
             if (device_is_ready(gpiog)) {
                 gpio_pin_set(gpiog, 4, heartbeat_led);
                 heartbeat_led = !heartbeat_led;
             }
             if (get_position(pgv2ros)) {
+                diagnostics::report(diagnostics::PGV, diagnostics::OK, diagnostics::CODE_NONE);
+                fresh.update(0);
                 while (k_msgq_put(&msgq, &pgv2ros, K_NO_WAIT) != 0)
                     k_msgq_purge(&msgq);
+                record_blackbox(pgv2ros);
+            } else {
+                diagnostics::report(diagnostics::PGV, diagnostics::WARN, diagnostics::CODE_INVALID_DATA);
             }
             msg_control ros2pgv;
             if (k_msgq_get(&msgq_control, &ros2pgv, K_NO_WAIT) == 0) {
@@ -113,9 +135,10 @@ public:
                 }
                 wait_data(5);
                 uint8_t buf[8];
-                recv(buf, sizeof buf);
+                record_answer(buf, recv(buf, sizeof buf));
             }
-            k_msleep(10);
+            TRACE_END(PGV_CONTROLLER);
+            periodic::wait(periodic::PGV_CONTROLLER);
         }
     }
     void info(const shell *shell) const {
@@ -129,6 +152,10 @@ public:
                     m.xp, m.xps, m.yps, m.ang,
                     m.tag, m.cc1, m.cc2, m.wrn,
                     m.addr, m.lane, m.o1, m.o2, m.s1, m.s2);
+        shell_print(shell, "age:%ums stale:%d", fresh.age_ms(0), is_stale());
+    }
+    bool is_stale() const {
+        return fresh.is_stale(0);
     }
 private:
     enum class DIR {
@@ -137,6 +164,24 @@ private:
         LEFT,
         STRAIGHT
     };
+    // The request goes first so the replay can answer each request with
+    // its own recorded answer.
+    void record_answer(const uint8_t *buf, int n) const {
+#ifdef CONFIG_LEXXHARD_RECORDER
+        uint8_t payload[1 + 64]{last_request};
+        n = std::min(n, 64);
+        memcpy(&payload[1], buf, n);
+        recorder::record(RECORDING_PGV, payload, 1 + n);
+#endif
+    }
+    static void record_blackbox(const msg &data) {
+        blackbox::pgv_sample sample{
+            data.xp, data.tag, data.xps, data.yps, data.ang, data.wrn, data.lane,
+            static_cast<uint8_t>(data.f.err << 0 | data.f.wrn << 1 | data.f.np << 2 | data.f.nl << 3 |
+                                 data.f.ll << 4 | data.f.rl << 5 | data.f.tag << 6 | data.f.rp << 7)
+        };
+        blackbox::record(blackbox::PGV, &sample, sizeof sample);
+    }
     bool get_position(msg &data) {
         ring_buf_reset(&rxbuf.rb);
         uint8_t req[2];
@@ -145,7 +190,9 @@ private:
         send(req, sizeof req);
         wait_data(23);
         uint8_t buf[64];
-        if (int n{recv(buf, sizeof buf)}; n < 23 || !validate(buf + 2, 21))
+        int n{recv(buf, sizeof buf)};
+        record_answer(buf, n);
+        if (n < 23 || !validate(buf + 2, 21))
             return false;
         decode(buf + 2, data);
         return true;
@@ -161,72 +208,12 @@ private:
         req[1] = ~req[0];
         send(req, sizeof req);
     }
-    void decode(const uint8_t *buf, msg &data) const {
-        data.f.cc2 =  (buf[ 0] & 0x40) != 0;
-        data.addr  =  (buf[ 0] & 0x30) >> 4;
-        data.f.cc1 =  (buf[ 0] & 0x08) != 0;
-        data.f.wrn =  (buf[ 0] & 0x04) != 0;
-        data.f.np  =  (buf[ 0] & 0x02) != 0;
-        data.f.err =  (buf[ 0] & 0x01) != 0;
-        data.f.tag =  (buf[ 1] & 0x40) != 0;
-        data.lane  =  (buf[ 1] & 0x30) >> 4;
-        data.f.rp  =  (buf[ 1] & 0x08) != 0;
-        data.f.nl  =  (buf[ 1] & 0x04) != 0;
-        data.f.ll  =  (buf[ 1] & 0x02) != 0;
-        data.f.rl  =  (buf[ 1] & 0x01) != 0;
-        data.yps   =  (buf[ 6] & 0x40 ? 0xc000 : 0) |
-                     ((buf[ 6] & 0x7f) << 7) |
-                      (buf[ 7] & 0x7f);
-        data.ang   = ((buf[10] & 0x7f) << 7) |
-                      (buf[11] & 0x7f);
-        data.wrn   = ((buf[18] & 0x7f) << 7) |
-                      (buf[19] & 0x7f);
-        if (data.f.tag) { // data matrix tag
-            data.xp  = 0;
-            data.o1  = 0;
-            data.s1  = 0;
-            data.cc1 = 0;
-            data.o2  = 0;
-            data.s2  = 0;
-            data.cc2 = 0;
-            data.xps =  (buf[ 2] & 0x04 ? 0xff00000000 : 0) |
-                       ((buf[ 2] & 0x07) << 21) |
-                       ((buf[ 3] & 0x7f) << 14) |
-                       ((buf[ 4] & 0x7f) <<  7) |
-                        (buf[ 5] & 0x7f);
-            data.tag = ((buf[14] & 0x7f) << 21) |
-                       ((buf[15] & 0x7f) << 14) |
-                       ((buf[16] & 0x7f) <<  7) |
-                        (buf[17] & 0x7f);
-        } else { // lane tracking
-            data.xp  = ((buf[ 2] & 0x07) << 21) |
-                       ((buf[ 3] & 0x7f) << 14) |
-                       ((buf[ 4] & 0x7f) <<  7) |
-                        (buf[ 5] & 0x7f);
-            data.o1  =  (buf[14] & 0x60) >> 5;
-            data.s1  =  (buf[14] & 0x18) >> 3;
-            data.cc1 = ((buf[14] & 0x07) << 7) |
-                        (buf[15] & 0x7f);
-            data.o2  =  (buf[16] & 0x60) >> 5;
-            data.s2  =  (buf[16] & 0x18) >> 3;
-            data.cc2 = ((buf[16] & 0x07) << 7) |
-                        (buf[17] & 0x7f);
-            data.xps = 0;
-            data.tag = 0;
-        }
-    }
-    bool validate(const uint8_t *buf, uint32_t length) const {
-        uint32_t tail{length - 1};
-        uint8_t check{buf[0]};
-        for (uint32_t i{1}; i < tail; ++i)
-            check ^= buf[i];
-        return check == buf[tail];
-    }
     uint32_t rb_count(const ring_buf *rb) const {
         return rb->tail - rb->head;
     }
     void send(const uint8_t *buf, uint32_t length) {
         if (device_is_ready(dev_485)) {
+            last_request = buf[0];
             gpio_pin_set(dev_en, 2, 1);
             k_busy_wait(100);
             while (length > 0) {
@@ -251,7 +238,9 @@ private:
     int recv(uint8_t *buf, uint32_t length) {
         return ring_buf_get(&rxbuf.rb, buf, length);
     }
-    void uart_isr() {
+    TCM_CODE void uart_isr() {
+        uint32_t begin_cycle{isr_timing::begin()};
+        TRACE_BEGIN(PGV_ISR);
         while (uart_irq_update(dev_485) && uart_irq_is_pending(dev_485)) {
             uint8_t buf[64];
             if (uart_irq_rx_ready(dev_485)) {
@@ -269,6 +258,8 @@ private:
                 k_sem_give(&sem);
             }
         }
+        TRACE_END(PGV_ISR);
+        isr_timing::end(isr_timing::PGV_UART, begin_cycle);
     }
     struct {
         ring_buf rb;
@@ -276,7 +267,9 @@ private:
     } txbuf, rxbuf;
     const device *dev_485{nullptr}, *dev_en{nullptr}, *dev_en_n{nullptr};
     msg pgv2ros;
+    uint8_t last_request{0};
     k_sem sem;
+    freshness<1> fresh{CONFIG_LEXXHARD_STALE_PGV_MS};
 } impl;
 
 int info(const shell *shell, size_t argc, char **argv)
@@ -301,6 +294,11 @@ void run(void *p1, void *p2, void *p3)
     impl.run();
 }
 
+bool is_stale()
+{
+    return impl.is_stale();
+}
+
 k_thread thread;
 k_msgq msgq, msgq_control;
 
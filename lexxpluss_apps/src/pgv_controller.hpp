@@ -44,8 +44,76 @@ struct msg_control {
     uint8_t dir_command;
 } __attribute__((aligned(4)));
 
+// Decodes the 21 byte position response that follows the 2 byte header.
+inline void decode(const uint8_t *buf, msg &data)
+{
+    data.f.cc2 =  (buf[ 0] & 0x40) != 0;
+    data.addr  =  (buf[ 0] & 0x30) >> 4;
+    data.f.cc1 =  (buf[ 0] & 0x08) != 0;
+    data.f.wrn =  (buf[ 0] & 0x04) != 0;
+    data.f.np  =  (buf[ 0] & 0x02) != 0;
+    data.f.err =  (buf[ 0] & 0x01) != 0;
+    data.f.tag =  (buf[ 1] & 0x40) != 0;
+    data.lane  =  (buf[ 1] & 0x30) >> 4;
+    data.f.rp  =  (buf[ 1] & 0x08) != 0;
+    data.f.nl  =  (buf[ 1] & 0x04) != 0;
+    data.f.ll  =  (buf[ 1] & 0x02) != 0;
+    data.f.rl  =  (buf[ 1] & 0x01) != 0;
+    data.yps   =  (buf[ 6] & 0x40 ? 0xc000 : 0) |
+                 ((buf[ 6] & 0x7f) << 7) |
+                  (buf[ 7] & 0x7f);
+    data.ang   = ((buf[10] & 0x7f) << 7) |
+                  (buf[11] & 0x7f);
+    data.wrn   = ((buf[18] & 0x7f) << 7) |
+                  (buf[19] & 0x7f);
+    if (data.f.tag) { // data matrix tag
+        data.xp  = 0;
+        data.o1  = 0;
+        data.s1  = 0;
+        data.cc1 = 0;
+        data.o2  = 0;
+        data.s2  = 0;
+        data.cc2 = 0;
+        data.xps =  (buf[ 2] & 0x04 ? 0xff000000 : 0) |
+                   ((buf[ 2] & 0x07) << 21) |
+                   ((buf[ 3] & 0x7f) << 14) |
+                   ((buf[ 4] & 0x7f) <<  7) |
+                    (buf[ 5] & 0x7f);
+        data.tag = ((buf[14] & 0x7f) << 21) |
+                   ((buf[15] & 0x7f) << 14) |
+                   ((buf[16] & 0x7f) <<  7) |
+                    (buf[17] & 0x7f);
+    } else { // lane tracking
+        data.xp  = ((buf[ 2] & 0x07) << 21) |
+                   ((buf[ 3] & 0x7f) << 14) |
+                   ((buf[ 4] & 0x7f) <<  7) |
+                    (buf[ 5] & 0x7f);
+        data.o1  =  (buf[14] & 0x60) >> 5;
+        data.s1  =  (buf[14] & 0x18) >> 3;
+        data.cc1 = ((buf[14] & 0x07) << 7) |
+                    (buf[15] & 0x7f);
+        data.o2  =  (buf[16] & 0x60) >> 5;
+        data.s2  =  (buf[16] & 0x18) >> 3;
+        data.cc2 = ((buf[16] & 0x07) << 7) |
+                    (buf[17] & 0x7f);
+        data.xps = 0;
+        data.tag = 0;
+    }
+}
+
+// XOR of every byte but the last equals the last.
+inline bool validate(const uint8_t *buf, uint32_t length)
+{
+    uint32_t tail{length - 1};
+    uint8_t check{buf[0]};
+    for (uint32_t i{1}; i < tail; ++i)
+        check ^= buf[i];
+    return check == buf[tail];
+}
+
 void init();
 void run(void *p1, void *p2, void *p3);
+bool is_stale();
 extern k_thread thread;
 extern k_msgq msgq, msgq_control;
 
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <algorithm>
+#include <cstdlib>
+#include <tuple>
+#include "actuator_controller.hpp"
+#include "config.hpp"
+#include "tcm.hpp"
+
+namespace lexxhard::actuator_controller {
+
+// Position loop of one actuator, P on position into PI on velocity.  The
+// counter only needs get_location() [mm] and get_velocity() [mm/s].
+template <typename COUNTER>
+class position_control {
+public:
+    position_control(COUNTER &cnt) : cnt(cnt) {}
+    TCM_CODE std::tuple<bool, int8_t, float> poll(uint32_t dt_ms) {
+        if (!activated)
+            return {false, msg_control::STOP, 0.0f};
+        float control{0.0f};
+        int32_t diff_position{target_position - cnt.get_location()};
+        int8_t direction{diff_position < 0 ? msg_control::DOWN : msg_control::UP};
+        if (activated) {
+            float dt{dt_ms * 1e-3f};
+            int32_t target_velocity{static_cast<int32_t>(diff_position * config::get_float(config::ACTUATOR_POS_P))};
+            if (target_velocity < 0 && target_velocity > -vel_min)
+                target_velocity = -vel_min;
+            if (target_velocity > 0 && target_velocity < vel_min)
+                target_velocity = vel_min;
+            target_velocity = std::clamp(target_velocity, -vel_max, vel_max);
+            int32_t diff_velocity{target_velocity - cnt.get_velocity()};
+            float control_p{diff_velocity * config::get_float(config::ACTUATOR_VEL_P)};
+            control_i += diff_velocity * dt * config::get_float(config::ACTUATOR_VEL_I);
+            control_p = std::clamp(control_p, -1.0f, 1.0f);
+            control_i = std::clamp(control_i, -1.0f, 1.0f);
+            control = control_p + control_i;
+            control = std::clamp(control, -1.0f, 1.0f);
+            control *= 0.3f;
+            control += direction == msg_control::UP ? 0.7f : -0.7f;
+        }
+        return {activated, direction, control};
+    }
+    void on(int32_t target_position, int32_t target_power) {
+        this->target_position = target_position;
+        this->vel_max = 20 * target_power / 100;
+        this->vel_min = 10 * target_power / 100;
+        activated = true;
+    }
+    void off() {
+        control_i = 0.0f;
+        target_position = 0;
+        vel_max = 20;
+        vel_min = 10;
+        activated = false;
+    }
+    bool is_near(int32_t thres_mm = 1) const {
+        int32_t diff_abs{abs(target_position - cnt.get_location())};
+        return diff_abs < thres_mm;
+    }
+private:
+    COUNTER &cnt;
+    float control_i{0.0f};
+    int32_t target_position{0}, vel_max{20}, vel_min{10};
+    bool activated{false};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
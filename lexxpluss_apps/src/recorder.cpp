@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <fs/fs.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <sys/ring_buffer.h>
+#include <algorithm>
+#include <cstring>
+#include "recorder.hpp"
+
+#ifdef CONFIG_LEXXHARD_RECORDER
+
+namespace lexxhard::recorder {
+
+LOG_MODULE_REGISTER(recorder);
+
+namespace {
+
+K_THREAD_STACK_DEFINE(writer_stack, CONFIG_LEXXHARD_RECORDER_STACK_SIZE);
+
+constexpr uint32_t TYPE_NUM{RECORDING_ROSSERIAL_SERVICE_RX + 1};
+constexpr uint32_t WRITE_CHUNK{512}, IDLE_MS{20}, SYNC_MS{1000};
+
+}
+
+class recorder_impl {
+public:
+    int start(const char *path) {
+        if (running)
+            return -EBUSY;
+        fs_file_t_init(&file);
+        fs_unlink(path);
+        if (int result{fs_open(&file, path, FS_O_WRITE | FS_O_CREATE)}; result != 0)
+            return result;
+        recording_file_header header{{'L', 'X', 'R', 'C'}, RECORDING_VERSION, 0};
+        if (fs_write(&file, &header, sizeof header) != sizeof header) {
+            fs_close(&file);
+            return -EIO;
+        }
+        strncpy(this->path, path, sizeof this->path - 1);
+        ring_buf_init(&ring, sizeof buffer, buffer);
+        std::fill_n(count, TYPE_NUM, 0);
+        dropped = high_water = write_errors = 0;
+        written = sizeof header;
+        start_us = k_ticks_to_us_floor64(k_uptime_ticks());
+        running = true;
+        recording = true;
+        k_thread_create(&thread, writer_stack, K_THREAD_STACK_SIZEOF(writer_stack),
+                        entry, this, nullptr, nullptr, K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
+        k_thread_name_set(&thread, "recorder");
+        return 0;
+    }
+    void stop() {
+        recording = false;
+    }
+    void record(uint8_t type, const void *data, size_t len) {
+        if (!recording)
+            return;
+        __ASSERT_NO_MSG(type < TYPE_NUM && len <= UINT8_MAX);
+        k_spinlock_key_t key{k_spin_lock(&lock)};
+        // Stamped under the lock so the stamps in the file never go back.
+        recording_record_header header{
+            static_cast<uint32_t>(k_ticks_to_us_floor64(k_uptime_ticks()) - start_us),
+            type,
+            static_cast<uint8_t>(len)
+        };
+        // A record is kept whole or dropped whole.
+        if (ring_buf_space_get(&ring) < sizeof header + len) {
+            ++dropped;
+        } else {
+            ring_buf_put(&ring, reinterpret_cast<const uint8_t*>(&header), sizeof header);
+            ring_buf_put(&ring, static_cast<const uint8_t*>(data), len);
+            ++count[type];
+            high_water = std::max(high_water, ring_buf_capacity_get(&ring) - ring_buf_space_get(&ring));
+        }
+        k_spin_unlock(&lock, key);
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "%s %s written:%u dropped:%u write_errors:%u buffer:%u/%u",
+                    recording ? "recording" : running ? "flushing" : "idle", path,
+                    written, dropped, write_errors, high_water, sizeof buffer);
+        static const char *const names[TYPE_NUM]{
+            "", "can", "imu", "adc", "uss", "pgv", "rosserial", "rosserial_service"
+        };
+        for (uint32_t i{RECORDING_CAN}; i < TYPE_NUM; ++i)
+            shell_print(shell, "  %-18s %u", names[i], count[i]);
+    }
+private:
+    static void entry(void *p1, void *p2, void *p3) {
+        static_cast<recorder_impl*>(p1)->write_loop();
+    }
+    void write_loop() {
+        uint8_t chunk[WRITE_CHUNK];
+        uint32_t synced_ms{k_uptime_get_32()};
+        while (true) {
+            // Producers are serialized by the lock, so the ring has a single
+            // producer and this single consumer and is read without it.
+            if (uint32_t n{ring_buf_get(&ring, chunk, sizeof chunk)}; n > 0) {
+                if (fs_write(&file, chunk, n) != static_cast<ssize_t>(n)) {
+                    ++write_errors;
+                    recording = false;
+                    break;
+                }
+                written += n;
+                if (k_uptime_get_32() - synced_ms >= SYNC_MS) {
+                    fs_sync(&file);
+                    synced_ms = k_uptime_get_32();
+                }
+            } else if (recording) {
+                k_msleep(IDLE_MS);
+            } else {
+                break;
+            }
+        }
+        fs_close(&file);
+        LOG_INF("%s closed, %u bytes, %u records dropped", path, written, dropped);
+        running = false;
+    }
+    uint8_t buffer[CONFIG_LEXXHARD_RECORDER_BUFFER_SIZE];
+    ring_buf ring;
+    k_spinlock lock;
+    k_thread thread;
+    fs_file_t file;
+    char path[32]{""};
+    uint64_t start_us{0};
+    uint32_t count[TYPE_NUM]{}, dropped{0}, high_water{0}, write_errors{0}, written{0};
+    volatile bool recording{false}, running{false};
+} impl;
+
+int start(const shell *shell, size_t argc, char **argv)
+{
+    if (argc != 2) {
+        shell_error(shell, "Usage: %s %s <path>\n", argv[-1], argv[0]);
+        return 1;
+    }
+    if (int result{impl.start(argv[1])}; result != 0) {
+        shell_error(shell, "failed to start %s (%d)", argv[1], result);
+        return 1;
+    }
+    return 0;
+}
+
+int stop(const shell *shell, size_t argc, char **argv)
+{
+    impl.stop();
+    return 0;
+}
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(start, NULL, "Record the controller inputs, e.g. /SD:/rec.bin", start),
+    SHELL_CMD(stop, NULL, "Stop and close the file once the buffer is written", stop),
+    SHELL_CMD(info, NULL, "Recorder state and records per input", info),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(rec, &sub, "Input recorder commands", NULL);
+
+void record(uint8_t type, const void *data, size_t len)
+{
+    impl.record(type, data, len);
+}
+
+}
+
+#endif
+
+// vim: set expandtab shiftwidth=4:
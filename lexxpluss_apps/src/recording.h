@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/*
+ * Input recording format, shared by the recorder of the firmware and the
+ * replay of the simulated board, so it is plain C.  A file is one
+ * recording_file_header followed by records, each a recording_record_header
+ * and len bytes of payload, all little endian.
+ */
+
+#define RECORDING_MAGIC "LXRC"
+#define RECORDING_VERSION 1
+
+enum {
+    /* zcan_frame id (2), dlc (1) and dlc data bytes. */
+    RECORDING_CAN = 1,
+    /* recording_imu. */
+    RECORDING_IMU,
+    /* Raw 12 bit conversions of ADC_1 channels 8 to 13. */
+    RECORDING_ADC,
+    /* recording_uss. */
+    RECORDING_USS,
+    /* One PGV answer as read after a position request. */
+    RECORDING_PGV,
+    /* Bytes read by the rosserial UART ISRs. */
+    RECORDING_ROSSERIAL_RX,
+    RECORDING_ROSSERIAL_SERVICE_RX,
+    /* Outputs, written by the replay to compare two runs. */
+    RECORDING_OUT_ROSSERIAL_TX = 0x80,
+    RECORDING_OUT_CAN_TX
+};
+
+struct recording_file_header {
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+} __attribute__((packed));
+
+struct recording_record_header {
+    /* Since the start of the recording, wraps after 71 minutes. */
+    uint32_t stamp_us;
+    uint8_t type, len;
+} __attribute__((packed));
+
+/* As returned by the ADIS16470 driver: ax, ay, az, gx, gy, gz, temp. */
+struct recording_imu {
+    float value[7];
+} __attribute__((packed));
+
+/* MB1604_<channel>. */
+struct recording_uss {
+    uint8_t channel;
+    int32_t distance_mm;
+} __attribute__((packed));
+
+// vim: set expandtab shiftwidth=4:
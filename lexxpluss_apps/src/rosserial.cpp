@@ -25,17 +25,27 @@
 
 #include "rosserial_hardware_zephyr.hpp"
 #include "rosserial_actuator.hpp"
+#include "rosserial_blackbox.hpp"
 #include "rosserial_bmu.hpp"
 #include "rosserial_board.hpp"
+#include "rosserial_boot.hpp"
+#include "rosserial_config.hpp"
+#include "rosserial_diagnostics.hpp"
 #include "rosserial_dfu.hpp"
+#include "rosserial_health.hpp"
 #include "rosserial_imu.hpp"
 #include "rosserial_interlock.hpp"
+#include "rosserial_latency.hpp"
 #include "rosserial_led.hpp"
+#include "rosserial_link.hpp"
 #include "rosserial_pgv.hpp"
+#include "rosserial_thread_monitor.hpp"
 #include "rosserial_tof.hpp"
 #include "rosserial_uss.hpp"
 #include "rosserial.hpp"
 #include "rosserial_towing_unit.hpp"
+#include "rosserial_watchdog.hpp"
+#include "trace.hpp"
 
 namespace lexxhard::rosserial {
 
@@ -43,50 +53,89 @@ class {
 public:
     int init() {
         nh.getHardware()->set_baudrate(921600);
+        nh.getHardware()->set_trace(true);
         nh.initNode(const_cast<char*>("UART_6"));
         actuator.init(nh);
+        blackbox.init(nh);
         bmu.init(nh);
         board.init(nh);
+        boot.init(nh);
+        config.init(nh);
+        diagnostics.init(nh);
         dfu.init(nh);
+        health.init(nh);
         imu.init(nh);
         interlock.init(nh);
+        latency.init(nh);
         led.init(nh);
+        link.init(nh);
         pgv.init(nh);
+        thread_monitor.init(nh);
         tof.init(nh);
         uss.init(nh);
         towing_unit.init(nh);
+        watchdog.init(nh);
         return 0;
     }
     void run() {
+        watchdog_supervisor::declare(watchdog_supervisor::ROSSERIAL, "rosserial", 500, false);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::ROSSERIAL);
+            TRACE_BEGIN(ROSSERIAL);
             nh.spinOnce();
-            actuator.poll();
-            bmu.poll();
-            board.poll();
-            dfu.poll();
-            imu.poll();
-            interlock.poll();
-            led.poll();
-            pgv.poll();
-            tof.poll();
-            uss.poll();
-            towing_unit.poll();
+            TRACE_END(ROSSERIAL);
+            if (nh.connected())
+                boot::mark_connected();
+            poll(actuator, trace::PUBLISH_ACTUATOR);
+            poll(blackbox, trace::PUBLISH_BLACKBOX);
+            poll(bmu, trace::PUBLISH_BMU);
+            poll(board, trace::PUBLISH_BOARD);
+            poll(boot, trace::PUBLISH_BOOT);
+            poll(config, trace::PUBLISH_CONFIG);
+            poll(diagnostics, trace::PUBLISH_DIAGNOSTICS);
+            poll(dfu, trace::PUBLISH_DFU);
+            poll(health, trace::PUBLISH_HEALTH);
+            poll(imu, trace::PUBLISH_IMU);
+            poll(interlock, trace::PUBLISH_INTERLOCK);
+            poll(latency, trace::PUBLISH_LATENCY);
+            poll(led, trace::PUBLISH_LED);
+            poll(link, trace::PUBLISH_LINK);
+            poll(pgv, trace::PUBLISH_PGV);
+            poll(thread_monitor, trace::PUBLISH_THREAD_MONITOR);
+            poll(tof, trace::PUBLISH_TOF);
+            poll(uss, trace::PUBLISH_USS);
+            poll(towing_unit, trace::PUBLISH_TOWING_UNIT);
+            poll(watchdog, trace::PUBLISH_WATCHDOG);
             k_usleep(1);
         }
     }
 private:
+    template<typename T> static void poll(T &topic, uint8_t marker) {
+        trace::begin(marker);
+        topic.poll();
+        trace::end(marker);
+    }
     ros::NodeHandle nh;
     ros_actuator actuator;
+    ros_blackbox blackbox;
     ros_bmu bmu;
     ros_board board;
+    ros_boot boot;
+    ros_config config;
+    ros_diagnostics diagnostics;
     ros_dfu dfu;
+    ros_health health;
     ros_imu imu;
     ros_interlock interlock;
+    ros_latency latency;
     ros_led led;
+    ros_link link;
     ros_pgv pgv;
+    ros_thread_monitor thread_monitor;
     ros_tof tof;
     ros_uss uss;
     ros_towing_unit towing_unit;
+    ros_watchdog watchdog;
 } impl;
 
 void init()
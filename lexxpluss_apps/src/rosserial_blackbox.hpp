@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "ros/node_handle.h"
+#include "std_msgs/Empty.h"
+#include "std_msgs/UInt8MultiArray.h"
+#include "blackbox.hpp"
+
+namespace lexxhard {
+
+// A request on blackbox_dump freezes the ring and streams it oldest first,
+// CHUNK entries per message, ending with an empty message. The bytes are
+// the blackbox::entry slots as stored, the same as "blackbox save".
+class ros_blackbox {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        nh.subscribe(sub_dump);
+        nh.subscribe(sub_rearm);
+        msg.data = reinterpret_cast<uint8_t*>(msg_data);
+    }
+    void poll() {
+        if (!dumping)
+            return;
+        // Leave most of the link to the regular topics.
+        uint32_t now_cycle{k_cycle_get_32()};
+        if (k_cyc_to_ms_near32(now_cycle - prev_cycle) < 10)
+            return;
+        prev_cycle = now_cycle;
+        uint32_t n{0};
+        while (n < CHUNK && blackbox::get_entry(next_index, msg_data[n])) {
+            ++next_index;
+            ++n;
+        }
+        msg.data_length = n * sizeof msg_data[0];
+        pub.publish(&msg);
+        if (n == 0)
+            dumping = false;
+    }
+private:
+    void callback_dump(const std_msgs::Empty &req) {
+        blackbox::freeze();
+        next_index = 0;
+        dumping = true;
+    }
+    void callback_rearm(const std_msgs::Empty &req) {
+        dumping = false;
+        blackbox::rearm();
+    }
+    static constexpr uint32_t CHUNK{8};
+    std_msgs::UInt8MultiArray msg;
+    blackbox::entry msg_data[CHUNK];
+    uint32_t next_index{0}, prev_cycle{0};
+    bool dumping{false};
+    ros::Publisher pub{"/lexxhard/blackbox", &msg};
+    ros::Subscriber<std_msgs::Empty, ros_blackbox> sub_dump{"/lexxhard/blackbox_dump", &ros_blackbox::callback_dump, this};
+    ros::Subscriber<std_msgs::Empty, ros_blackbox> sub_rearm{"/lexxhard/blackbox_rearm", &ros_blackbox::callback_rearm, this};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include <limits>
 #include "ros/node_handle.h"
 #include "std_msgs/Bool.h"
 #include "std_msgs/Byte.h"
@@ -36,6 +37,8 @@
 #include "std_msgs/Float32.h"
 #include "lexxauto_msgs/BoardTemperatures.h"
 #include "can_controller.hpp"
+#include "emergency.hpp"
+#include "latency.hpp"
 
 namespace lexxhard {
 
@@ -62,8 +65,11 @@ public:
     void poll() {
         can_controller::msg_board message;
         while (k_msgq_get(&can_controller::msgq_board, &message, K_NO_WAIT) == 0) {
+            latency::record(latency::PATH_BOARD, latency::HOP_POLL, message.stamp_cycle);
             publish_fan(message);
             publish_bumper(message);
+            latency::record(latency::PATH_BOARD, latency::HOP_PUBLISH, message.stamp_cycle);
+            latency::tx_mark(latency::PATH_BOARD, message.stamp_cycle);
             publish_emergency(message);
             publish_charge(message);
             publish_temperature(message);
@@ -97,16 +103,19 @@ private:
         pub_charge.publish(&msg_charge);
     }
     void publish_temperature(const can_controller::msg_board &message) {
-        msg_temperature.main.temperature = message.main_board_temp;
+        msg_temperature.main.temperature = to_temperature(message.main_board_temp, message.main_board_temp_stale);
         msg_temperature.power.temperature = message.power_board_temp;
         // ROS:[center,left,right], ROBOT:[left,center,right]
-        msg_temperature.linear_actuator_center.temperature = message.actuator_board_temp[1];
-        msg_temperature.linear_actuator_left.temperature = message.actuator_board_temp[0];
-        msg_temperature.linear_actuator_right.temperature = message.actuator_board_temp[2];
+        msg_temperature.linear_actuator_center.temperature = to_temperature(message.actuator_board_temp[1], message.actuator_board_temp_stale[1]);
+        msg_temperature.linear_actuator_left.temperature = to_temperature(message.actuator_board_temp[0], message.actuator_board_temp_stale[0]);
+        msg_temperature.linear_actuator_right.temperature = to_temperature(message.actuator_board_temp[2], message.actuator_board_temp_stale[2]);
         msg_temperature.charge_plus.temperature = message.charge_connector_temp[0];
         msg_temperature.charge_minus.temperature = message.charge_connector_temp[1];
         pub_temperature.publish(&msg_temperature);
     }
+    float to_temperature(float value, bool stale) const {
+        return stale ? std::numeric_limits<float>::quiet_NaN() : value;
+    }
     void publish_power(const can_controller::msg_board &message) {
         msg_power.data = message.wait_shutdown ? message.shutdown_reason : 0;
         pub_power.publish(&msg_power);
@@ -120,6 +129,7 @@ private:
         pub_charge_voltage.publish(&msg_charge_voltage);
     }
     void callback_emergency(const std_msgs::Bool &req) {
+        emergency::set(emergency::ROS, req.data);
         ros2board.emergency_stop = req.data;
         while (k_msgq_put(&can_controller::msgq_control, &ros2board, K_NO_WAIT) != 0)
             k_msgq_purge(&can_controller::msgq_control);
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include "ros/node_handle.h"
+#include "std_msgs/String.h"
+#include "boot.hpp"
+
+namespace lexxhard {
+
+class ros_boot {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        msg.data = msg_data;
+    }
+    void poll() {
+        // Publish the timeline once, one stage per poll, after the host is connected.
+        uint32_t connected_ms{boot::get_connected_ms()};
+        if (connected_ms == 0 || index > boot::STAGE_NUM)
+            return;
+        const char *name;
+        uint32_t init_ms, loop_ms;
+        if (index == boot::STAGE_NUM) {
+            snprintf(msg_data, sizeof msg_data, "connected,%u,%u", connected_ms, connected_ms);
+            pub.publish(&msg);
+        } else if (boot::get_stage(index, name, init_ms, loop_ms)) {
+            snprintf(msg_data, sizeof msg_data, "%s,%u,%u", name, init_ms, loop_ms);
+            pub.publish(&msg);
+        }
+        ++index;
+    }
+private:
+    std_msgs::String msg;
+    char msg_data[64];
+    int index{0};
+    ros::Publisher pub{"/lexxhard/boot_timeline", &msg};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
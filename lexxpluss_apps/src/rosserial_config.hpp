@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include <cstring>
+#include "ros/node_handle.h"
+#include "std_msgs/String.h"
+#include "config.hpp"
+
+namespace lexxhard {
+
+// Parameter interface: "name=value" on config_set, a name (or empty for all)
+// on config_get, and every answer comes back on /lexxhard/config.
+class ros_config {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        nh.subscribe(sub_set);
+        nh.subscribe(sub_get);
+        msg.data = msg_data;
+    }
+    void poll() {
+        if (next_key < config::KEY_NUM && next_key <= last_key) {
+            config::format(next_key++, msg_data, sizeof msg_data);
+            pub.publish(&msg);
+        }
+    }
+private:
+    void callback_set(const std_msgs::String &req) {
+        char name[32];
+        const char *value{strchr(req.data, '=')};
+        size_t len{value == nullptr ? 0 : static_cast<size_t>(value - req.data)};
+        int result{-EINVAL};
+        if (len > 0 && len < sizeof name) {
+            memcpy(name, req.data, len);
+            name[len] = '\0';
+            result = config::set(config::find(name), value + 1);
+        }
+        if (result == 0) {
+            config::format(config::find(name), msg_data, sizeof msg_data);
+        } else {
+            snprintf(msg_data, sizeof msg_data, "error,%d,%s", result, req.data);
+        }
+        pub.publish(&msg);
+    }
+    void callback_get(const std_msgs::String &req) {
+        if (req.data[0] == '\0') {
+            next_key = 0;
+            last_key = config::KEY_NUM - 1;
+        } else if (int k{config::find(req.data)}; k >= 0) {
+            next_key = last_key = k;
+        } else {
+            snprintf(msg_data, sizeof msg_data, "error,%d,%s", -ENOENT, req.data);
+            pub.publish(&msg);
+        }
+    }
+    std_msgs::String msg;
+    char msg_data[64];
+    int next_key{config::KEY_NUM}, last_key{0};
+    ros::Publisher pub{"/lexxhard/config", &msg};
+    ros::Subscriber<std_msgs::String, ros_config> sub_set{"/lexxhard/config_set", &ros_config::callback_set, this};
+    ros::Subscriber<std_msgs::String, ros_config> sub_get{"/lexxhard/config_get", &ros_config::callback_get, this};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
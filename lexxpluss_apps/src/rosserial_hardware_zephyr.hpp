@@ -30,14 +30,35 @@
 #include <drivers/uart.h>
 #include <sys/ring_buffer.h>
 #include "ros/node_handle.h"
+#include "isr_timing.hpp"
+#include "latency.hpp"
+#include "recorder.hpp"
+#include "tcm.hpp"
+#include "trace.hpp"
+
+namespace lexxhard {
+
+// Byte counters of the link, rx_dropped counts bytes lost to a full RX ring
+// buffer and rx_errors the UART overrun, framing and noise errors.
+struct rosserial_link_stats {
+    uint32_t rx_bytes, rx_dropped, rx_errors, tx_bytes;
+};
+
+}
 
 namespace {
 
+// rosserial.cpp and rosserial_service.cpp each include this file once and own
+// a single node handle, so the buffers can live at namespace scope where
+// they can be placed in DTCM.
+TCM_BSS uint8_t rosserial_rbuf[CONFIG_LEXXHARD_ROSSERIAL_RX_BUFFER_SIZE];
+TCM_BSS uint8_t rosserial_tbuf[CONFIG_LEXXHARD_ROSSERIAL_TX_BUFFER_SIZE];
+
 class rosserial_hardware_zephyr {
 public:
     void init(const char *name) {
-        ring_buf_init(&ringbuf.rx, sizeof ringbuf.rbuf, ringbuf.rbuf);
-        ring_buf_init(&ringbuf.tx, sizeof ringbuf.tbuf, ringbuf.tbuf);
+        ring_buf_init(&ringbuf.rx, sizeof rosserial_rbuf, rosserial_rbuf);
+        ring_buf_init(&ringbuf.tx, sizeof rosserial_tbuf, rosserial_tbuf);
         uart_dev = device_get_binding(name);
         if (device_is_ready(uart_dev)) {
             uart_config config{
@@ -61,6 +82,12 @@ public:
     void set_baudrate(uint32_t baudrate) {
         this->baudrate = baudrate;
     }
+    void set_trace(bool trace) {
+        this->trace = trace;
+    }
+    void set_record_type(uint8_t record_type) {
+        this->record_type = record_type;
+    }
     int read() {
         uint8_t c;
         uint32_t n{ring_buf_get(&ringbuf.rx, &c, sizeof c)};
@@ -70,6 +97,8 @@ public:
         if (device_is_ready(uart_dev)) {
             while (length > 0) {
                 uint32_t n{ring_buf_put(&ringbuf.tx, data, length)};
+                if (trace)
+                    lexxhard::latency::tx_written(n);
                 uart_irq_tx_enable(uart_dev);
                 data += n;
                 length -= n;
@@ -79,27 +108,46 @@ public:
     unsigned long time() {
         return k_uptime_get_32();
     }
+    const lexxhard::rosserial_link_stats &get_stats() const {
+        return stats;
+    }
 private:
-    void uart_isr() {
+    TCM_CODE void uart_isr() {
+        uint32_t begin_cycle{lexxhard::isr_timing::begin()};
+        TRACE_BEGIN(ROSSERIAL_ISR);
         while (uart_irq_update(uart_dev) && uart_irq_is_pending(uart_dev)) {
             uint8_t buf[64];
             if (uart_irq_rx_ready(uart_dev)) {
-                if (int n{uart_fifo_read(uart_dev, buf, sizeof buf)}; n > 0)
-                    ring_buf_put(&ringbuf.rx, buf, n);
+                if (int n{uart_fifo_read(uart_dev, buf, sizeof buf)}; n > 0) {
+                    uint32_t put{ring_buf_put(&ringbuf.rx, buf, n)};
+                    stats.rx_bytes += n;
+                    stats.rx_dropped += n - put;
+                    lexxhard::recorder::record(record_type, buf, n);
+                }
+                if (int err{uart_err_check(uart_dev)}; err > 0)
+                    ++stats.rx_errors;
             }
             if (uart_irq_tx_ready(uart_dev)) {
-                if (uint32_t n{ring_buf_get(&ringbuf.tx, buf, 1)}; n > 0)
+                if (uint32_t n{ring_buf_get(&ringbuf.tx, buf, 1)}; n > 0) {
                     uart_fifo_fill(uart_dev, buf, n);
+                    stats.tx_bytes += n;
+                    if (trace)
+                        lexxhard::latency::tx_drained(n);
+                }
             }
             if (uart_irq_tx_complete(uart_dev))
                 uart_irq_tx_disable(uart_dev);
         }
+        TRACE_END(ROSSERIAL_ISR);
+        lexxhard::isr_timing::end(lexxhard::isr_timing::ROSSERIAL_UART, begin_cycle);
     }
     struct {
         ring_buf rx, tx;
-        uint8_t rbuf[1024], tbuf[1024];
     } ringbuf;
+    lexxhard::rosserial_link_stats stats{0, 0, 0, 0};
     uint32_t baudrate{57600};
+    uint8_t record_type{RECORDING_ROSSERIAL_RX};
+    bool trace{false};
     const device* uart_dev{nullptr};
 };
 
@@ -107,7 +155,8 @@ private:
 
 namespace ros {
 
-typedef NodeHandle_<rosserial_hardware_zephyr> NodeHandle;
+// The bridge advertises more topics than the default 25 publisher slots.
+typedef NodeHandle_<rosserial_hardware_zephyr, 25, 40, 512, 512> NodeHandle;
 
 }
 
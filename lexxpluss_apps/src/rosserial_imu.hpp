@@ -29,6 +29,7 @@
 #include "ros/node_handle.h"
 #include "lexxauto_msgs/Imu.h"
 #include "imu_controller.hpp"
+#include "latency.hpp"
 
 namespace lexxhard {
 
@@ -40,6 +41,7 @@ public:
     void poll() {
         imu_controller::msg message;
         while (k_msgq_get(&imu_controller::msgq, &message, K_NO_WAIT) == 0) {
+            latency::record(latency::PATH_IMU, latency::HOP_POLL, message.stamp_cycle);
             msg.gyro.x = message.gyro[0];
             msg.gyro.y = message.gyro[1];
             msg.gyro.z = message.gyro[2];
@@ -53,6 +55,8 @@ public:
             msg.vel.y = message.delta_vel[1];
             msg.vel.z = message.delta_vel[2];
             pub.publish(&msg);
+            latency::record(latency::PATH_IMU, latency::HOP_PUBLISH, message.stamp_cycle);
+            latency::tx_mark(latency::PATH_IMU, message.stamp_cycle);
         }
     }
 private:
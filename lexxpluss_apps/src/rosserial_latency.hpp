@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cstdio>
+#include "ros/node_handle.h"
+#include "std_msgs/String.h"
+#include "latency.hpp"
+
+namespace lexxhard {
+
+class ros_latency {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        msg.data = msg_data;
+    }
+    void poll() {
+        uint32_t now_cycle{k_cycle_get_32()};
+        if (k_cyc_to_ms_near32(now_cycle - prev_cycle) < 1000)
+            return;
+        prev_cycle = now_cycle;
+        for (int i{0}; i < latency::PATH_NUM; ++i) {
+            for (int j{0}; j < latency::HOP_NUM; ++j) {
+                if (latency::summary s; latency::get_summary(i, j, s)) {
+                    snprintf(msg_data, sizeof msg_data, "%s,%s,%u,%u,%u,%u,%u",
+                             latency::get_path_name(i), latency::get_hop_name(j),
+                             s.count, s.min_us, s.p50_us, s.p99_us, s.max_us);
+                    pub.publish(&msg);
+                }
+            }
+        }
+    }
+private:
+    std_msgs::String msg;
+    char msg_data[80];
+    uint32_t prev_cycle{0};
+    ros::Publisher pub{"/lexxhard/latency", &msg};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
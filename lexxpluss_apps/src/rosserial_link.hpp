@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include "ros/node_handle.h"
+#include "std_msgs/UInt32MultiArray.h"
+
+namespace lexxhard {
+
+// Counters of the rosserial UART once per second, read by
+// scripts/rosserial_soak.py.
+class ros_link {
+public:
+    void init(ros::NodeHandle &nh) {
+        nh.advertise(pub);
+        stats = &nh.getHardware()->get_stats();
+        msg.data = msg_data;
+        msg.data_length = sizeof msg_data / sizeof msg_data[0];
+    }
+    void poll() {
+        uint32_t now_cycle{k_cycle_get_32()};
+        if (k_cyc_to_ms_near32(now_cycle - prev_cycle) < 1000)
+            return;
+        prev_cycle = now_cycle;
+        // [rx_bytes, rx_dropped, rx_errors, tx_bytes]
+        msg.data[0] = stats->rx_bytes;
+        msg.data[1] = stats->rx_dropped;
+        msg.data[2] = stats->rx_errors;
+        msg.data[3] = stats->tx_bytes;
+        pub.publish(&msg);
+    }
+private:
+    std_msgs::UInt32MultiArray msg;
+    uint32_t msg_data[4]{0};
+    uint32_t prev_cycle{0};
+    const rosserial_link_stats *stats{nullptr};
+    ros::Publisher pub{"/lexxhard/rosserial_link", &msg};
+};
+
+}
+
+// vim: set expandtab shiftwidth=4:
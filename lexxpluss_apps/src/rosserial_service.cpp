@@ -26,19 +26,27 @@
 #include "rosserial_hardware_zephyr.hpp"
 #include "rosserial_actuator_service.hpp"
 #include "rosserial_service.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::rosserial_service {
 
 class {
 public:
     int init() {
+        nh.getHardware()->set_record_type(RECORDING_ROSSERIAL_SERVICE_RX);
         nh.initNode(const_cast<char*>("UART_2"));
         actuator_service.init(nh);
         return 0;
     }
     void run() {
+        // Actuator location services block for up to 30s.
+        watchdog_supervisor::declare(watchdog_supervisor::ROSSERIAL_SERVICE, "rosserial_service", 31000, false);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::ROSSERIAL_SERVICE);
+            TRACE_BEGIN(ROSSERIAL_SERVICE);
             nh.spinOnce();
+            TRACE_END(ROSSERIAL_SERVICE);
             k_usleep(1);
         }
     }
@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include <limits>
 #include "ros/node_handle.h"
 #include "std_msgs/Float64MultiArray.h"
 #include "tof_controller.hpp"
@@ -42,13 +43,18 @@ public:
     void poll() {
         tof_controller::msg message;
         while (k_msgq_get(&tof_controller::msgq, &message, K_NO_WAIT) == 0) {
-            static constexpr float meter_per_volt{0.7575f};
-            msg.data[0] = message.left * 1e-3f * meter_per_volt;
-            msg.data[1] = message.right * 1e-3f * meter_per_volt;
+            msg.data[0] = to_meter(message.left, message.left_stale);
+            msg.data[1] = to_meter(message.right, message.right_stale);
             pub.publish(&msg);
         }
     }
 private:
+    double to_meter(int32_t mv, bool stale) const {
+        if (stale)
+            return std::numeric_limits<double>::quiet_NaN();
+        static constexpr float meter_per_volt{0.7575f};
+        return mv * 1e-3f * meter_per_volt;
+    }
     std_msgs::Float64MultiArray msg;
     double msg_data[2];
     ros::Publisher pub{"/sensor_set/downward", &msg};
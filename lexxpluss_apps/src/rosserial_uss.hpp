@@ -26,6 +26,7 @@
 #pragma once
 
 #include <zephyr.h>
+#include <limits>
 #include "ros/node_handle.h"
 #include "std_msgs/Float64MultiArray.h"
 #include "uss_controller.hpp"
@@ -42,15 +43,19 @@ public:
     void poll() {
         uss_controller::msg message;
         while (k_msgq_get(&uss_controller::msgq, &message, K_NO_WAIT) == 0) {
-            msg.data[0] = message.front_left * 1e-3f;
-            msg.data[1] = message.front_right * 1e-3f;
-            msg.data[2] = message.left * 1e-3f;
-            msg.data[3] = message.right * 1e-3f;
-            msg.data[4] = message.back * 1e-3f;
+            msg.data[0] = to_meter(message.front_left, message.stale & message.STALE_FRONT_LEFT);
+            msg.data[1] = to_meter(message.front_right, message.stale & message.STALE_FRONT_RIGHT);
+            msg.data[2] = to_meter(message.left, message.stale & message.STALE_LEFT);
+            msg.data[3] = to_meter(message.right, message.stale & message.STALE_RIGHT);
+            msg.data[4] = to_meter(message.back, message.stale & message.STALE_BACK);
             pub.publish(&msg);
         }
     }
 private:
+    double to_meter(uint32_t mm, bool stale) const {
+        // A stale channel is published as NaN so that it is never mistaken for a valid distance.
+        return stale ? std::numeric_limits<double>::quiet_NaN() : mm * 1e-3f;
+    }
     std_msgs::Float64MultiArray msg;
     double msg_data[5];
     ros::Publisher pub{"/sensor_set/ultrasonic", &msg};
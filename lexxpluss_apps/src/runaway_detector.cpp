@@ -26,102 +26,19 @@
 #include <zephyr.h>
 #include <logging/log.h>
 #include <cstdio>
-#include <cmath>
-#include <queue>
 #include "common.hpp"
+#include "config.hpp"
+#include "emergency.hpp"
+#include "periodic.hpp"
 #include "runaway_detector.hpp"
+#include "trace.hpp"
+#include "watchdog_supervisor.hpp"
+#include "yaw_checker.hpp"
 
-namespace {
+namespace lexxhard::runaway_detector {
 
 LOG_MODULE_REGISTER(runaway_detector);
 
-class yaw_checker {
-public:
-    void new_topic(float vz, uint32_t current_cycle) {
-        bool detected{yaw_error_detected(vz, current_cycle)};
-        if (!last_detected && detected) {
-            snprintf(log_buffer, sizeof log_buffer, "Emergency! ACC:%4.2f VEL:%4.2f DELTA:%4.2f\n", avg_yaw_accel, avg_yaw_velocity, sum_yaw_delta_theta);
-            LOG_ERR("%s", log_strdup(log_buffer));
-            // @@ do something. (emergency stop, etc.)
-        }
-        last_detected = detected;
-    }
-private:
-    bool yaw_error_detected(float vz, uint32_t current_cycle) {
-        if (!init_done)
-            init();
-        delta_theta_calculator(vz, current_cycle);
-        yaw_accel_calculator(vz, current_cycle);
-        yaw_velocity_calculator(vz, current_cycle);
-        if (sum_yaw_delta_theta > YAW_DELTA_THETA_LIMIT)
-            return true;
-        else if ((avg_yaw_accel > 1 && avg_yaw_velocity > 1) || (avg_yaw_accel < -1 && avg_yaw_velocity < -1))//In other words, "if speeding up "... values are compared to 1 in order to ignore small random inputs
-            return fabsf(avg_yaw_accel) > YAW_ACCEL_LIMIT;
-        else
-            return false;
-    }
-    void init() {
-        for (int i{0}; i < SIZE_OF_TOPICS_QUEUE; ++i)
-            topics.push(topic{.vz{0.0f}, .cycle{0U}});
-        for (int i{0}; i < SIZE_OF_YAW_ACCEL_QUEUE; ++i)
-            yaw_accel.push(0.0f);
-        for (int i{0}; i < SIZE_OF_YAW_VELOCITY_QUEUE; ++i)
-            yaw_velocity.push(0.0f);
-        for (int i{0}; i < SIZE_OF_YAW_DELTA_THETA_QUEUE; ++i)
-            yaw_delta_theta.push(0.0f);
-        init_done = true;
-    }
-    void yaw_accel_calculator(float vz, uint32_t current_cycle) {//here, can calculate whether the robot is speeding up (rotation wise) using both velocity and acceleration
-        topics.pop();
-        topics.push(topic{.vz{vz}, .cycle{current_cycle}});
-        topic temp_a{topics.front()}, temp_b{topics.back()};
-        float dt {static_cast<float>(k_cyc_to_ms_near32(temp_b.cycle - temp_a.cycle)) / 1000.0f};
-        avg_yaw_accel -= yaw_accel.front();
-        yaw_accel.pop();
-        yaw_accel.push(((temp_b.vz - temp_a.vz) / dt) / SIZE_OF_YAW_ACCEL_QUEUE);//1000.f to convert ms to sec
-        avg_yaw_accel += yaw_accel.back();
-    }
-    void yaw_velocity_calculator(float vz, uint32_t current_cycle) {
-        avg_yaw_velocity -= yaw_velocity.front();
-        yaw_velocity.pop();
-        yaw_velocity.push(vz / SIZE_OF_YAW_VELOCITY_QUEUE);
-        avg_yaw_velocity += yaw_velocity.back();
-    }
-    void delta_theta_calculator(float vz, uint32_t current_cycle) {
-        float dt{static_cast<float>(k_cyc_to_ms_near32(current_cycle - prev_cycle)) / 1000.0f};
-        sum_yaw_delta_theta -= yaw_delta_theta.front();
-        yaw_delta_theta.pop();
-        yaw_delta_theta.push(fabsf(vz * dt));
-        sum_yaw_delta_theta += yaw_delta_theta.back();
-        prev_cycle = current_cycle;
-    }
-    struct topic {
-        float vz;
-        uint32_t cycle;
-    };
-    std::queue<topic> topics;
-    std::queue<float> yaw_accel;
-    std::queue<float> yaw_velocity;
-    std::queue<float> yaw_delta_theta;
-    bool init_done{false};
-    uint32_t prev_cycle{0U};
-    float avg_yaw_accel{0.0f};
-    float avg_yaw_velocity{0.0f};
-    float sum_yaw_delta_theta{0.0f};
-    char log_buffer[256]{0};
-    bool last_detected{false};
-    static constexpr float YAW_ACCEL_LIMIT{1.5f * M_PI};
-    static constexpr float YAW_DELTA_THETA_LIMIT{2.5f * M_PI};
-    static constexpr uint8_t SIZE_OF_TOPICS_QUEUE{10U};//average of ~200ms at 50Hz
-    static constexpr uint8_t SIZE_OF_YAW_ACCEL_QUEUE{50U};//average of ~1000ms at 50Hz
-    static constexpr uint8_t SIZE_OF_YAW_VELOCITY_QUEUE{50U};//average of ~1000ms at 50Hz
-    static constexpr uint8_t SIZE_OF_YAW_DELTA_THETA_QUEUE{125U};//average of ~2500ms at 50Hz
-};
-
-}
-
-namespace lexxhard::runaway_detector {
-
 class {
 public:
     int init() {
@@ -129,15 +46,32 @@ public:
         return 0;
     }
     void run() {
+        watchdog_supervisor::declare(watchdog_supervisor::RUNAWAY_DETECTOR, "runaway_detector", 500, true);
+        periodic::start(periodic::RUNAWAY_DETECTOR);
         while (true) {
+            watchdog_supervisor::checkin(watchdog_supervisor::RUNAWAY_DETECTOR);
             if (msg message; k_msgq_get(&msgq, &message, K_MSEC(100)) == 0) {
                 uint32_t current_cycle{k_cycle_get_32()};
-                yaw.new_topic(message.gyro[2], current_cycle);
+                TRACE_BEGIN(RUNAWAY_DETECTOR);
+                new_topic(message.gyro[2], current_cycle);
+                TRACE_END(RUNAWAY_DETECTOR);
             }
         }
     }
 private:
+    void new_topic(float vz, uint32_t current_cycle) {
+        bool detected{yaw.detect(vz, current_cycle, config::get_float(config::RUNAWAY_YAW_ACCEL_LIMIT))};
+        if (!last_detected && detected) {
+            snprintf(log_buffer, sizeof log_buffer, "Emergency! ACC:%4.2f VEL:%4.2f DELTA:%4.2f\n",
+                     yaw.get_avg_yaw_accel(), yaw.get_avg_yaw_velocity(), yaw.get_sum_yaw_delta_theta());
+            LOG_ERR("%s", log_strdup(log_buffer));
+            emergency::set(emergency::RUNAWAY, true);
+        }
+        last_detected = detected;
+    }
     yaw_checker yaw;
+    char log_buffer[256]{0};
+    bool last_detected{false};
     char __aligned(4) msgq_buffer[8 * sizeof (msg)]{0};
 } impl;
 
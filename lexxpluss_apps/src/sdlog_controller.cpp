@@ -31,6 +31,9 @@
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include "config.hpp"
+#include "diagnostics.hpp"
+#include "name_list.hpp"
 #include "sdlog_controller.hpp"
 
 namespace lexxhard::sdlog_controller {
@@ -41,19 +44,17 @@ char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 
 class directory_list {
 public:
-    enum class ORDER {ASCENT, DESCENT};
-    directory_list() {
-        reset();
-    }
+    static constexpr uint32_t MAX_ENTRIES{30};
+    using ORDER = name_list<MAX_ENTRIES, MAX_FILE_NAME + 1>::ORDER;
     uint32_t list(const char *path, ORDER order = ORDER::ASCENT) {
         uint32_t count{0};
-        reset();
+        entries.reset();
         fs_dir_t dir;
         fs_dir_t_init(&dir);
         if (fs_opendir(&dir, path) == 0) {
             while (fs_readdir(&dir, &dirent) == 0 && dirent.name[0] != 0) {
                 if (dirent.type == FS_DIR_ENTRY_FILE) {
-                    push(order, dirent.name);
+                    entries.push(order, dirent.name);
                     ++count;
                 }
             }
@@ -64,37 +65,9 @@ public:
     const char *operator[](int index) const {
         return entries[index];
     }
-    static constexpr uint32_t MAX_ENTRIES{30};
 private:
-    void reset() {
-        for (auto &i : entries)
-            i[0] = '\0';
-    }
-    void push(ORDER order, const char* str) {
-        for (uint32_t i{0}; i < MAX_ENTRIES; ++i) {
-            if (entries[i][0] == 0) {
-                stor(entries[i], str);
-                break;
-            } else {
-                int comp{strcmp(str, entries[i])};
-                if ((order == ORDER::ASCENT && comp < 0) ||
-                    (order == ORDER::DESCENT && comp > 0)) {
-                    for (uint32_t j{MAX_ENTRIES - 1}; j > i; --j) {
-                        if (entries[j - 1][0] != 0)
-                            stor(entries[j], entries[j - 1]);
-                    }
-                    stor(entries[i], str);
-                    break;
-                }
-            }
-        }
-    }
-    void stor(char *to, const char *from) const {
-        snprintf(to, MAX_FNAME, "%s", from);
-    }
     fs_dirent dirent;
-    static constexpr uint32_t MAX_FNAME{MAX_FILE_NAME + 1};
-    char entries[MAX_ENTRIES][MAX_FNAME];
+    name_list<MAX_ENTRIES, MAX_FILE_NAME + 1> entries;
 };
 
 class log_util {
@@ -149,15 +122,15 @@ private:
         }
     }
     void reduce_disk_volume(const char *root) {
-        int32_t freeMB{get_freeMB(root)};
-        if (freeMB > 0 && freeMB < MIN_FREE_MB) {
+        int32_t freeMB{get_freeMB(root)}, min_free_mb{config::get_int(config::SDLOG_MIN_FREE_MB)};
+        if (freeMB > 0 && freeMB < min_free_mb) {
             list.list(workpath);
             for (uint32_t i{0}; i < list.MAX_ENTRIES; ++i) {
                 const char *name{list[i]};
                 if (name[0] != '\0') {
                     snprintf(workpath, sizeof workpath, "%s/log/%s", root, name);
                     fs_unlink(workpath);
-                    if (get_freeMB(root) >= MIN_FREE_MB)
+                    if (get_freeMB(root) >= min_free_mb)
                         break;
                 }
             }
@@ -185,7 +158,6 @@ private:
     directory_list list;
     fs_file_t logfp;
     char workpath[PATH_MAX], workpath2[PATH_MAX];
-    static constexpr int32_t MIN_FREE_MB{1024};
     static constexpr uint32_t MAX_FILE_COUNT{500};
 };
 
@@ -202,18 +174,24 @@ public:
             mount.fs_data = &fatfs;
             mount.mnt_point = sdroot;
             if (fs_mount(&mount) == 0) {
+                // Before the log area upkeep, it reads sdlog.min_free_mb.
+                config::load(sdroot);
                 util.init(sdroot);
                 util.maintain_log_area(sdroot);
                 util.setup_new_log(sdroot);
                 fs_ok = true;
             }
         }
-        if (!fs_ok)
+        if (!fs_ok) {
+            diagnostics::report(diagnostics::SDLOG, diagnostics::WARN, diagnostics::CODE_NO_MEDIA);
             return;
+        }
         while (true) {
             msg message;
             if (k_msgq_get(&msgq, &message, K_MSEC(1000)) == 0)
                 util.write(message.message);
+            // The card is only touched from this thread.
+            config::save();
         }
     }
 private:
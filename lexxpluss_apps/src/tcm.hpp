@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <devicetree.h>
+
+// Placement of hot ISR code and the buffers it touches.  When the board
+// devicetree chooses zephyr,itcm and zephyr,dtcm, the Zephyr linker script
+// already provides the .itcm and .dtcm_* output sections and copies or
+// zeroes them at boot; otherwise code falls back to a SRAM ramfunc and data
+// stays in the default sections.  Without CONFIG_LEXXHARD_TCM, the default,
+// everything stays in flash.
+
+#if defined(CONFIG_LEXXHARD_TCM) && DT_NODE_HAS_STATUS(DT_CHOSEN(zephyr_itcm), okay)
+// ITCM is far from flash, so calls into it must not use a short branch.
+#define TCM_CODE __attribute__((section(".itcm"), noinline, long_call))
+#elif defined(CONFIG_LEXXHARD_TCM) && defined(CONFIG_ARCH_HAS_RAMFUNC_SUPPORT)
+#define TCM_CODE __ramfunc
+#else
+#define TCM_CODE
+#endif
+
+#if defined(CONFIG_LEXXHARD_TCM) && DT_NODE_HAS_STATUS(DT_CHOSEN(zephyr_dtcm), okay)
+#define TCM_DATA __attribute__((section(".dtcm_data")))
+#define TCM_BSS __attribute__((section(".dtcm_bss")))
+#else
+#define TCM_DATA
+#define TCM_BSS
+#endif
+
+// vim: set expandtab shiftwidth=4:
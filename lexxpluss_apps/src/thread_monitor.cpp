@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include <cstdio>
+#include <cstring>
+#include "thread_monitor.hpp"
+
+namespace lexxhard::thread_monitor {
+
+LOG_MODULE_REGISTER(thread_monitor);
+
+char __aligned(4) msgq_buffer[CONFIG_LEXXHARD_THREAD_MONITOR_SLOTS * sizeof (msg)];
+
+struct slot {
+    const k_thread *thread;
+    uint64_t prev_execution_cycles;
+    uint32_t switches, prev_switches;
+    uint32_t switched_in_cycle, max_burst_cycles;
+    msg snapshot;
+};
+
+struct switch_cost {
+    uint32_t count, max_cycles;
+    uint64_t sum_cycles;
+};
+
+class thread_monitor_impl {
+public:
+    int init() {
+        k_msgq_init(&msgq, msgq_buffer, sizeof (msg), CONFIG_LEXXHARD_THREAD_MONITOR_SLOTS);
+        return 0;
+    }
+    void run() {
+        prev_cycle = k_cycle_get_32();
+        while (true) {
+            k_msleep(1000);
+            k_thread_foreach(attach, this);
+            uint32_t now_cycle{k_cycle_get_32()};
+            uint32_t period_cycles{now_cycle - prev_cycle};
+            prev_cycle = now_cycle;
+            for (uint32_t i{0}; i < num_slots; ++i)
+                update(slots[i], period_cycles);
+        }
+    }
+    void top(const shell *shell) const {
+        shell_print(shell, "%-16s %10s %6s %7s %10s %9s",
+                    "name", "cycles", "cpu%", "wakeup", "switch", "burst(us)");
+        for (uint32_t i{0}; i < num_slots; ++i) {
+            const msg &m{slots[i].snapshot};
+            shell_print(shell, "%-16s %10u %4u.%u %7u %10u %9u",
+                        m.name, m.cycles, m.utilization / 10, m.utilization % 10,
+                        m.wakeups, m.switches, m.max_burst_us);
+        }
+    }
+    void stack(const shell *shell) const {
+        shell_print(shell, "%-16s %6s %6s %5s", "name", "size", "used", "used%");
+        for (uint32_t i{0}; i < num_slots; ++i) {
+            const msg &m{slots[i].snapshot};
+            shell_print(shell, "%-16s %6u %6u %4u%%",
+                        m.name, m.stack_size, m.stack_used,
+                        m.stack_size == 0 ? 0 : m.stack_used * 100 / m.stack_size);
+        }
+    }
+    // Cost of a switch by the FP state of the outgoing thread, which is
+    // what lazy stacking saves on the threads started without K_FP_REGS.
+    void switch_cost_info(const shell *shell) const {
+        static const char *const kind[]{"integer", "fp"};
+        shell_print(shell, "%-8s %10s %8s %8s", "out", "count", "avg(ns)", "max(ns)");
+        for (int i{0}; i < 2; ++i) {
+            const switch_cost &c{cost[i]};
+            uint32_t avg{c.count == 0 ? 0 : static_cast<uint32_t>(c.sum_cycles / c.count)};
+            shell_print(shell, "%-8s %10u %8u %8u",
+                        kind[i], c.count, k_cyc_to_ns_near32(avg), k_cyc_to_ns_near32(c.max_cycles));
+        }
+    }
+    void reset() {
+        for (uint32_t i{0}; i < num_slots; ++i)
+            slots[i].max_burst_cycles = 0;
+        for (auto &i : cost)
+            i = switch_cost{};
+    }
+    // Called from the scheduler with interrupts locked.
+    void switched_in(k_thread *thread) {
+        if (prev_thread != nullptr) {
+            // Time between the two hooks covers the register save and restore.
+            uint32_t cycles{k_cycle_get_32() - switched_out_cycle};
+            switch_cost &c{cost[uses_fp(prev_thread) ? 1 : 0]};
+            ++c.count;
+            c.sum_cycles += cycles;
+            if (c.max_cycles < cycles)
+                c.max_cycles = cycles;
+            prev_thread = nullptr;
+        }
+        if (auto *s{static_cast<slot*>(thread->custom_data)}; s != nullptr) {
+            s->switched_in_cycle = k_cycle_get_32();
+            ++s->switches;
+        }
+    }
+    void switched_out(k_thread *thread) {
+        if (auto *s{static_cast<slot*>(thread->custom_data)}; s != nullptr) {
+            uint32_t burst{k_cycle_get_32() - s->switched_in_cycle};
+            if (s->max_burst_cycles < burst)
+                s->max_burst_cycles = burst;
+        }
+        prev_thread = thread;
+        switched_out_cycle = k_cycle_get_32();
+    }
+private:
+    static bool uses_fp(const k_thread *thread) {
+#ifdef CONFIG_ARM_STORE_EXC_RETURN
+        // EXC_RETURN bit 4 is cleared when the thread's FP context was stacked.
+        return (thread->arch.mode_exc_return & BIT(4)) == 0;
+#else
+        return (thread->base.user_options & K_FP_REGS) != 0;
+#endif
+    }
+    static void attach(const k_thread *thread, void *user_data) {
+        auto *self{static_cast<thread_monitor_impl*>(user_data)};
+        if (thread->custom_data != nullptr || self->num_slots >= CONFIG_LEXXHARD_THREAD_MONITOR_SLOTS)
+            return;
+        slot &s{self->slots[self->num_slots++]};
+        s.thread = thread;
+        const char *name{k_thread_name_get(const_cast<k_thread*>(thread))};
+        if (name != nullptr && name[0] != '\0')
+            strncpy(s.snapshot.name, name, sizeof s.snapshot.name - 1);
+        else
+            snprintf(s.snapshot.name, sizeof s.snapshot.name, "%p", thread);
+        const_cast<k_thread*>(thread)->custom_data = &s;
+    }
+    void update(slot &s, uint32_t period_cycles) {
+        k_thread_runtime_stats_t stats;
+        if (k_thread_runtime_stats_get(const_cast<k_thread*>(s.thread), &stats) != 0)
+            return;
+        uint32_t cycles{static_cast<uint32_t>(stats.execution_cycles - s.prev_execution_cycles)};
+        s.prev_execution_cycles = stats.execution_cycles;
+        uint32_t switches{s.switches};
+        msg &m{s.snapshot};
+        m.cycles = cycles;
+        m.utilization = period_cycles == 0 ? 0 : static_cast<uint64_t>(cycles) * 1000 / period_cycles;
+        m.wakeups = switches - s.prev_switches;
+        m.switches = switches;
+        m.max_burst_us = k_cyc_to_us_near32(s.max_burst_cycles);
+        s.prev_switches = switches;
+        if (size_t unused; k_thread_stack_space_get(s.thread, &unused) == 0) {
+            m.stack_size = s.thread->stack_info.size;
+            m.stack_used = m.stack_size - unused;
+        }
+        while (k_msgq_put(&msgq, &m, K_NO_WAIT) != 0)
+            k_msgq_purge(&msgq);
+    }
+    slot slots[CONFIG_LEXXHARD_THREAD_MONITOR_SLOTS]{};
+    uint32_t num_slots{0}, prev_cycle{0};
+    switch_cost cost[2]{};
+    const k_thread *prev_thread{nullptr};
+    uint32_t switched_out_cycle{0};
+} impl;
+
+int top(const shell *shell, size_t argc, char **argv)
+{
+    impl.top(shell);
+    return 0;
+}
+
+int stack(const shell *shell, size_t argc, char **argv)
+{
+    impl.stack(shell);
+    return 0;
+}
+
+int switch_cost_info(const shell *shell, size_t argc, char **argv)
+{
+    impl.switch_cost_info(shell);
+    return 0;
+}
+
+int reset(const shell *shell, size_t argc, char **argv)
+{
+    impl.reset();
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(top, NULL, "Per-thread CPU usage", top),
+    SHELL_CMD(stack, NULL, "Per-thread stack high-water mark", stack),
+    SHELL_CMD(switch, NULL, "Context switch cost by outgoing FP state", switch_cost_info),
+    SHELL_CMD(reset, NULL, "Reset longest burst and switch cost", reset),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(thread, &sub, "Thread monitor commands", NULL);
+
+void init()
+{
+    impl.init();
+}
+
+void run(void *p1, void *p2, void *p3)
+{
+    impl.run();
+}
+
+k_thread thread;
+k_msgq msgq;
+
+}
+
+#ifdef CONFIG_TRACING_USER
+extern "C" {
+
+void sys_trace_thread_switched_in_user(k_thread *thread)
+{
+    lexxhard::thread_monitor::impl.switched_in(thread);
+}
+
+void sys_trace_thread_switched_out_user(k_thread *thread)
+{
+    lexxhard::thread_monitor::impl.switched_out(thread);
+}
+
+}
+#endif  // CONFIG_TRACING_USER
+
+// vim: set expandtab shiftwidth=4:
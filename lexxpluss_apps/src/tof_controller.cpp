@@ -27,6 +27,9 @@
 #include <logging/log.h>
 #include <shell/shell.h>
 #include "adc_reader.hpp"
+#include "blackbox.hpp"
+#include "config.hpp"
+#include "emergency.hpp"
 #include "tof_controller.hpp"
 
 namespace lexxhard::tof_controller {
@@ -35,11 +38,19 @@ LOG_MODULE_REGISTER(tof);
 
 char __aligned(4) msgq_buffer[8 * sizeof (msg)];
 
+// Same scale as ros_tof, 0.7575 m/V.
+int32_t to_mm(int32_t mv)
+{
+    return mv * 7575 / 10000;
+}
+
 int info(const shell *shell, size_t argc, char **argv)
 {
-    shell_print(shell, "L:%dmV R:%dmV",
+    shell_print(shell, "L:%dmV R:%dmV stale:%d/%d",
                 adc_reader::get(adc_reader::DOWNWARD_L),
-                adc_reader::get(adc_reader::DOWNWARD_R));
+                adc_reader::get(adc_reader::DOWNWARD_R),
+                adc_reader::is_stale(adc_reader::DOWNWARD_L),
+                adc_reader::is_stale(adc_reader::DOWNWARD_R));
     return 0;
 }
 
@@ -54,19 +65,29 @@ void init()
     k_msgq_init(&msgq, msgq_buffer, sizeof (msg), 8);
 }
 
-void run(void *p1, void *p2, void *p3)
+void poll()
 {
-    while (true) {
-        msg message;
-        message.left = adc_reader::get(adc_reader::DOWNWARD_L);
-        message.right = adc_reader::get(adc_reader::DOWNWARD_R);
-        while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq);
-        k_msleep(20);
+    msg message;
+    message.left = adc_reader::get(adc_reader::DOWNWARD_L);
+    message.right = adc_reader::get(adc_reader::DOWNWARD_R);
+    message.left_stale = adc_reader::is_stale(adc_reader::DOWNWARD_L);
+    message.right_stale = adc_reader::is_stale(adc_reader::DOWNWARD_R);
+    while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
+        k_msgq_purge(&msgq);
+    blackbox::tof_sample sample{
+        static_cast<int16_t>(message.left),
+        static_cast<int16_t>(message.right),
+        static_cast<uint8_t>(message.left_stale | (message.right_stale << 1))
+    };
+    blackbox::record(blackbox::TOF, &sample, sizeof sample);
+    // Floor farther than the limit on either side, 0 disables the check.
+    if (int32_t limit_mm{config::get_int(config::TOF_CLIFF_MM)}; limit_mm > 0) {
+        bool cliff{(!message.left_stale && to_mm(message.left) > limit_mm) ||
+                   (!message.right_stale && to_mm(message.right) > limit_mm)};
+        emergency::set(emergency::CLIFF, cliff);
     }
 }
 
-k_thread thread;
 k_msgq msgq;
 
 }
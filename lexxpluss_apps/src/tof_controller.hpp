@@ -31,11 +31,11 @@ namespace lexxhard::tof_controller {
 
 struct msg {
     int32_t left, right;
+    bool left_stale, right_stale;
 } __attribute__((aligned(4)));
 
 void init();
-void run(void *p1, void *p2, void *p3);
-extern k_thread thread;
+void poll();
 extern k_msgq msgq;
 
 }
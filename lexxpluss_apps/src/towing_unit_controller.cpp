@@ -43,7 +43,7 @@ public:
         k_msgq_init(&msgq_towing_unit_status, msgq_towing_unit_status_buffer, sizeof (msg_towing_unit_status), 8);
         k_msgq_init(&msgq_towing_unit_power_on, msgq_towing_unit_power_on_buffer, sizeof (msg_towing_unit_status), 8);
 
-        const device *gpioj{device_get_binding("GPIOJ")};
+        gpioj = device_get_binding("GPIOJ");
         if (device_is_ready(gpioj)) {
             gpio_pin_configure(gpioj, 1, GPIO_OUTPUT);                                      // Power ON Output SPRGPIO4
             gpio_pin_configure(gpioj, 2, GPIO_INPUT | GPIO_PULL_UP | GPIO_ACTIVE_HIGH);     // Switch 1 SPRGPIO5
@@ -64,62 +64,54 @@ public:
 
         return 0;
     }
-    void run() {
-        LOG_INF("Towing Unit run() started");
-        
-        while (true) {
-            // Get Switch & Power Good Status
-            const device *gpioj{device_get_binding("GPIOJ")};
-
-            if (device_is_ready(gpioj)) {
-                if (is_towing_unit_power_on == V12_ON) {
-                    gpio_pin_set(gpioj, 1, 0);  // Set 12V Power ON(active low)
-                } else {
-                    gpio_pin_set(gpioj, 1, 1);  // Set 12V Power OFF
-                }
-            }
-            if (device_is_ready(gpioj)) {
-                // SW_L
-                if(gpio_pin_get(gpioj, 2) == 0){
-                    is_towing_unit_sw_l_loading = LOADED;   // Loading
-                }else{
-                    is_towing_unit_sw_l_loading = UNLOADED; // Not Loading
-                }
+    void poll() {
+        // Get Switch & Power Good Status
+        if (device_is_ready(gpioj)) {
+            if (is_towing_unit_power_on == V12_ON) {
+                gpio_pin_set(gpioj, 1, 0);  // Set 12V Power ON(active low)
+            } else {
+                gpio_pin_set(gpioj, 1, 1);  // Set 12V Power OFF
             }
-            if (device_is_ready(gpioj)) {
-                // SW_R
-                if(gpio_pin_get(gpioj, 3) == 0){
-                    is_towing_unit_sw_r_loading = LOADED;   // Loading
-                }else{
-                    is_towing_unit_sw_r_loading = UNLOADED; // Not Loading
-                }
+        }
+        if (device_is_ready(gpioj)) {
+            // SW_L
+            if(gpio_pin_get(gpioj, 2) == 0){
+                is_towing_unit_sw_l_loading = LOADED;   // Loading
+            }else{
+                is_towing_unit_sw_l_loading = UNLOADED; // Not Loading
             }
-            if (device_is_ready(gpioj)) {
-                // Power Good
-                if(gpio_pin_get(gpioj, 4) == 0){
-                    is_towing_unit_power_good = V12_OK; // +12V is on
-                }else{
-                    is_towing_unit_power_good = V12_NG; // +12V is off
-                } 
+        }
+        if (device_is_ready(gpioj)) {
+            // SW_R
+            if(gpio_pin_get(gpioj, 3) == 0){
+                is_towing_unit_sw_r_loading = LOADED;   // Loading
+            }else{
+                is_towing_unit_sw_r_loading = UNLOADED; // Not Loading
             }
-
-            // Get Power ON Output Status
-            if (k_msgq_get(&msgq_towing_unit_power_on, &message_towing_status_rx, K_NO_WAIT) == 0) {
-                is_towing_unit_power_on = message_towing_status_rx.power_on;
+        }
+        if (device_is_ready(gpioj)) {
+            // Power Good
+            if(gpio_pin_get(gpioj, 4) == 0){
+                is_towing_unit_power_good = V12_OK; // +12V is on
+            }else{
+                is_towing_unit_power_good = V12_NG; // +12V is off
             } 
+        }
 
-            // Set Status to PUB message
-            message_towing_status_tx.left_sw = is_towing_unit_sw_l_loading;
-            message_towing_status_tx.right_sw = is_towing_unit_sw_r_loading;
-            message_towing_status_tx.power_good = is_towing_unit_power_good;
-            message_towing_status_tx.power_on = is_towing_unit_power_on;
+        // Get Power ON Output Status
+        if (k_msgq_get(&msgq_towing_unit_power_on, &message_towing_status_rx, K_NO_WAIT) == 0) {
+            is_towing_unit_power_on = message_towing_status_rx.power_on;
+        } 
 
-            // Send PUB message
-            while (k_msgq_put(&msgq_towing_unit_status, &message_towing_status_tx, K_NO_WAIT) != 0) {
-                k_msgq_purge(&msgq_towing_unit_status);
-            }
+        // Set Status to PUB message
+        message_towing_status_tx.left_sw = is_towing_unit_sw_l_loading;
+        message_towing_status_tx.right_sw = is_towing_unit_sw_r_loading;
+        message_towing_status_tx.power_good = is_towing_unit_power_good;
+        message_towing_status_tx.power_on = is_towing_unit_power_on;
 
-            k_msleep(20);
+        // Send PUB message
+        while (k_msgq_put(&msgq_towing_unit_status, &message_towing_status_tx, K_NO_WAIT) != 0) {
+            k_msgq_purge(&msgq_towing_unit_status);
         }
     }
     void cmd_v12_on(const shell *shell) {
@@ -137,6 +129,7 @@ public:
     }
     
 private:
+    const device *gpioj{nullptr};
     msg_towing_unit_status message_towing_status_rx, message_towing_status_tx;
     uint8_t is_towing_unit_power_on;
     uint8_t is_towing_unit_power_good;
@@ -170,12 +163,11 @@ void init()
     impl.init();
 }
 
-void run(void *p1, void *p2, void *p3)
+void poll()
 {
-    impl.run();
+    impl.poll();
 }
 
-k_thread thread;
 k_msgq msgq_towing_unit_status;
 k_msgq msgq_towing_unit_power_on;
 
@@ -45,8 +45,7 @@ struct msg_towing_unit_status {
 } __attribute__((aligned(4)));
 
 void init();
-void run(void *p1, void *p2, void *p3);
-extern k_thread thread;
+void poll();
 extern k_msgq msgq_towing_unit_status;
 extern k_msgq msgq_towing_unit_power_on;
 }  // namespace lexxhard::towing_unit_controller
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#ifdef CONFIG_LEXXHARD_TRACE_MARKERS
+#include <ctf_top.h>
+#endif
+
+// Begin/end markers written into the CTF trace stream of the tracing build
+// (make firmware_tracing).  They compile to nothing in the normal firmware.
+// scripts/ctf2perfetto.py reads the names below from this file.
+
+namespace lexxhard::trace {
+
+enum {
+    ACTUATOR_CONTROLLER = 0,
+    ADC_READER,
+    CAN_CONTROLLER,
+    EXECUTOR,
+    IMU_CONTROLLER,
+    LED_CONTROLLER,
+    PGV_CONTROLLER,
+    ROSSERIAL,
+    ROSSERIAL_SERVICE,
+    RUNAWAY_DETECTOR,
+    USS_FETCHER,
+    ROSSERIAL_ISR,
+    PGV_ISR,
+    PUBLISH_ACTUATOR,
+    PUBLISH_BLACKBOX,
+    PUBLISH_BMU,
+    PUBLISH_BOARD,
+    PUBLISH_BOOT,
+    PUBLISH_CONFIG,
+    PUBLISH_DIAGNOSTICS,
+    PUBLISH_DFU,
+    PUBLISH_HEALTH,
+    PUBLISH_IMU,
+    PUBLISH_INTERLOCK,
+    PUBLISH_LATENCY,
+    PUBLISH_LED,
+    PUBLISH_LINK,
+    PUBLISH_PGV,
+    PUBLISH_THREAD_MONITOR,
+    PUBLISH_TOF,
+    PUBLISH_USS,
+    PUBLISH_TOWING_UNIT,
+    PUBLISH_WATCHDOG,
+    MARKER_NUM
+};
+
+// Event IDs outside the range used by the Zephyr CTF metadata.
+enum {
+    EVENT_MARKER_BEGIN = 0xe0,
+    EVENT_MARKER_END = 0xe1
+};
+
+static constexpr uint8_t NO_INDEX{0xff};
+
+#ifdef CONFIG_LEXXHARD_TRACE_MARKERS
+inline void begin(uint8_t id, uint8_t index = NO_INDEX)
+{
+    CTF_EVENT(CTF_LITERAL(uint8_t, EVENT_MARKER_BEGIN), id, index);
+}
+
+inline void end(uint8_t id, uint8_t index = NO_INDEX)
+{
+    CTF_EVENT(CTF_LITERAL(uint8_t, EVENT_MARKER_END), id, index);
+}
+#else
+inline void begin(uint8_t id, uint8_t index = NO_INDEX) {}
+inline void end(uint8_t id, uint8_t index = NO_INDEX) {}
+#endif
+
+}
+
+#define TRACE_BEGIN(id) lexxhard::trace::begin(lexxhard::trace::id)
+#define TRACE_END(id) lexxhard::trace::end(lexxhard::trace::id)
+#define TRACE_BEGIN_N(id, n) lexxhard::trace::begin(lexxhard::trace::id, n)
+#define TRACE_END_N(id, n) lexxhard::trace::end(lexxhard::trace::id, n)
+
+// vim: set expandtab shiftwidth=4:
@@ -28,7 +28,17 @@
 #include <drivers/sensor.h>
 #include <logging/log.h>
 #include <shell/shell.h>
+#include <algorithm>
+#include <cstring>
+#include "blackbox.hpp"
+#include "config.hpp"
+#include "diagnostics.hpp"
+#include "freshness.hpp"
+#include "periodic.hpp"
+#include "recorder.hpp"
+#include "trace.hpp"
 #include "uss_controller.hpp"
+#include "watchdog_supervisor.hpp"
 
 namespace lexxhard::uss_controller {
 
@@ -40,10 +50,12 @@ class uss_fetcher {
 public:
     int init(const char *label0, const char *label1) {
         dev[0] = device_get_binding(label0);
+        channel[0] = label_channel(label0);
         if (!device_is_ready(dev[0]))
             return -1;
         if (label1 != nullptr) {
             dev[1] = device_get_binding(label1);
+            channel[1] = label_channel(label1);
             if (!device_is_ready(dev[1]))
                 return -1;
         }
@@ -53,45 +65,100 @@ public:
         distance[0] = this->distance[0];
         distance[1] = this->distance[1];
     }
+    bool is_stale(int index) const {
+        return fresh.is_stale(index);
+    }
     static void runner(void *p1, void *p2, void *p3) {
         uss_fetcher *self{static_cast<uss_fetcher*>(p1)};
-        self->run();
+        self->run(reinterpret_cast<intptr_t>(p2), static_cast<const char*>(p3));
     }
     k_thread thread;
 private:
-    void run() {
-        if (!device_is_ready(dev[0]))
+    void run(int loop, const char *name) {
+        if (!device_is_ready(dev[0])) {
+            diagnostics::report(diagnostics::USS, diagnostics::ERROR, diagnostics::CODE_DEVICE_NOT_READY);
             return;
+        }
+        watchdog_supervisor::declare(loop, name, 1000, false);
+        uint8_t index{static_cast<uint8_t>(loop - watchdog_supervisor::USS_FETCHER_0)};
+        periodic::start(periodic::USS_FETCHER_0 + index);
         while (true) {
+            watchdog_supervisor::checkin(loop);
+            TRACE_BEGIN_N(USS_FETCHER, index);
+            int32_t weight{config::get_int(config::USS_FILTER_WEIGHT)};
             if (sensor_sample_fetch_chan(dev[0], SENSOR_CHAN_ALL) == 0) {
                 sensor_value v;
                 sensor_channel_get(dev[0], SENSOR_CHAN_DISTANCE, &v);
                 int32_t value{v.val1 * 1000 + v.val2 / 1000};
-                distance[0] = distance[0] / 4 + value * 3 / 4;
+                record_input(0, value);
+                distance[0] = filter(distance[0], value, weight);
+                fresh.update(0);
             }
             if (device_is_ready(dev[1])) {
                 if (sensor_sample_fetch_chan(dev[1], SENSOR_CHAN_ALL) == 0) {
                     sensor_value v;
                     sensor_channel_get(dev[1], SENSOR_CHAN_DISTANCE, &v);
                     int32_t value{v.val1 * 1000 + v.val2 / 1000};
-                    distance[1] = distance[1] / 4 + value * 3 / 4;
+                    record_input(1, value);
+                    distance[1] = filter(distance[1], value, weight);
+                    fresh.update(1);
                 }
             }
+            blackbox::uss_sample sample{
+                index,
+                {static_cast<uint16_t>(std::min<uint32_t>(distance[0], UINT16_MAX)),
+                 static_cast<uint16_t>(std::min<uint32_t>(distance[1], UINT16_MAX))}
+            };
+            blackbox::record(blackbox::USS, &sample, sizeof sample);
+            TRACE_END_N(USS_FETCHER, index);
             k_msleep(1);
         }
     }
+    // MB1604_<n>, the index the simulated board uses for the sensor.
+    static uint8_t label_channel(const char *label) {
+        return label[strlen(label) - 1] - '0';
+    }
+    void record_input(int index, int32_t value) const {
+        recording_uss sample{channel[index], value};
+        recorder::record(RECORDING_USS, &sample, sizeof sample);
+    }
+    // weight is the share of the new sample in percent.
+    static uint32_t filter(uint32_t prev, int32_t value, int32_t weight) {
+        return (static_cast<int32_t>(prev) * (100 - weight) + value * weight) / 100;
+    }
     const device *dev[2]{nullptr, nullptr};
+    uint8_t channel[2]{0, 0};
     uint32_t distance[2]{0, 0};
+    freshness<2> fresh{CONFIG_LEXXHARD_STALE_USS_MS};
 } fetcher[4];
 
-K_THREAD_STACK_DEFINE(fetcher_stack_0, 2048);
-K_THREAD_STACK_DEFINE(fetcher_stack_1, 2048);
-K_THREAD_STACK_DEFINE(fetcher_stack_2, 2048);
-K_THREAD_STACK_DEFINE(fetcher_stack_3, 2048);
+K_THREAD_STACK_DEFINE(fetcher_stack_0, CONFIG_LEXXHARD_USS_FETCHER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(fetcher_stack_1, CONFIG_LEXXHARD_USS_FETCHER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(fetcher_stack_2, CONFIG_LEXXHARD_USS_FETCHER_STACK_SIZE);
+K_THREAD_STACK_DEFINE(fetcher_stack_3, CONFIG_LEXXHARD_USS_FETCHER_STACK_SIZE);
 
 #define RUN(x) \
     k_thread_create(&fetcher[x].thread, fetcher_stack_##x, K_THREAD_STACK_SIZEOF(fetcher_stack_##x), \
-                    &uss_fetcher::runner, &fetcher[x], nullptr, nullptr, 3, K_FP_REGS, K_NO_WAIT);
+                    &uss_fetcher::runner, &fetcher[x], \
+                    reinterpret_cast<void*>(watchdog_supervisor::USS_FETCHER_##x), const_cast<char*>("uss_fetcher" #x), \
+                    periodic::get_priority(periodic::USS_FETCHER_##x), 0, K_NO_WAIT); \
+    k_thread_name_set(&fetcher[x].thread, "uss_fetcher" #x);
+
+uint32_t get_stale_mask()
+{
+    uint32_t mask{0};
+    if (fetcher[0].is_stale(0))
+        mask |= msg::STALE_FRONT_LEFT;
+    if (fetcher[0].is_stale(1))
+        mask |= msg::STALE_FRONT_RIGHT;
+    if (fetcher[1].is_stale(0))
+        mask |= msg::STALE_LEFT;
+    if (fetcher[2].is_stale(0))
+        mask |= msg::STALE_RIGHT;
+    if (fetcher[3].is_stale(0))
+        mask |= msg::STALE_BACK;
+    return mask;
+}
 
 int info(const shell *shell, size_t argc, char **argv)
 {
@@ -100,9 +167,10 @@ int info(const shell *shell, size_t argc, char **argv)
     fetcher[1].get_distance(left);
     fetcher[2].get_distance(right);
     fetcher[3].get_distance(back);
-    shell_print(shell, "FL:%umm FR:%umm L:%umm R:%umm B:%umm\n",
+    shell_print(shell, "FL:%umm FR:%umm L:%umm R:%umm B:%umm stale:0x%02x\n",
                 front[0], front[1],
-                left[0], right[0], back[0]);
+                left[0], right[0], back[0],
+                get_stale_mask());
     return 0;
 }
 
@@ -119,33 +187,30 @@ void init()
     fetcher[1].init("MB1604_2", nullptr);
     fetcher[2].init("MB1604_3", nullptr);
     fetcher[3].init("MB1604_4", nullptr);
-}
-
-void run(void *p1, void *p2, void *p3)
-{
     RUN(0);
     RUN(1);
     RUN(2);
     RUN(3);
-    while (true) {
-        msg message;
-        uint32_t distance[2];
-        fetcher[0].get_distance(distance);
-        message.front_left = distance[0];
-        message.front_right = distance[1];
-        fetcher[1].get_distance(distance);
-        message.left = distance[0];
-        fetcher[2].get_distance(distance);
-        message.right = distance[0];
-        fetcher[3].get_distance(distance);
-        message.back = distance[0];
-        while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
-            k_msgq_purge(&msgq);
-        k_msleep(100);
-    }
 }
 
-k_thread thread;
+void poll()
+{
+    msg message;
+    uint32_t distance[2];
+    fetcher[0].get_distance(distance);
+    message.front_left = distance[0];
+    message.front_right = distance[1];
+    fetcher[1].get_distance(distance);
+    message.left = distance[0];
+    fetcher[2].get_distance(distance);
+    message.right = distance[0];
+    fetcher[3].get_distance(distance);
+    message.back = distance[0];
+    message.stale = get_stale_mask();
+    while (k_msgq_put(&msgq, &message, K_NO_WAIT) != 0)
+        k_msgq_purge(&msgq);
+}
+
 k_msgq msgq;
 
 }
@@ -32,11 +32,14 @@ namespace lexxhard::uss_controller {
 struct msg {
     uint32_t front_left, front_right;
     uint32_t left, right, back;
+    uint32_t stale;
+    static constexpr uint32_t STALE_FRONT_LEFT{1U << 0}, STALE_FRONT_RIGHT{1U << 1};
+    static constexpr uint32_t STALE_LEFT{1U << 2}, STALE_RIGHT{1U << 3}, STALE_BACK{1U << 4};
 } __attribute__((aligned(4)));
 
 void init();
-void run(void *p1, void *p2, void *p3);
-extern k_thread thread;
+void poll();
+uint32_t get_stale_mask();
 extern k_msgq msgq;
 
 }
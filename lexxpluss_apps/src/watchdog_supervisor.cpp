@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <drivers/watchdog.h>
+#include <logging/log.h>
+#include <shell/shell.h>
+#include "diagnostics.hpp"
+#include "watchdog_supervisor.hpp"
+
+namespace lexxhard::watchdog_supervisor {
+
+LOG_MODULE_REGISTER(watchdog);
+
+char __aligned(4) msgq_fault_buffer[8 * sizeof (msg_fault)];
+
+class watchdog_supervisor_impl {
+public:
+    int init() {
+        k_msgq_init(&msgq_fault, msgq_fault_buffer, sizeof (msg_fault), 8);
+        return 0;
+    }
+    void run() {
+        setup_hardware_watchdog();
+        while (true) {
+            bool healthy{true};
+            int level{diagnostics::OK};
+            uint32_t now_ms{k_uptime_get_32()};
+            for (int i{0}; i < LOOP_NUM; ++i) {
+                if (!check(i, now_ms)) {
+                    if (loops[i].critical) {
+                        healthy = false;
+                        level = diagnostics::ERROR;
+                    } else if (level == diagnostics::OK) {
+                        level = diagnostics::WARN;
+                    }
+                }
+            }
+            if (reported_level != level) {
+                reported_level = level;
+                diagnostics::report(diagnostics::WATCHDOG, level,
+                                    level == diagnostics::OK ? diagnostics::CODE_NONE : diagnostics::CODE_LOOP_LATE);
+            }
+            if (healthy) {
+                if (channel >= 0)
+                    wdt_feed(dev, channel);
+                ++feed_count;
+            }
+            k_msleep(CONFIG_LEXXHARD_WATCHDOG_CHECK_MS);
+        }
+    }
+    void declare(int loop, const char *name, uint32_t max_period_ms, bool critical) {
+        if (max_period_ms > MAX_PERIOD_MS) {
+            LOG_ERR("%s period %ums is beyond %ums, not supervised", name, max_period_ms, MAX_PERIOD_MS);
+            return;
+        }
+        loop_state &s{loops[loop]};
+        s.name = name;
+        s.max_period_ms = max_period_ms;
+        s.critical = critical;
+        checkin(loop);
+        s.declared = true;
+    }
+    const char *get_name(int loop) const {
+        return loops[loop].name;
+    }
+    uint32_t get_feed_count() const {
+        return feed_count;
+    }
+    void info(const shell *shell) const {
+        shell_print(shell, "hardware watchdog: %s", channel >= 0 ? "enabled" : "disabled");
+        shell_print(shell, "%-20s %4s %6s %6s %6s %6s",
+                    "name", "crit", "max", "age", "miss", "late");
+        uint32_t now_ms{k_uptime_get_32()};
+        for (int i{0}; i < LOOP_NUM; ++i) {
+            const loop_state &s{loops[i]};
+            if (!s.declared)
+                continue;
+            shell_print(shell, "%-20s %4d %6u %6u %6u %6u",
+                        s.name, s.critical, s.max_period_ms,
+                        now_ms - checkin_ms[i],
+                        s.miss_count, s.worst_late_ms);
+        }
+    }
+private:
+    struct loop_state {
+        const char *name{""};
+        uint32_t max_period_ms{0}, miss_count{0}, late_ms{0}, worst_late_ms{0};
+        bool declared{false}, critical{false}, missed{false};
+    };
+    bool check(int loop, uint32_t now_ms) {
+        loop_state &s{loops[loop]};
+        if (!s.declared)
+            return true;
+        uint32_t age_ms{now_ms - checkin_ms[loop]};
+        if (age_ms > s.max_period_ms) {
+            s.late_ms = age_ms - s.max_period_ms;
+            if (s.worst_late_ms < s.late_ms)
+                s.worst_late_ms = s.late_ms;
+            if (!s.missed) {
+                s.missed = true;
+                ++s.miss_count;
+                LOG_ERR("%s missed its deadline by %ums", s.name, s.late_ms);
+                report(loop, s.late_ms, false);
+            }
+            return false;
+        }
+        if (s.missed) {
+            s.missed = false;
+            LOG_WRN("%s recovered, %ums late", s.name, s.late_ms);
+            report(loop, s.late_ms, true);
+        }
+        return true;
+    }
+    void report(int loop, uint32_t late_ms, bool recovered) const {
+        msg_fault message{static_cast<uint32_t>(loop), late_ms, recovered};
+        while (k_msgq_put(&msgq_fault, &message, K_NO_WAIT) != 0)
+            k_msgq_purge(&msgq_fault);
+    }
+    void setup_hardware_watchdog() {
+        dev = device_get_binding("IWDG");
+        if (!device_is_ready(dev)) {
+            LOG_WRN("hardware watchdog not available");
+            return;
+        }
+        wdt_timeout_cfg config{
+            .window{.min{0}, .max{CONFIG_LEXXHARD_WATCHDOG_TIMEOUT_MS}},
+            .callback{nullptr},
+            .flags{WDT_FLAG_RESET_SOC}
+        };
+        channel = wdt_install_timeout(dev, &config);
+        if (channel < 0 || wdt_setup(dev, WDT_OPT_PAUSE_HALTED_BY_DBG) != 0) {
+            LOG_ERR("unable to setup hardware watchdog");
+            channel = -1;
+        }
+    }
+    loop_state loops[LOOP_NUM];
+    const device *dev{nullptr};
+    int channel{-1}, reported_level{diagnostics::OK};
+    uint32_t feed_count{0};
+} impl;
+
+int info(const shell *shell, size_t argc, char **argv)
+{
+    impl.info(shell);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub,
+    SHELL_CMD(info, NULL, "Loop supervisor information", info),
+    SHELL_SUBCMD_SET_END
+);
+SHELL_CMD_REGISTER(watchdog, &sub, "Watchdog commands", NULL);
+
+void init()
+{
+    impl.init();
+}
+
+void run(void *p1, void *p2, void *p3)
+{
+    impl.run();
+}
+
+void declare(int loop, const char *name, uint32_t max_period_ms, bool critical)
+{
+    impl.declare(loop, name, max_period_ms, critical);
+}
+
+const char *get_name(int loop)
+{
+    return impl.get_name(loop);
+}
+
+uint32_t get_feed_count()
+{
+    return impl.get_feed_count();
+}
+
+uint32_t checkin_ms[LOOP_NUM];
+k_thread thread;
+k_msgq msgq_fault;
+
+}
+
+// vim: set expandtab shiftwidth=4:
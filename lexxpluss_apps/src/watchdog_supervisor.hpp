@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+
+namespace lexxhard::watchdog_supervisor {
+
+enum {
+    ACTUATOR_CONTROLLER = 0,
+    ADC_READER,
+    CAN_CONTROLLER,
+    EXECUTOR,
+    FIRMWARE_UPDATER,
+    IMU_CONTROLLER,
+    LED_CONTROLLER,
+    PGV_CONTROLLER,
+    ROSSERIAL,
+    ROSSERIAL_SERVICE,
+    RUNAWAY_DETECTOR,
+    USS_FETCHER_0,
+    USS_FETCHER_1,
+    USS_FETCHER_2,
+    USS_FETCHER_3,
+    LOOP_NUM
+};
+
+struct msg_fault {
+    uint32_t loop, late_ms;
+    bool recovered;
+} __attribute__((aligned(4)));
+
+void init();
+void run(void *p1, void *p2, void *p3);
+void declare(int loop, const char *name, uint32_t max_period_ms, bool critical);
+const char *get_name(int loop);
+// Passes that found every critical loop on time and fed the IWDG, counted
+// also when the IWDG is not available.
+uint32_t get_feed_count();
+extern k_thread thread;
+extern k_msgq msgq_fault;
+
+// Check-ins are uptime milliseconds, the age of a loop is exact until it
+// has been stuck for half the 32 bit range.  The cycle counter would wrap
+// in about 20 s at 216 MHz, shorter than the slowest loop allows.
+static constexpr uint32_t MAX_PERIOD_MS{UINT32_MAX / 2};
+
+extern uint32_t checkin_ms[LOOP_NUM];
+
+// Called once per loop iteration, keep it to a single store.
+inline void checkin(int loop)
+{
+    checkin_ms[loop] = k_uptime_get_32();
+}
+
+}
+
+// vim: set expandtab shiftwidth=4:
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2024, LexxPluss Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <zephyr.h>
+#include <cmath>
+
+namespace lexxhard::runaway_detector {
+
+// Fixed capacity FIFO with the std::queue interface used below, so the
+// sliding windows never touch the heap.
+template <typename T, size_t N>
+class fixed_queue {
+public:
+    void push(const T &value) {
+        __ASSERT_NO_MSG(count < N);
+        buffer[(head + count++) % N] = value;
+    }
+    void pop() {
+        __ASSERT_NO_MSG(count > 0);
+        head = (head + 1) % N;
+        --count;
+    }
+    const T &front() const {return buffer[head];}
+    const T &back() const {return buffer[(head + count - 1) % N];}
+private:
+    T buffer[N]{};
+    size_t head{0}, count{0};
+};
+
+// The window lengths are in samples, so the host evaluation can try them
+// at other sample rates; the firmware uses yaw_checker below.
+template <size_t SIZE_OF_TOPICS_QUEUE, size_t SIZE_OF_YAW_ACCEL_QUEUE,
+          size_t SIZE_OF_YAW_VELOCITY_QUEUE, size_t SIZE_OF_YAW_DELTA_THETA_QUEUE>
+class basic_yaw_checker {
+public:
+    static constexpr float YAW_DELTA_THETA_LIMIT{2.5f * M_PI};
+    bool detect(float vz, uint32_t current_cycle, float accel_limit,
+                float delta_theta_limit = YAW_DELTA_THETA_LIMIT) {
+        if (!init_done)
+            init();
+        delta_theta_calculator(vz, current_cycle);
+        yaw_accel_calculator(vz, current_cycle);
+        yaw_velocity_calculator(vz, current_cycle);
+        if (sum_yaw_delta_theta > delta_theta_limit)
+            return true;
+        else if ((avg_yaw_accel > 1 && avg_yaw_velocity > 1) || (avg_yaw_accel < -1 && avg_yaw_velocity < -1))//In other words, "if speeding up "... values are compared to 1 in order to ignore small random inputs
+            return fabsf(avg_yaw_accel) > accel_limit;
+        else
+            return false;
+    }
+    float get_avg_yaw_accel() const {return avg_yaw_accel;}
+    float get_avg_yaw_velocity() const {return avg_yaw_velocity;}
+    float get_sum_yaw_delta_theta() const {return sum_yaw_delta_theta;}
+private:
+    void init() {
+        for (size_t i{0}; i < SIZE_OF_TOPICS_QUEUE; ++i)
+            topics.push(topic{.vz{0.0f}, .cycle{0U}});
+        for (size_t i{0}; i < SIZE_OF_YAW_ACCEL_QUEUE; ++i)
+            yaw_accel.push(0.0f);
+        for (size_t i{0}; i < SIZE_OF_YAW_VELOCITY_QUEUE; ++i)
+            yaw_velocity.push(0.0f);
+        for (size_t i{0}; i < SIZE_OF_YAW_DELTA_THETA_QUEUE; ++i)
+            yaw_delta_theta.push(0.0f);
+        init_done = true;
+    }
+    void yaw_accel_calculator(float vz, uint32_t current_cycle) {//here, can calculate whether the robot is speeding up (rotation wise) using both velocity and acceleration
+        topics.pop();
+        topics.push(topic{.vz{vz}, .cycle{current_cycle}});
+        topic temp_a{topics.front()}, temp_b{topics.back()};
+        float dt {static_cast<float>(k_cyc_to_ms_near32(temp_b.cycle - temp_a.cycle)) / 1000.0f};
+        avg_yaw_accel -= yaw_accel.front();
+        yaw_accel.pop();
+        yaw_accel.push(((temp_b.vz - temp_a.vz) / dt) / SIZE_OF_YAW_ACCEL_QUEUE);//1000.f to convert ms to sec
+        avg_yaw_accel += yaw_accel.back();
+    }
+    void yaw_velocity_calculator(float vz, uint32_t current_cycle) {
+        avg_yaw_velocity -= yaw_velocity.front();
+        yaw_velocity.pop();
+        yaw_velocity.push(vz / SIZE_OF_YAW_VELOCITY_QUEUE);
+        avg_yaw_velocity += yaw_velocity.back();
+    }
+    void delta_theta_calculator(float vz, uint32_t current_cycle) {
+        float dt{static_cast<float>(k_cyc_to_ms_near32(current_cycle - prev_cycle)) / 1000.0f};
+        sum_yaw_delta_theta -= yaw_delta_theta.front();
+        yaw_delta_theta.pop();
+        yaw_delta_theta.push(fabsf(vz * dt));
+        sum_yaw_delta_theta += yaw_delta_theta.back();
+        prev_cycle = current_cycle;
+    }
+    struct topic {
+        float vz;
+        uint32_t cycle;
+    };
+    fixed_queue<topic, SIZE_OF_TOPICS_QUEUE> topics;
+    fixed_queue<float, SIZE_OF_YAW_ACCEL_QUEUE> yaw_accel;
+    fixed_queue<float, SIZE_OF_YAW_VELOCITY_QUEUE> yaw_velocity;
+    fixed_queue<float, SIZE_OF_YAW_DELTA_THETA_QUEUE> yaw_delta_theta;
+    bool init_done{false};
+    uint32_t prev_cycle{0U};
+    float avg_yaw_accel{0.0f};
+    float avg_yaw_velocity{0.0f};
+    float sum_yaw_delta_theta{0.0f};
+};
+
+using yaw_checker = basic_yaw_checker<
+    10U,    //average of ~200ms at 50Hz
+    50U,    //average of ~1000ms at 50Hz
+    50U,    //average of ~1000ms at 50Hz
+    125U    //average of ~2500ms at 50Hz
+>;
+
+}
+
+// vim: set expandtab shiftwidth=4: